@@ -0,0 +1,242 @@
+#include "BrowseCache.hpp"
+#include "filesystem.hpp"
+
+#include "detail/DirectoryStamp.hpp"
+
+#include <boost/unordered_map.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/foreach.hpp>
+
+#include <list>
+#include <ctime>
+
+
+namespace sequenceParser {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+std::string getCacheKey( const bfs::path& directory, const EDetection detectOptions, const std::vector<std::string>& filters )
+{
+	std::string key( directory.string() );
+	key += '\0';
+	key += boost::lexical_cast<std::string>( int( detectOptions ) );
+	BOOST_FOREACH( const std::string& filter, filters )
+	{
+		key += '\0';
+		key += filter;
+	}
+	return key;
+}
+
+struct CacheEntry
+{
+	std::string key;
+	std::string directory;
+	detail::DirectoryStamp stamp;
+	BrowseResult result;
+	std::size_t memorySize;
+};
+
+}
+
+struct BrowseCache::Data
+{
+	typedef std::list<CacheEntry> Entries;
+	typedef boost::unordered_map<std::string, Entries::iterator> EntriesMap;
+
+	explicit Data( const std::size_t memoryBudget )
+	: memoryBudget( memoryBudget )
+	, recentModificationDelay( 2 )
+	, memorySize( 0 )
+	, nbHits( 0 )
+	, nbMisses( 0 )
+	, nbEvictions( 0 )
+	{}
+
+	void erase( const Entries::iterator& it )
+	{
+		memorySize -= it->memorySize;
+		entriesMap.erase( it->key );
+		entries.erase( it );
+	}
+
+	/// @brief Remove the least recently used entries to respect the budget.
+	void evict()
+	{
+		while( memorySize > memoryBudget && ! entries.empty() )
+		{
+			erase( --entries.end() );
+			++nbEvictions;
+		}
+	}
+
+	/**
+	 * @return the result of the browse, from the cache if possible
+	 *         (valid until the next modification of the cache)
+	 */
+	const BrowseResult& get( const bfs::path& directory, const EDetection detectOptions, const std::vector<std::string>& filters );
+
+	Entries entries; ///< most recently used first
+	EntriesMap entriesMap;
+	BrowseResult uncached; ///< last result which is not in the cache
+
+	std::size_t memoryBudget;
+	std::size_t recentModificationDelay; ///< directories modified during the last seconds are not cached
+	std::size_t memorySize;
+	std::size_t nbHits;
+	std::size_t nbMisses;
+	std::size_t nbEvictions;
+};
+
+const BrowseResult& BrowseCache::Data::get( const bfs::path& directory, const EDetection detectOptions, const std::vector<std::string>& filters )
+{
+	const std::string key = getCacheKey( directory, detectOptions, filters );
+	const EntriesMap::iterator itMap = entriesMap.find( key );
+
+	// the stamp is taken before the listing,
+	// so a modification during the listing is detected by the next browse
+	detail::DirectoryStamp stamp;
+	const bool hasStamp = detail::getDirectoryStamp( directory, stamp );
+
+	if( itMap != entriesMap.end() )
+	{
+		const Entries::iterator it = itMap->second;
+		if( hasStamp && it->stamp == stamp )
+		{
+			++nbHits;
+			entries.splice( entries.begin(), entries, it );
+			return it->result;
+		}
+		erase( it );
+	}
+	++nbMisses;
+
+	uncached = BrowseResult();
+	sequenceParser::browse( uncached, directory, detectOptions, filters );
+
+	if( ! hasStamp )
+		return uncached;
+	if( recentModificationDelay != 0 && stamp.isRecent( std::time( NULL ), recentModificationDelay ) )
+		return uncached;
+
+	uncached.shrink();
+	const std::size_t entryMemorySize = uncached.getMemorySize() + key.capacity() + directory.native().capacity();
+	if( entryMemorySize > memoryBudget )
+		return uncached;
+
+	entries.push_front( CacheEntry() );
+	CacheEntry& entry = entries.front();
+	entry.key = key;
+	entry.directory = directory.string();
+	entry.stamp = stamp;
+	entry.result.swap( uncached );
+	entry.memorySize = entryMemorySize;
+	entriesMap[key] = entries.begin();
+	memorySize += entryMemorySize;
+
+	evict();
+	return entries.front().result;
+}
+
+
+BrowseCache::BrowseCache( const std::size_t memoryBudget )
+: _data( new Data( memoryBudget ) )
+{}
+
+BrowseCache::~BrowseCache()
+{}
+
+std::vector<Item> BrowseCache::browse(
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	return _data->get( directory, detectOptions, filters ).getItems();
+}
+
+void BrowseCache::browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	outResult = _data->get( directory, detectOptions, filters );
+}
+
+void BrowseCache::invalidate( const std::string& directory )
+{
+	const std::string directoryStr = bfs::path( directory ).string();
+	Data::Entries::iterator it = _data->entries.begin();
+	while( it != _data->entries.end() )
+	{
+		const Data::Entries::iterator current = it++;
+		if( current->directory == directoryStr )
+			_data->erase( current );
+	}
+}
+
+void BrowseCache::clear()
+{
+	_data->entries.clear();
+	_data->entriesMap.clear();
+	_data->uncached = BrowseResult();
+	_data->memorySize = 0;
+}
+
+std::size_t BrowseCache::getMemoryBudget() const
+{
+	return _data->memoryBudget;
+}
+
+void BrowseCache::setMemoryBudget( const std::size_t memoryBudget )
+{
+	_data->memoryBudget = memoryBudget;
+	_data->evict();
+}
+
+std::size_t BrowseCache::getRecentModificationDelay() const
+{
+	return _data->recentModificationDelay;
+}
+
+void BrowseCache::setRecentModificationDelay( const std::size_t seconds )
+{
+	_data->recentModificationDelay = seconds;
+}
+
+std::size_t BrowseCache::getMemorySize() const
+{
+	return _data->memorySize;
+}
+
+std::size_t BrowseCache::size() const
+{
+	return _data->entries.size();
+}
+
+std::size_t BrowseCache::getNbHits() const
+{
+	return _data->nbHits;
+}
+
+std::size_t BrowseCache::getNbMisses() const
+{
+	return _data->nbMisses;
+}
+
+std::size_t BrowseCache::getNbEvictions() const
+{
+	return _data->nbEvictions;
+}
+
+void BrowseCache::resetCounters()
+{
+	_data->nbHits = 0;
+	_data->nbMisses = 0;
+	_data->nbEvictions = 0;
+}
+
+
+}
@@ -0,0 +1,117 @@
+#ifndef _SEQUENCE_PARSER_BROWSE_CACHE_HPP_
+#define _SEQUENCE_PARSER_BROWSE_CACHE_HPP_
+
+#include "common.hpp"
+#include "BrowseResult.hpp"
+#include "Item.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <vector>
+
+
+namespace sequenceParser {
+
+/**
+ * @brief Cache of browse results, validated by the directory modification times.
+ *
+ * On each browse, the directory is checked with one stat: if it has not been
+ * modified since the cached browse, the result is returned without listing
+ * the directory again.
+ * The least recently used results are removed when the memory used by
+ * the cache exceeds its budget.
+ *
+ * @warning The validation is limited by what the filesystem exposes:
+ *          - a change of the target of a link is not detected,
+ *          - on network filesystems, the attribute cache of the client
+ *            could delay the detection of a change.
+ *          Directories modified in the last seconds are not cached,
+ *          because the timestamp resolution could hide a second modification
+ *          (see setRecentModificationDelay).
+ * @warning Not thread safe, use one cache per thread or protect it.
+ */
+class BrowseCache
+{
+public:
+	typedef BrowseCache This;
+
+public:
+	/**
+	 * @param[in] memoryBudget: maximal memory used by the cached results (in bytes)
+	 */
+	explicit BrowseCache( const std::size_t memoryBudget = 64 * 1024 * 1024 );
+	~BrowseCache();
+
+private:
+	BrowseCache( const BrowseCache& );
+	BrowseCache& operator=( const BrowseCache& );
+
+public:
+#ifndef SWIG
+	/**
+	 * @brief Same as browse, using the cache when the directory has not been modified.
+	 * @see browse
+	 */
+	std::vector<Item> browse(
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+	void browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+#endif
+
+	std::vector<Item> browse(
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+	{
+		return browse( boost::filesystem::path( directory ), detectOptions, filters );
+	}
+
+	/// @brief Remove the cached results of a directory (for all options and filters).
+	void invalidate( const std::string& directory );
+
+	/// @brief Remove all the cached results.
+	void clear();
+
+	std::size_t getMemoryBudget() const;
+
+	/// @brief Change the budget, removing the least recently used results if needed.
+	void setMemoryBudget( const std::size_t memoryBudget );
+
+	/// @return delay (in seconds) after a modification of a directory before it's cached
+	std::size_t getRecentModificationDelay() const;
+
+	/**
+	 * @brief Directories modified less than @p seconds ago are not cached (2 by default).
+	 * @note With 0, all the directories are cached: use it only if the timestamps
+	 *       of the filesystem are precise enough to see consecutive modifications.
+	 */
+	void setRecentModificationDelay( const std::size_t seconds );
+
+	/// @return memory used by the cached results (in bytes)
+	std::size_t getMemorySize() const;
+
+	/// @return number of cached results
+	std::size_t size() const;
+
+	std::size_t getNbHits() const;
+	std::size_t getNbMisses() const;
+	/// @return number of results removed because of the memory budget
+	std::size_t getNbEvictions() const;
+	void resetCounters();
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+
+}
+
+#endif
@@ -0,0 +1,10 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/BrowseCache.hpp"
+%}
+
+%ignore sequenceParser::BrowseCache::BrowseCache( const BrowseCache& );
+%ignore sequenceParser::BrowseCache::operator=;
+
+%include "BrowseCache.hpp"
@@ -0,0 +1,136 @@
+#include "BrowseOptions.hpp"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <algorithm>
+
+
+namespace sequenceParser {
+
+namespace {
+
+/// the clock is read every pollInterval entries (or files stat-ed) at most
+const std::size_t pollInterval = 256;
+
+}
+
+
+CancellationToken::CancellationToken()
+: _cancelled( false )
+{}
+
+void CancellationToken::cancel()
+{
+	_cancelled.store( true, boost::memory_order_relaxed );
+}
+
+void CancellationToken::reset()
+{
+	_cancelled.store( false, boost::memory_order_relaxed );
+}
+
+bool CancellationToken::isCancelled() const
+{
+	return _cancelled.load( boost::memory_order_relaxed );
+}
+
+
+BrowseOptions::BrowseOptions()
+: _token( NULL )
+, _progressHandler( NULL )
+, _progressInterval( 1024 )
+, _nbStepsSincePoll( 0 )
+, _nbStepsSinceProgress( 0 )
+{}
+
+void BrowseOptions::setCancellationToken( const CancellationToken& token )
+{
+	_token = &token;
+}
+
+void BrowseOptions::setDeadline( const boost::posix_time::ptime& deadline )
+{
+	_deadline = deadline;
+}
+
+void BrowseOptions::setTimeout( const double seconds )
+{
+	_deadline = boost::posix_time::microsec_clock::universal_time() +
+		boost::posix_time::microseconds( static_cast<boost::int64_t>( seconds * 1e6 ) );
+}
+
+void BrowseOptions::clearDeadline()
+{
+	_deadline = boost::posix_time::ptime();
+}
+
+void BrowseOptions::setProgressHandler( BrowseProgressHandler& handler )
+{
+	_progressHandler = &handler;
+}
+
+void BrowseOptions::setProgressInterval( const std::size_t nbSteps )
+{
+	_progressInterval = std::max( nbSteps, std::size_t( 1 ) );
+}
+
+void BrowseOptions::resetProgress()
+{
+	_progress = BrowseProgress();
+	_nbStepsSincePoll = 0;
+	_nbStepsSinceProgress = 0;
+}
+
+EBrowseStatus BrowseOptions::getStatus() const
+{
+	if( _token && _token->isCancelled() )
+		return eBrowseStatusCancelled;
+	if( ! _deadline.is_not_a_date_time() && boost::posix_time::microsec_clock::universal_time() >= _deadline )
+		return eBrowseStatusTimedOut;
+	return eBrowseStatusComplete;
+}
+
+EBrowseStatus BrowseOptions::addEntries( const std::size_t nbEntries ) const
+{
+	_progress.nbEntries += nbEntries;
+	return poll( nbEntries );
+}
+
+EBrowseStatus BrowseOptions::addDirectory() const
+{
+	++_progress.nbDirectories;
+	reportProgress();
+	return getStatus();
+}
+
+EBrowseStatus BrowseOptions::addStatBytes( const unsigned long long nbBytes ) const
+{
+	_progress.nbStatBytes += nbBytes;
+	return poll( 1 );
+}
+
+EBrowseStatus BrowseOptions::poll( const std::size_t nbSteps ) const
+{
+	_nbStepsSinceProgress += nbSteps;
+	if( _nbStepsSinceProgress >= _progressInterval )
+		reportProgress();
+
+	// the token is cheap to check, unlike the clock
+	if( _token && _token->isCancelled() )
+		return eBrowseStatusCancelled;
+	_nbStepsSincePoll += nbSteps;
+	if( _nbStepsSincePoll < pollInterval )
+		return eBrowseStatusComplete;
+	_nbStepsSincePoll = 0;
+	return getStatus();
+}
+
+void BrowseOptions::reportProgress() const
+{
+	_nbStepsSinceProgress = 0;
+	if( _progressHandler )
+		_progressHandler->onProgress( _progress );
+}
+
+
+}
@@ -0,0 +1,163 @@
+#ifndef _SEQUENCE_PARSER_BROWSE_OPTIONS_HPP_
+#define _SEQUENCE_PARSER_BROWSE_OPTIONS_HPP_
+
+#include "common.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+
+namespace sequenceParser {
+
+/**
+ * @brief How a long operation ended.
+ */
+enum EBrowseStatus
+{
+	eBrowseStatusComplete = 0,
+	eBrowseStatusCancelled = 1, ///< stopped by the cancellation token, the results are partial
+	eBrowseStatusTimedOut = 2 ///< stopped by the deadline, the results are partial
+};
+
+/**
+ * @brief Progress of the operations which use the same BrowseOptions.
+ */
+struct BrowseProgress
+{
+	BrowseProgress()
+	: nbEntries( 0 )
+	, nbDirectories( 0 )
+	, nbStatBytes( 0 )
+	{}
+
+	unsigned long long nbEntries; ///< entries of the directories scanned
+	unsigned long long nbDirectories; ///< directories done
+	unsigned long long nbStatBytes; ///< size of the files stat-ed
+};
+
+/**
+ * @brief Receive the progress of the operations.
+ */
+class BrowseProgressHandler
+{
+public:
+	virtual ~BrowseProgressHandler() {}
+
+	/// @brief Called in the thread of the operation, it should return quickly.
+	virtual void onProgress( const BrowseProgress& progress ) = 0;
+};
+
+/**
+ * @brief Stop long operations from another thread.
+ */
+class CancellationToken
+{
+public:
+	typedef CancellationToken This;
+
+public:
+	CancellationToken();
+
+private:
+	CancellationToken( const CancellationToken& );
+	CancellationToken& operator=( const CancellationToken& );
+
+public:
+	/// @brief The operations which use this token stop as soon as possible.
+	void cancel();
+
+	/// @brief The next operations could use this token again.
+	void reset();
+
+	bool isCancelled() const;
+
+private:
+	boost::atomic<bool> _cancelled;
+};
+
+/**
+ * @brief Control of a long operation (browse, recursive browse, stat):
+ *        a cancellation token, a deadline and a progress handler.
+ *
+ * The operations poll the options at each entry (even while the directory
+ * is listed) and at each file stat-ed: the cancellation token is checked
+ * each time, the deadline only every 256 entries or files, and after each
+ * directory. When an operation stops, it returns the results found until
+ * then, with the status.
+ * The progress is accumulated by all the operations which use the options,
+ * one operation at a time.
+ */
+class BrowseOptions
+{
+public:
+	typedef BrowseOptions This;
+
+public:
+	BrowseOptions();
+
+	/// @param[in] token: it needs to outlive the operations
+	void setCancellationToken( const CancellationToken& token );
+
+#ifndef SWIG
+	/// @brief The operations stop after this time (UTC).
+	void setDeadline( const boost::posix_time::ptime& deadline );
+#endif
+
+	/// @brief The operations stop @p seconds after now.
+	void setTimeout( const double seconds );
+
+	/// @brief Remove the deadline.
+	void clearDeadline();
+
+	/// @param[in] handler: it needs to outlive the operations
+	void setProgressHandler( BrowseProgressHandler& handler );
+
+	/// @brief The progress handler is called every @p nbSteps entries or files stat-ed (and after each directory).
+	void setProgressInterval( const std::size_t nbSteps );
+
+	/// @return progress of all the operations since the creation or resetProgress
+	const BrowseProgress& getProgress() const { return _progress; }
+
+	void resetProgress();
+
+	/// @return the status of an operation stopped now
+	EBrowseStatus getStatus() const;
+
+#ifndef SWIG
+	/**
+	 * @brief Called by the operations: count the entries scanned.
+	 * @return the status of the operation (the deadline is only checked every few entries)
+	 */
+	EBrowseStatus addEntries( const std::size_t nbEntries = 1 ) const;
+
+	/// @brief Called by the operations: count a directory done.
+	EBrowseStatus addDirectory() const;
+
+	/// @brief Called by the operations: count the bytes stat-ed.
+	EBrowseStatus addStatBytes( const unsigned long long nbBytes ) const;
+#endif
+
+private:
+	/**
+	 * @brief Count the steps of an operation (entries or files stat-ed),
+	 *        check the token at each step and the deadline every few steps.
+	 */
+	EBrowseStatus poll( const std::size_t nbSteps ) const;
+
+	void reportProgress() const;
+
+private:
+	const CancellationToken* _token;
+	boost::posix_time::ptime _deadline; ///< not_a_date_time without any deadline
+	BrowseProgressHandler* _progressHandler;
+	std::size_t _progressInterval;
+
+	mutable BrowseProgress _progress;
+	mutable std::size_t _nbStepsSincePoll; ///< steps since the last check of the status
+	mutable std::size_t _nbStepsSinceProgress; ///< steps since the last call of the progress handler
+};
+
+
+}
+
+#endif
@@ -0,0 +1,13 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/BrowseOptions.hpp"
+%}
+
+// the progress handler can be implemented in python
+%feature("director") sequenceParser::BrowseProgressHandler;
+
+%ignore sequenceParser::CancellationToken::CancellationToken( const CancellationToken& );
+%ignore sequenceParser::CancellationToken::operator=;
+
+%include "BrowseOptions.hpp"
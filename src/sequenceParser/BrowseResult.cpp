@@ -0,0 +1,185 @@
+#include "BrowseResult.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/foreach.hpp>
+
+#include <limits>
+#include <stdexcept>
+
+
+namespace sequenceParser {
+
+namespace {
+
+/// @throw std::length_error if the offsets of @p size elements don't fit in an Offset
+void checkOffset( const std::size_t size, const char* what )
+{
+	if( size > std::numeric_limits<BrowseResult::Offset>::max() )
+		throw std::length_error( std::string( "sequenceParser::BrowseResult: too many " ) + what );
+}
+
+}
+
+
+boost::string_ref BrowseResult::getName( const std::size_t index ) const
+{
+	const Offset begin = ( index == 0 ) ? 0 : _nameEnds[index - 1];
+	return boost::string_ref( _names.data() + begin, _nameEnds[index] - begin );
+}
+
+void BrowseResult::addName( const boost::string_ref& name )
+{
+	checkOffset( _names.size() + name.size(), "characters in the names" );
+	_names.append( name.begin(), name.end() );
+	_nameEnds.push_back( _names.size() );
+}
+
+std::string BrowseResult::getFilename( const std::size_t index ) const
+{
+	if( getType( index ) == eTypeSequence )
+		return getSequence( index ).getFilenameWithStandardPattern();
+	const boost::string_ref name = getName( index );
+	return std::string( name.begin(), name.end() );
+}
+
+Sequence BrowseResult::getSequence( const std::size_t index ) const
+{
+	BOOST_ASSERT( getType( index ) == eTypeSequence );
+	const std::size_t sequenceIndex = _sequenceIndexes[index];
+	const boost::string_ref name = getName( index );
+	const Offset prefixSize = _prefixSizes[sequenceIndex];
+	const Offset rangesBegin = ( sequenceIndex == 0 ) ? 0 : _rangesEnds[sequenceIndex - 1];
+
+	Sequence sequence;
+	sequence._prefix.assign( name.begin(), name.begin() + prefixSize );
+	sequence._suffix.assign( name.begin() + prefixSize, name.end() );
+	sequence._fixedPadding = _fixedPaddings[sequenceIndex];
+	sequence._maxPadding = _maxPaddings[sequenceIndex];
+	sequence._ranges.assign( _ranges.begin() + rangesBegin, _ranges.begin() + _rangesEnds[sequenceIndex] );
+	return sequence;
+}
+
+Item BrowseResult::getItem( const std::size_t index ) const
+{
+	if( getType( index ) == eTypeSequence )
+		return Item( getSequence( index ), _directory );
+	const boost::string_ref name = getName( index );
+	return Item( getType( index ), _directory / boost::filesystem::path( name.begin(), name.end() ) );
+}
+
+std::vector<Item> BrowseResult::getItems() const
+{
+	std::vector<Item> items;
+	items.reserve( size() );
+	for( std::size_t i = 0; i < size(); ++i )
+		items.push_back( getItem( i ) );
+	return items;
+}
+
+void BrowseResult::addFile( const EType type, const std::string& filename )
+{
+	addFile( type, boost::string_ref( filename ) );
+}
+
+void BrowseResult::addFile( const EType type, const boost::string_ref& filename )
+{
+	BOOST_ASSERT( type != eTypeSequence );
+	addName( filename ); // first, it could throw
+	_types.push_back( type );
+	_sequenceIndexes.push_back( getNbSequences() );
+}
+
+void BrowseResult::addSequence( const Sequence& sequence )
+{
+	// the number of characters of a number can't exceed 5 bits (see decomposeFilename)
+	BOOST_ASSERT( sequence.getMaxPadding() <= std::numeric_limits<unsigned char>::max() );
+	// before any change, the entry is added completely or not at all
+	checkOffset( _names.size() + sequence.getPrefix().size() + sequence.getSuffix().size(), "characters in the names" );
+	checkOffset( _ranges.size() + sequence.getFrameRanges().size(), "frame ranges" );
+
+	_types.push_back( eTypeSequence );
+	_sequenceIndexes.push_back( getNbSequences() );
+	_names.append( sequence.getPrefix() );
+	addName( sequence.getSuffix() );
+
+	_prefixSizes.push_back( sequence.getPrefix().size() );
+	_fixedPaddings.push_back( sequence.getFixedPadding() );
+	_maxPaddings.push_back( sequence.getMaxPadding() );
+	_ranges.insert( _ranges.end(), sequence.getFrameRanges().begin(), sequence.getFrameRanges().end() );
+	_rangesEnds.push_back( _ranges.size() );
+}
+
+void BrowseResult::addItem( const Item& item )
+{
+	BOOST_ASSERT( item.getFolderPath() == _directory );
+	if( item.getType() == eTypeSequence )
+		addSequence( item.getSequence() );
+	else
+		addFile( item.getType(), item.getPath().filename().string() );
+}
+
+void BrowseResult::swap( BrowseResult& other )
+{
+	_directory.swap( other._directory );
+	_names.swap( other._names );
+	_types.swap( other._types );
+	_nameEnds.swap( other._nameEnds );
+	_sequenceIndexes.swap( other._sequenceIndexes );
+	_prefixSizes.swap( other._prefixSizes );
+	_fixedPaddings.swap( other._fixedPaddings );
+	_maxPaddings.swap( other._maxPaddings );
+	_rangesEnds.swap( other._rangesEnds );
+	_ranges.swap( other._ranges );
+}
+
+void BrowseResult::clear()
+{
+	_names.clear();
+	_types.clear();
+	_nameEnds.clear();
+	_sequenceIndexes.clear();
+	_prefixSizes.clear();
+	_fixedPaddings.clear();
+	_maxPaddings.clear();
+	_rangesEnds.clear();
+	_ranges.clear();
+}
+
+namespace {
+template<class Container>
+void shrinkContainer( Container& container )
+{
+	Container( container ).swap( container );
+}
+}
+
+void BrowseResult::shrink()
+{
+	shrinkContainer( _names );
+	shrinkContainer( _types );
+	shrinkContainer( _nameEnds );
+	shrinkContainer( _sequenceIndexes );
+	shrinkContainer( _prefixSizes );
+	shrinkContainer( _fixedPaddings );
+	shrinkContainer( _maxPaddings );
+	shrinkContainer( _rangesEnds );
+	shrinkContainer( _ranges );
+}
+
+std::size_t BrowseResult::getMemorySize() const
+{
+	return sizeof( This ) +
+		_directory.native().capacity() +
+		_names.capacity() +
+		_types.capacity() * sizeof( unsigned char ) +
+		_nameEnds.capacity() * sizeof( Offset ) +
+		_sequenceIndexes.capacity() * sizeof( Offset ) +
+		_prefixSizes.capacity() * sizeof( Offset ) +
+		_fixedPaddings.capacity() * sizeof( unsigned char ) +
+		_maxPaddings.capacity() * sizeof( unsigned char ) +
+		_rangesEnds.capacity() * sizeof( Offset ) +
+		_ranges.capacity() * sizeof( FrameRange );
+}
+
+
+}
@@ -0,0 +1,138 @@
+#ifndef _SEQUENCE_PARSER_BROWSE_RESULT_HPP_
+#define _SEQUENCE_PARSER_BROWSE_RESULT_HPP_
+
+#include "common.hpp"
+#include "FrameRange.hpp"
+#include "Item.hpp"
+#include "Sequence.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/cstdint.hpp>
+#ifndef SWIG
+#include <boost/utility/string_ref.hpp>
+#endif
+
+#include <vector>
+
+
+namespace sequenceParser {
+
+/**
+ * @brief Compact storage of the content of one directory.
+ *
+ * Alternative to a vector of Items to keep a large number of browse results
+ * in memory: the directory is stored once, all the names are stored in one
+ * string pool, and the types, sequence descriptors and frame ranges are
+ * stored in parallel arrays.
+ * Items are only created on demand.
+ */
+class BrowseResult
+{
+public:
+	typedef BrowseResult This;
+	typedef boost::uint32_t Offset;
+
+public:
+	BrowseResult() {}
+
+	explicit BrowseResult( const boost::filesystem::path& directory )
+	: _directory( directory )
+	{}
+
+	explicit BrowseResult( const std::string& directory )
+	: _directory( directory )
+	{}
+
+public:
+	const boost::filesystem::path& getDirectoryPath() const { return _directory; }
+	std::string getDirectory() const { return _directory.string(); }
+
+	/// @return number of entries (files, folders, links and sequences)
+	std::size_t size() const { return _types.size(); }
+	bool empty() const { return _types.empty(); }
+
+	/// @return number of sequence entries
+	std::size_t getNbSequences() const { return _fixedPaddings.size(); }
+
+	EType getType( const std::size_t index ) const { return static_cast<EType>( _types[index] ); }
+
+	/**
+	 * @return the filename of the entry,
+	 *         with the standard pattern for the sequences (like "foo.####.jpg").
+	 */
+	std::string getFilename( const std::size_t index ) const;
+
+	/**
+	 * @brief Create the sequence of the entry.
+	 * @warning the entry needs to be a sequence.
+	 */
+	Sequence getSequence( const std::size_t index ) const;
+
+	/// @brief Create the Item of the entry.
+	Item getItem( const std::size_t index ) const;
+
+	/// @brief Create the Items of all the entries.
+	std::vector<Item> getItems() const;
+
+	/**
+	 * @brief Add an entry which is not a sequence (file, folder, link...).
+	 * @throw std::length_error if all the names exceed 4GB (the entry is not added)
+	 */
+	void addFile( const EType type, const std::string& filename );
+#ifndef SWIG
+	void addFile( const EType type, const boost::string_ref& filename );
+#endif
+
+	/**
+	 * @brief Add a sequence of the directory.
+	 * @throw std::length_error if all the names exceed 4GB, or the frame ranges 4G elements (the entry is not added)
+	 */
+	void addSequence( const Sequence& sequence );
+
+	/**
+	 * @brief Add an Item.
+	 * @warning the item needs to be inside the directory.
+	 */
+	void addItem( const Item& item );
+
+	void swap( BrowseResult& other );
+
+	/// @brief Remove all the entries, but keep the directory.
+	void clear();
+
+	/// @brief Release the memory not used by the entries.
+	void shrink();
+
+	/// @return an estimation of the memory used by the entries (in bytes)
+	std::size_t getMemorySize() const;
+
+private:
+#ifndef SWIG
+	boost::string_ref getName( const std::size_t index ) const;
+	void addName( const boost::string_ref& name );
+#endif
+
+private:
+	boost::filesystem::path _directory;
+
+	/// filenames of all the entries, prefix and suffix for the sequences
+	std::string _names;
+
+	// one element per entry
+	std::vector<unsigned char> _types;
+	std::vector<Offset> _nameEnds; ///< end of the entry name inside _names
+	std::vector<Offset> _sequenceIndexes; ///< number of sequences before the entry
+
+	// one element per sequence
+	std::vector<Offset> _prefixSizes; ///< the suffix is the end of the name
+	std::vector<unsigned char> _fixedPaddings;
+	std::vector<unsigned char> _maxPaddings;
+	std::vector<Offset> _rangesEnds; ///< end of the sequence ranges inside _ranges
+
+	std::vector<FrameRange> _ranges;
+};
+
+
+}
+
+#endif
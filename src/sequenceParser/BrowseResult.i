@@ -0,0 +1,7 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/BrowseResult.hpp"
+%}
+
+%include "BrowseResult.hpp"
@@ -0,0 +1,273 @@
+#include "DirectoryScan.hpp"
+#include "DirectorySource.hpp"
+
+#include "utils.hpp"
+
+#include "detail/analyze.hpp"
+#include "detail/Arena.hpp"
+#include "detail/FileNumbers.hpp"
+#include "detail/FileStrings.hpp"
+#include "detail/SeqIdMap.hpp"
+#include "detail/listing.hpp"
+#include "detail/materialize.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <algorithm>
+
+
+namespace sequenceParser {
+
+using detail::FileNumbers;
+using detail::FileStrings;
+using detail::SeqIdMap;
+namespace bfs = boost::filesystem;
+
+
+const EDetection DirectoryScan::eDetectionScanOptions = EDetection( eDetectionNegative | eDetectionIgnoreDotFile | eDetectionSequenceFromFilename );
+
+namespace {
+
+/**
+ * @brief An entry of the directory without any number in the filename.
+ */
+struct FileEntry
+{
+	FileEntry( const EType type, const boost::string_ref& filename )
+	: type( type )
+	, filename( filename )
+	{}
+
+	EType type;
+	boost::string_ref filename;
+};
+
+}
+
+struct DirectoryScan::Data
+{
+	Data( DirectorySource& source, const BrowseOptions* options, const bfs::path& directory, const EDetection scanOptions, const std::vector<std::string>& filters )
+	: source( &source )
+	, options( options )
+	, status( eBrowseStatusComplete )
+	, directory( directory )
+	, scanOptions( scanOptions )
+	, filters( filters )
+	, groups( ( detail::ArenaAllocator<SeqIdMap::value_type>( &arena ) ) )
+	, files( detail::ArenaAllocator<FileEntry>( &arena ) )
+	, subDirectories( detail::ArenaAllocator<boost::string_ref>( &arena ) )
+	{}
+
+	// all the data of the scan lives in this arena (including the filenames),
+	// it's released in one shot with the scan.
+	detail::Arena arena;
+
+	DirectorySource* source;
+	const BrowseOptions* options; ///< NULL without any control
+	EBrowseStatus status;
+	bfs::path directory;
+	EDetection scanOptions;
+	std::vector<std::string> filters;
+
+	SeqIdMap groups; ///< entries with numbers, grouped by FileStrings
+	std::vector<FileEntry, detail::ArenaAllocator<FileEntry> > files; ///< entries without number, in the listing order
+	std::vector<boost::string_ref, detail::ArenaAllocator<boost::string_ref> > subDirectories; ///< folders of the listing, in the listing order
+};
+
+
+DirectoryScan::DirectoryScan()
+: _data( new Data( getFilesystemDirectorySource(), NULL, bfs::path(), eDetectionNone, std::vector<std::string>() ) )
+{}
+
+DirectoryScan::DirectoryScan(
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	scan( directory, detectOptions, filters );
+}
+
+DirectoryScan::DirectoryScan(
+		const std::string& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	scan( boost::filesystem::path( directory ), detectOptions, filters );
+}
+
+DirectoryScan::~DirectoryScan()
+{}
+
+const boost::filesystem::path& DirectoryScan::getDirectoryPath() const
+{
+	return _data->directory;
+}
+
+EDetection DirectoryScan::getScanOptions() const
+{
+	return _data->scanOptions;
+}
+
+bool DirectoryScan::needsRescan( const EDetection detectOptions ) const
+{
+	return ( detectOptions & eDetectionScanOptions ) != _data->scanOptions;
+}
+
+std::vector<std::string> DirectoryScan::getSubDirectories() const
+{
+	std::vector<std::string> subDirectories;
+	BOOST_FOREACH( const boost::string_ref& subDirectory, _data->subDirectories )
+	{
+		subDirectories.push_back( subDirectory.to_string() );
+	}
+	std::sort( subDirectories.begin(), subDirectories.end() );
+	return subDirectories;
+}
+
+void DirectoryScan::rescan( const EDetection detectOptions )
+{
+	// copy, the data are replaced by the scan
+	const bfs::path directory( _data->directory );
+	const std::vector<std::string> filters( _data->filters );
+	scan( directory, detectOptions, filters );
+}
+
+void DirectoryScan::setDirectorySource( DirectorySource& source )
+{
+	_data->source = &source;
+}
+
+void DirectoryScan::setBrowseOptions( const BrowseOptions& options )
+{
+	_data->options = &options;
+}
+
+EBrowseStatus DirectoryScan::getStatus() const
+{
+	return _data->status;
+}
+
+void DirectoryScan::scan(
+		const boost::filesystem::path& dir,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	DirectorySource& source = _data ? *_data->source : getFilesystemDirectorySource();
+	const BrowseOptions* options = _data ? _data->options : NULL;
+	_data.reset( new Data( source, options, dir, detectOptions & eDetectionScanOptions, filters ) );
+
+	if( options )
+	{
+		_data->status = options->getStatus();
+		if( _data->status != eBrowseStatusComplete )
+			return; // don't even list the directory
+	}
+
+	std::string tmpDir( dir.string() );
+	std::vector<std::string> tmpFilters( filters );
+	std::string filename;
+
+	if( ! detectDirectoryInResearch( source, tmpDir, tmpFilters, filename ) )
+		return;
+
+	const std::vector<boost::regex> reFilters = convertFilterToRegex( tmpFilters, detectOptions );
+
+	// variables for sequence detection
+	detail::Arena& arena = _data->arena;
+	SeqIdMap& sequences = _data->groups;
+	FileStrings tmpStringParts( &arena ); // an object uniquely identify a sequence
+	FileNumbers tmpNumberParts( &arena ); // the vector of numbers inside one filename
+
+	// the options are polled while the directory is listed
+	std::vector<DirectoryEntry> entries;
+	_data->status = detail::listDirectory( source, _data->directory, entries, options );
+
+	// for all files in the directory (only the first ones if the listing has been stopped)
+	BOOST_FOREACH( const DirectoryEntry& entry, entries )
+	{
+		// clear previous infos
+		tmpStringParts.clear();
+		tmpNumberParts.clear(); // (clear but don't realloc the vector inside)
+
+		// the type from the listing: a link to a directory is not a sub-directory
+		if( entry.type == eTypeFolder &&
+		    ! ( ( detectOptions & eDetectionIgnoreDotFile ) && entry.filename[0] == '.' ) )
+			_data->subDirectories.push_back( arena.copy( entry.filename ) );
+
+		if( ! filepathRespectsAllFilters( _data->directory / entry.filename, reFilters, filename, detectOptions ) )
+			continue;
+
+		// the parts reference the filename, so it needs to stay in the arena
+		const boost::string_ref entryFilename = arena.copy( entry.filename );
+		const EType entryType = entry.type;
+
+		// if at least one number detected
+		if( decomposeFilename( entryFilename, tmpStringParts, tmpNumberParts, detectOptions ) )
+		{
+			const SeqIdMap::iterator it( sequences.find( tmpStringParts ) );
+			if( it != sequences.end() ) // is already in map
+			{
+				// append the vector of numbers
+				it->second.numbers.push_back( tmpNumberParts );
+				it->second.types |= entryType;
+			}
+			else
+			{
+				// create an entry in the map
+				detail::FileNumbersGroup group( &arena );
+				group.numbers.push_back( tmpNumberParts );
+				group.firstType = entryType;
+				group.types = entryType;
+				sequences.insert( SeqIdMap::value_type( tmpStringParts, group ) );
+			}
+		}
+		else
+		{
+			_data->files.push_back( FileEntry( entryType, entryFilename ) );
+		}
+	}
+
+	if( options && _data->status == eBrowseStatusComplete )
+		options->addDirectory();
+}
+
+template<class Output>
+void DirectoryScan::materializeTo( Output& output, const EDetection detectOptions )
+{
+	BOOST_ASSERT( ! needsRescan( detectOptions ) );
+	const bfs::path& directory = _data->directory;
+
+	BOOST_FOREACH( const FileEntry& file, _data->files )
+	{
+		output.addFile( file.type, file.filename );
+	}
+
+	// add sequences in the output
+	BOOST_FOREACH( SeqIdMap::value_type & p, _data->groups )
+	{
+		detail::materializeGroup( output, directory, p.first, p.second, detectOptions, _data->source );
+	}
+}
+
+std::vector<Item> DirectoryScan::materialize( const EDetection detectOptions )
+{
+	std::vector<Item> items;
+	if( needsRescan( detectOptions ) )
+		rescan( detectOptions );
+	detail::ItemsOutput output( items, _data->directory );
+	materializeTo( output, detectOptions );
+	return items;
+}
+
+void DirectoryScan::materialize( BrowseResult& outResult, const EDetection detectOptions )
+{
+	if( needsRescan( detectOptions ) )
+		rescan( detectOptions );
+	outResult = BrowseResult( _data->directory );
+	materializeTo( outResult, detectOptions );
+}
+
+
+}
@@ -0,0 +1,134 @@
+#ifndef _SEQUENCE_PARSER_DIRECTORY_SCAN_HPP_
+#define _SEQUENCE_PARSER_DIRECTORY_SCAN_HPP_
+
+#include "common.hpp"
+#include "BrowseOptions.hpp"
+#include "BrowseResult.hpp"
+#include "Item.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <vector>
+
+
+namespace sequenceParser {
+
+class DirectorySource;
+
+/**
+ * @brief Raw content of a directory: the entries grouped by filename
+ *        without numbers, with their types from the directory listing.
+ *
+ * The scan is the expensive part of the browse (it lists the directory),
+ * the sequences are built from the scan by materialize.
+ * So the same scan could be materialized with different detection options,
+ * without any new listing of the directory, as long as the options don't
+ * change the scan itself (see needsRescan).
+ */
+class DirectoryScan
+{
+public:
+	typedef DirectoryScan This;
+
+	/// Detection options used by the scan (filtering and tokenization of the filenames).
+	static const EDetection eDetectionScanOptions;
+
+public:
+	DirectoryScan();
+
+	/// @brief Scan the directory (see scan).
+	DirectoryScan(
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+	DirectoryScan(
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+	~DirectoryScan();
+
+private:
+	DirectoryScan( const DirectoryScan& );
+	DirectoryScan& operator=( const DirectoryScan& );
+
+public:
+	/**
+	 * @brief List the content of the directory (previous content is removed).
+	 * @param[in] directory: the input directory in which it will search.
+	 * @param[in] detectOptions: only the scan options are used (see eDetectionScanOptions).
+	 * @param[in] filters: set filters to limit the search.
+	 * @throw boost::filesystem::filesystem_error if the directory can't be listed.
+	 */
+	void scan(
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+	void scan(
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+	{
+		scan( boost::filesystem::path( directory ), detectOptions, filters );
+	}
+
+	/// @brief Scan the same directory again, with the same filters.
+	void rescan( const EDetection detectOptions );
+
+	/**
+	 * @brief Scan the directories of another source than the filesystem
+	 *        (for the next scans).
+	 * @param[in] source: it needs to outlive the scan
+	 */
+	void setDirectorySource( DirectorySource& source );
+
+	/**
+	 * @brief Control the next scans: they stop when the options say so
+	 *        (cancellation, deadline), with the entries scanned until then.
+	 * @param[in] options: it needs to outlive the scans
+	 */
+	void setBrowseOptions( const BrowseOptions& options );
+
+	/// @return if the last scan is complete, or has been stopped (partial content)
+	EBrowseStatus getStatus() const;
+
+	const boost::filesystem::path& getDirectoryPath() const;
+	EDetection getScanOptions() const;
+
+	/// @return if the scan options are not the ones of @p detectOptions
+	bool needsRescan( const EDetection detectOptions ) const;
+
+	/**
+	 * @return names of the sub-directories from the listing, sorted:
+	 *         without the links to directories, without the filters,
+	 *         and without the hidden ones with eDetectionIgnoreDotFile.
+	 */
+	std::vector<std::string> getSubDirectories() const;
+
+	/**
+	 * @brief Build the files, sequences and directories from the scan.
+	 * If the scan options are not the ones of @p detectOptions, the directory
+	 * is scanned again before (see needsRescan).
+	 * @return the same Items as browse
+	 */
+	std::vector<Item> materialize( const EDetection detectOptions = eDetectionDefault );
+
+	/// @brief Same as materialize, but fill a compact BrowseResult.
+	void materialize( BrowseResult& outResult, const EDetection detectOptions = eDetectionDefault );
+
+private:
+	template<class Output>
+	void materializeTo( Output& output, const EDetection detectOptions );
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+
+}
+
+#endif
@@ -0,0 +1,10 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/DirectoryScan.hpp"
+%}
+
+%ignore sequenceParser::DirectoryScan::DirectoryScan( const DirectoryScan& );
+%ignore sequenceParser::DirectoryScan::operator=;
+
+%include "DirectoryScan.hpp"
@@ -0,0 +1,580 @@
+#include "DirectorySource.hpp"
+#include "Item.hpp"
+#include "system.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <map>
+
+#ifdef __UNIX__
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace sequenceParser {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+boost::posix_time::ptime now()
+{
+	return boost::posix_time::microsec_clock::universal_time();
+}
+
+#ifdef __UNIX__
+EType getTypeFromMode( const mode_t mode )
+{
+	if( S_ISLNK( mode ) )
+		return eTypeLink;
+	if( S_ISREG( mode ) )
+		return eTypeFile;
+	if( S_ISDIR( mode ) )
+		return eTypeFolder;
+	return eTypeUndefined;
+}
+#endif
+
+/// Identification of a path, without the trailing separators.
+std::string getPathKey( const bfs::path& path )
+{
+	bfs::path p( path );
+	while( p.filename() == "." && p.has_parent_path() )
+		p = p.parent_path();
+	return p.string();
+}
+
+/**
+ * @brief A call to a source, with its result.
+ */
+struct Call
+{
+	Call()
+	: isListing( false )
+	, followLinks( false )
+	, succeeded( false )
+	, type( eTypeUndefined )
+	, duration( 0 )
+	{}
+
+	/// @return the key of the same calls
+	std::string getKey() const
+	{
+		return ( isListing ? "L" : ( followLinks ? "F" : "T" ) ) + path;
+	}
+
+	bool isListing; ///< listDirectory, or getType
+	std::string path;
+	bool followLinks;
+	bool succeeded;
+	EType type;
+	std::vector<DirectoryEntry> entries;
+	boost::int64_t duration; ///< in microseconds
+};
+
+/// The fields of a record are separated by '\0' (which can't be inside a path).
+static const char recordMagic[] = "sequenceParser-directory-record-2";
+/// The last field of a complete record.
+static const char recordEnd[] = "end";
+
+void writeField( std::ostream& stream, const std::string& field )
+{
+	stream.write( field.data(), field.size() );
+	stream.put( '\0' );
+}
+
+template<typename T>
+void writeNumber( std::ostream& stream, const T value )
+{
+	writeField( stream, boost::lexical_cast<std::string>( value ) );
+}
+
+/// @return false if the field is not terminated (truncated record)
+bool readField( std::istream& stream, std::string& field )
+{
+	return ! std::getline( stream, field, '\0' ).fail() && ! stream.eof();
+}
+
+template<typename T>
+bool readNumber( std::istream& stream, T& value )
+{
+	std::string field;
+	if( ! readField( stream, field ) )
+		return false;
+	try
+	{
+		value = boost::lexical_cast<T>( field );
+	}
+	catch( ... )
+	{
+		return false;
+	}
+	return true;
+}
+
+bool readType( std::istream& stream, EType& type )
+{
+	int value = 0;
+	if( ! readNumber( stream, value ) || ( value & ~eTypeAll ) != 0 )
+		return false;
+	type = EType( value );
+	return true;
+}
+
+void writeCall( std::ostream& stream, const Call& call )
+{
+	writeField( stream, call.isListing ? "list" : "type" );
+	writeField( stream, call.path );
+	writeNumber( stream, call.duration );
+	if( call.isListing )
+	{
+		writeNumber( stream, int( call.succeeded ) );
+		writeNumber( stream, call.entries.size() );
+		BOOST_FOREACH( const DirectoryEntry& entry, call.entries )
+		{
+			writeField( stream, entry.filename );
+			writeNumber( stream, int( entry.type ) );
+		}
+	}
+	else
+	{
+		writeNumber( stream, int( call.followLinks ) );
+		writeNumber( stream, int( call.type ) );
+	}
+}
+
+/// @param[in] kind: first field of the call, already read
+/// @return false if the call is incomplete or not valid
+bool readCall( std::istream& stream, const std::string& kind, Call& call )
+{
+	if( kind != "list" && kind != "type" )
+		return false;
+	call = Call();
+	call.isListing = ( kind == "list" );
+	if( ! readField( stream, call.path ) || ! readNumber( stream, call.duration ) )
+		return false;
+
+	int value = 0;
+	if( call.isListing )
+	{
+		std::size_t nbEntries = 0;
+		if( ! readNumber( stream, value ) || ! readNumber( stream, nbEntries ) )
+			return false;
+		call.succeeded = value != 0;
+		for( std::size_t i = 0; i < nbEntries; ++i )
+		{
+			DirectoryEntry entry;
+			if( ! readField( stream, entry.filename ) || ! readType( stream, entry.type ) )
+				return false;
+			call.entries.push_back( entry );
+		}
+	}
+	else
+	{
+		if( ! readNumber( stream, value ) )
+			return false;
+		call.followLinks = value != 0;
+		if( ! readType( stream, call.type ) )
+			return false;
+	}
+	return true;
+}
+
+}
+
+
+bool DirectorySource::listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries, DirectoryListingControl& control )
+{
+	const std::size_t begin = outEntries.size();
+	if( ! listDirectory( directory, outEntries ) )
+		return false;
+	for( std::size_t i = begin; i < outEntries.size(); ++i )
+	{
+		if( ! control.onEntry() )
+		{
+			outEntries.resize( i + 1 );
+			break;
+		}
+	}
+	return true;
+}
+
+
+bool FilesystemDirectorySource::listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries )
+{
+	return listFilesystemDirectory( directory, outEntries, NULL );
+}
+
+bool FilesystemDirectorySource::listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries, DirectoryListingControl& control )
+{
+	return listFilesystemDirectory( directory, outEntries, &control );
+}
+
+bool FilesystemDirectorySource::listFilesystemDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries, DirectoryListingControl* control )
+{
+#ifdef __UNIX__
+	DIR* handle = opendir( directory.c_str() );
+	if( ! handle )
+		return false;
+	while( const dirent* entry = readdir( handle ) )
+	{
+		const char* name = entry->d_name;
+		if( name[0] == '.' && ( name[1] == '\0' || ( name[1] == '.' && name[2] == '\0' ) ) )
+			continue;
+
+		EType type = eTypeUndefined;
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(__MACOS__)
+		switch( entry->d_type )
+		{
+			case DT_REG:
+				type = eTypeFile;
+				break;
+			case DT_DIR:
+				type = eTypeFolder;
+				break;
+			case DT_LNK:
+				type = eTypeLink;
+				break;
+			case DT_UNKNOWN:
+				// the filesystem doesn't give the type in the listing
+				type = getType( directory / name );
+				break;
+			default:
+				break;
+		}
+#else
+		type = getType( directory / name );
+#endif
+		outEntries.push_back( DirectoryEntry( name, type ) );
+		if( control && ! control->onEntry() )
+			break;
+	}
+	closedir( handle );
+	return true;
+#else
+	boost::system::error_code errorCode;
+	bfs::directory_iterator itEnd;
+	bfs::directory_iterator it( directory, errorCode );
+	for( ; ! errorCode && it != itEnd; it.increment( errorCode ) )
+	{
+		outEntries.push_back( DirectoryEntry( it->path().filename().string(), getTypeFromSymlinkStatus( it->symlink_status( errorCode ) ) ) );
+		if( control && ! control->onEntry() )
+			break;
+	}
+	return ! errorCode;
+#endif
+}
+
+EType FilesystemDirectorySource::getType( const boost::filesystem::path& path, const bool followLinks )
+{
+#ifdef __UNIX__
+	struct stat status;
+	if( ( followLinks ? stat( path.c_str(), &status ) : lstat( path.c_str(), &status ) ) != 0 )
+		return eTypeUndefined;
+	return getTypeFromMode( status.st_mode );
+#else
+	boost::system::error_code errorCode;
+	const bfs::file_status status = followLinks ? bfs::status( path, errorCode ) : bfs::symlink_status( path, errorCode );
+	if( errorCode )
+		return eTypeUndefined;
+	return getTypeFromSymlinkStatus( status );
+#endif
+}
+
+DirectorySource& getFilesystemDirectorySource()
+{
+	// without any state, it could be shared by all the threads
+	static FilesystemDirectorySource source;
+	return source;
+}
+
+
+struct MemoryDirectorySource::Data
+{
+	struct Entry
+	{
+		Entry()
+		: type( eTypeUndefined )
+		, targetType( eTypeUndefined )
+		, listingIndex( 0 )
+		{}
+
+		EType type;
+		EType targetType;
+		std::size_t listingIndex; ///< in the listing of the parent directory
+	};
+
+	std::map<std::string, Entry> entries; ///< by path
+	std::map<std::string, std::vector<DirectoryEntry> > directories; ///< by path
+};
+
+
+MemoryDirectorySource::MemoryDirectorySource()
+: _data( new Data() )
+{}
+
+MemoryDirectorySource::~MemoryDirectorySource()
+{}
+
+void MemoryDirectorySource::addEntry( const std::string& path, const EType type, const EType targetType )
+{
+	const bfs::path entryPath( getPathKey( path ) );
+	const std::string key = entryPath.string();
+	if( key.empty() )
+		return;
+
+	const std::pair<std::map<std::string, Data::Entry>::iterator, bool> inserted =
+		_data->entries.insert( std::make_pair( key, Data::Entry() ) );
+	Data::Entry& entry = inserted.first->second;
+	entry.type = type;
+	entry.targetType = targetType;
+	if( type == eTypeFolder )
+		_data->directories[key]; // could be listed, even empty
+
+	const bfs::path parent = entryPath.parent_path();
+	if( parent.empty() || parent == entryPath )
+		return;
+	if( _data->entries.find( parent.string() ) == _data->entries.end() )
+		addEntry( parent.string(), eTypeFolder );
+
+	std::vector<DirectoryEntry>& listing = _data->directories[parent.string()];
+	if( inserted.second )
+	{
+		entry.listingIndex = listing.size();
+		listing.push_back( DirectoryEntry( entryPath.filename().string(), type ) );
+		return;
+	}
+	listing[entry.listingIndex].type = type;
+}
+
+void MemoryDirectorySource::clear()
+{
+	_data->entries.clear();
+	_data->directories.clear();
+}
+
+bool MemoryDirectorySource::listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries )
+{
+	if( getType( directory ) != eTypeFolder )
+		return false;
+
+	const std::map<std::string, std::vector<DirectoryEntry> >::const_iterator it = _data->directories.find( getPathKey( directory ) );
+	if( it != _data->directories.end() )
+		outEntries.insert( outEntries.end(), it->second.begin(), it->second.end() );
+	return true;
+}
+
+EType MemoryDirectorySource::getType( const boost::filesystem::path& path, const bool followLinks )
+{
+	const std::map<std::string, Data::Entry>::const_iterator it = _data->entries.find( getPathKey( path ) );
+	if( it == _data->entries.end() )
+		return eTypeUndefined;
+	if( followLinks && it->second.type == eTypeLink )
+		return it->second.targetType;
+	return it->second.type;
+}
+
+
+struct RecordingDirectorySource::Data
+{
+	explicit Data( DirectorySource& source )
+	: source( source )
+	{}
+
+	DirectorySource& source;
+	mutable boost::mutex mutex;
+	std::vector<Call> calls;
+};
+
+
+RecordingDirectorySource::RecordingDirectorySource( DirectorySource& source )
+: _data( new Data( source ) )
+{}
+
+RecordingDirectorySource::~RecordingDirectorySource()
+{}
+
+bool RecordingDirectorySource::save( const std::string& filename ) const
+{
+	bfs::ofstream stream( filename, std::ios::out | std::ios::binary | std::ios::trunc );
+	if( ! stream )
+		return false;
+	writeField( stream, recordMagic );
+
+	boost::mutex::scoped_lock lock( _data->mutex );
+	BOOST_FOREACH( const Call& call, _data->calls )
+	{
+		writeCall( stream, call );
+	}
+	writeField( stream, recordEnd );
+	stream.close();
+	return ! stream.fail();
+}
+
+std::size_t RecordingDirectorySource::getNbCalls() const
+{
+	boost::mutex::scoped_lock lock( _data->mutex );
+	return _data->calls.size();
+}
+
+bool RecordingDirectorySource::listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries )
+{
+	Call call;
+	call.isListing = true;
+	call.path = getPathKey( directory );
+
+	const boost::posix_time::ptime begin = now();
+	call.succeeded = _data->source.listDirectory( directory, call.entries );
+	call.duration = ( now() - begin ).total_microseconds();
+
+	outEntries.insert( outEntries.end(), call.entries.begin(), call.entries.end() );
+	const bool succeeded = call.succeeded;
+
+	boost::mutex::scoped_lock lock( _data->mutex );
+	_data->calls.push_back( call );
+	return succeeded;
+}
+
+EType RecordingDirectorySource::getType( const boost::filesystem::path& path, const bool followLinks )
+{
+	Call call;
+	call.path = getPathKey( path );
+	call.followLinks = followLinks;
+
+	const boost::posix_time::ptime begin = now();
+	call.type = _data->source.getType( path, followLinks );
+	call.duration = ( now() - begin ).total_microseconds();
+	const EType type = call.type;
+
+	boost::mutex::scoped_lock lock( _data->mutex );
+	_data->calls.push_back( call );
+	return type;
+}
+
+
+struct ReplayDirectorySource::Data
+{
+	Data()
+	: withLatencies( true )
+	, nbCalls( 0 )
+	{}
+
+	/// @return the next result of the call, or NULL if it's not recorded
+	const Call* getNextCall( const std::string& key )
+	{
+		boost::mutex::scoped_lock lock( mutex );
+		std::map<std::string, Replay>::iterator it = calls.find( key );
+		if( it == calls.end() )
+			return NULL;
+		Replay& replay = it->second;
+		const Call* call = &replay.calls[replay.next];
+		if( replay.next + 1 < replay.calls.size() )
+			++replay.next;
+		return call;
+	}
+
+	void wait( const Call& call ) const
+	{
+		if( withLatencies && call.duration > 0 )
+			boost::this_thread::sleep( boost::posix_time::microseconds( call.duration ) );
+	}
+
+	struct Replay
+	{
+		Replay()
+		: next( 0 )
+		{}
+
+		std::vector<Call> calls; ///< in the recording order
+		std::size_t next;
+	};
+
+	boost::mutex mutex;
+	std::map<std::string, Replay> calls; ///< by key
+	bool withLatencies;
+	std::size_t nbCalls;
+};
+
+
+ReplayDirectorySource::ReplayDirectorySource()
+: _data( new Data() )
+{}
+
+ReplayDirectorySource::ReplayDirectorySource( const std::string& filename, const bool withLatencies )
+: _data( new Data() )
+{
+	load( filename, withLatencies );
+}
+
+ReplayDirectorySource::~ReplayDirectorySource()
+{}
+
+bool ReplayDirectorySource::load( const std::string& filename, const bool withLatencies )
+{
+	boost::scoped_ptr<Data> data( new Data() );
+	data->withLatencies = withLatencies;
+
+	bfs::ifstream stream( filename, std::ios::in | std::ios::binary );
+	std::string magic;
+	if( ! readField( stream, magic ) || magic != recordMagic )
+		return false;
+
+	std::string kind;
+	Call call;
+	for( ;; )
+	{
+		if( ! readField( stream, kind ) )
+			return false; // truncated
+		if( kind == recordEnd )
+			break;
+		if( ! readCall( stream, kind, call ) )
+			return false; // not a valid record, or truncated
+		data->calls[call.getKey()].calls.push_back( call );
+		++data->nbCalls;
+	}
+	if( stream.peek() != std::char_traits<char>::eof() )
+		return false; // something after the end
+
+	_data.swap( data );
+	return true;
+}
+
+std::size_t ReplayDirectorySource::getNbCalls() const
+{
+	return _data->nbCalls;
+}
+
+bool ReplayDirectorySource::listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries )
+{
+	Call key;
+	key.isListing = true;
+	key.path = getPathKey( directory );
+	const Call* call = _data->getNextCall( key.getKey() );
+	if( ! call )
+		return false;
+	_data->wait( *call );
+	outEntries.insert( outEntries.end(), call->entries.begin(), call->entries.end() );
+	return call->succeeded;
+}
+
+EType ReplayDirectorySource::getType( const boost::filesystem::path& path, const bool followLinks )
+{
+	Call key;
+	key.path = getPathKey( path );
+	key.followLinks = followLinks;
+	const Call* call = _data->getNextCall( key.getKey() );
+	if( ! call )
+		return eTypeUndefined;
+	_data->wait( *call );
+	return call->type;
+}
+
+
+}
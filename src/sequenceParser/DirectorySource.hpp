@@ -0,0 +1,230 @@
+#ifndef _SEQUENCE_PARSER_DIRECTORY_SOURCE_HPP_
+#define _SEQUENCE_PARSER_DIRECTORY_SOURCE_HPP_
+
+#include "common.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace sequenceParser {
+
+/**
+ * @brief An entry of a directory listing.
+ */
+struct DirectoryEntry
+{
+	DirectoryEntry()
+	: type( eTypeUndefined )
+	{}
+
+	DirectoryEntry( const std::string& filename, const EType type )
+	: filename( filename )
+	, type( type )
+	{}
+
+	std::string filename;
+	EType type; ///< type from the listing: the links are not followed
+};
+
+/**
+ * @brief Called by a listing for each entry, to stop it (cancellation, deadline).
+ */
+class DirectoryListingControl
+{
+public:
+	virtual ~DirectoryListingControl() {}
+
+	/// @return false to stop the listing, with the entries listed until then
+	virtual bool onEntry() = 0;
+};
+
+/**
+ * @brief Where the detection gets the content of the directories.
+ *
+ * The detection only needs to list a directory and to know the type of
+ * an entry, so it could run on something else than the filesystem
+ * (a catalogue, a recorded listing...), or be tested without any disk.
+ * A source could be used by several threads at once.
+ */
+class DirectorySource
+{
+public:
+	typedef DirectorySource This;
+
+public:
+	virtual ~DirectorySource() {}
+
+	/**
+	 * @brief List the entries of a directory (without "." and "..").
+	 * @param[out] outEntries: the entries are added at the end
+	 * @return false if the directory can't be listed
+	 */
+	virtual bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries ) = 0;
+
+	/**
+	 * @brief Same as listDirectory, but the listing could be stopped after each entry.
+	 * By default, the directory is listed at once, then the entries are given to the control.
+	 * @return false if the directory can't be listed (a stopped listing succeeds)
+	 */
+	virtual bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries, DirectoryListingControl& control );
+
+	/**
+	 * @brief Type of an entry (like a stat).
+	 * @param[in] followLinks: type of the target of a link, instead of eTypeLink
+	 * @return eTypeUndefined if the entry doesn't exist
+	 */
+	virtual EType getType( const boost::filesystem::path& path, const bool followLinks = false ) = 0;
+
+	/// @return if the path exists, the links are followed
+	bool exists( const boost::filesystem::path& path ) { return getType( path, true ) != eTypeUndefined; }
+
+	/// @return if the path is a directory, or a link to a directory
+	bool isDirectory( const boost::filesystem::path& path ) { return getType( path, true ) == eTypeFolder; }
+};
+
+/**
+ * @brief The directories of the filesystem.
+ *
+ * On Unix, the types come from the directory listing itself (readdir),
+ * without any stat of the entries, when the filesystem provides them.
+ */
+class FilesystemDirectorySource : public DirectorySource
+{
+public:
+	bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries );
+	/// @brief The control is called during the listing itself, between the reads of the directory.
+	bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries, DirectoryListingControl& control );
+	EType getType( const boost::filesystem::path& path, const bool followLinks = false );
+
+private:
+	/// @param[in] control: NULL to list the whole directory
+	bool listFilesystemDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries, DirectoryListingControl* control );
+};
+
+/// @return the source used by default by the detection
+DirectorySource& getFilesystemDirectorySource();
+
+/**
+ * @brief Directories described in memory.
+ *
+ * The parent directories of an entry are created when the entry is added.
+ */
+class MemoryDirectorySource : public DirectorySource
+{
+public:
+	typedef MemoryDirectorySource This;
+
+public:
+	MemoryDirectorySource();
+	~MemoryDirectorySource();
+
+private:
+	MemoryDirectorySource( const MemoryDirectorySource& );
+	MemoryDirectorySource& operator=( const MemoryDirectorySource& );
+
+public:
+	/**
+	 * @brief Add an entry (a folder could be listed, even without any entry inside).
+	 * @param[in] targetType: type of the target of a link (a link to nothing by default)
+	 */
+	void addEntry( const std::string& path, const EType type = eTypeFile, const EType targetType = eTypeUndefined );
+
+	/// @brief Remove all the entries.
+	void clear();
+
+	using DirectorySource::listDirectory;
+	bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries );
+	EType getType( const boost::filesystem::path& path, const bool followLinks = false );
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+/**
+ * @brief Record the results of another source, with the time they take.
+ *
+ * The record could be saved and replayed later by a ReplayDirectorySource,
+ * to reproduce the detection on the content of a remote filer
+ * (with its latencies) without any access to it.
+ */
+class RecordingDirectorySource : public DirectorySource
+{
+public:
+	typedef RecordingDirectorySource This;
+
+public:
+	/// @param[in] source: the recorded source, it needs to outlive the recording
+	explicit RecordingDirectorySource( DirectorySource& source );
+	~RecordingDirectorySource();
+
+private:
+	RecordingDirectorySource( const RecordingDirectorySource& );
+	RecordingDirectorySource& operator=( const RecordingDirectorySource& );
+
+public:
+	/// @return false if the file can't be written
+	bool save( const std::string& filename ) const;
+
+	/// @return number of calls recorded
+	std::size_t getNbCalls() const;
+
+	using DirectorySource::listDirectory;
+	bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries );
+	EType getType( const boost::filesystem::path& path, const bool followLinks = false );
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+/**
+ * @brief Replay the results recorded by a RecordingDirectorySource.
+ *
+ * The calls which are recorded several times are replayed in the same order
+ * (the last result is repeated), the calls which are not recorded fail
+ * (like a missing directory).
+ */
+class ReplayDirectorySource : public DirectorySource
+{
+public:
+	typedef ReplayDirectorySource This;
+
+public:
+	ReplayDirectorySource();
+	/// @see load
+	explicit ReplayDirectorySource( const std::string& filename, const bool withLatencies = true );
+	~ReplayDirectorySource();
+
+private:
+	ReplayDirectorySource( const ReplayDirectorySource& );
+	ReplayDirectorySource& operator=( const ReplayDirectorySource& );
+
+public:
+	/**
+	 * @brief Load a record (the previous one is removed).
+	 * @param[in] withLatencies: each call takes the time it took during the recording
+	 * @return false if the file can't be read, or is not a complete record
+	 */
+	bool load( const std::string& filename, const bool withLatencies = true );
+
+	/// @return number of calls loaded
+	std::size_t getNbCalls() const;
+
+	using DirectorySource::listDirectory;
+	bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries );
+	EType getType( const boost::filesystem::path& path, const bool followLinks = false );
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+
+}
+
+#endif
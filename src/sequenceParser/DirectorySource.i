@@ -0,0 +1,23 @@
+%include "common.i"
+
+%include <std_vector.i>
+
+%{
+#include "sequenceParser/DirectorySource.hpp"
+%}
+
+%template(DirectoryEntryVector) ::std::vector<sequenceParser::DirectoryEntry>;
+
+%ignore sequenceParser::MemoryDirectorySource::MemoryDirectorySource( const MemoryDirectorySource& );
+%ignore sequenceParser::MemoryDirectorySource::operator=;
+%ignore sequenceParser::RecordingDirectorySource::RecordingDirectorySource( const RecordingDirectorySource& );
+%ignore sequenceParser::RecordingDirectorySource::operator=;
+%ignore sequenceParser::ReplayDirectorySource::ReplayDirectorySource( const ReplayDirectorySource& );
+%ignore sequenceParser::ReplayDirectorySource::operator=;
+
+// the listings are only controlled from C++ (see BrowseOptions)
+%ignore sequenceParser::DirectoryListingControl;
+%ignore listDirectory( const boost::filesystem::path&, std::vector<DirectoryEntry>&, DirectoryListingControl& );
+
+%include "DirectorySource.hpp"
+
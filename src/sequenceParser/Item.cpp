@@ -1,4 +1,5 @@
 #include "Item.hpp"
+#include "DirectorySource.hpp"
 
 #include <boost/filesystem.hpp>
 
@@ -39,19 +40,23 @@ std::string Item::getFirstFilename() const
 
 EType getTypeFromPath( const boost::filesystem::path& path )
 {
-	if( bfs::is_symlink( path ) )
-	{
-		return eTypeLink;
-	}
-	if( bfs::is_regular_file( path ) )
-	{
-		return eTypeFile;
-	}
-	if( bfs::is_directory( path ) )
+	return getFilesystemDirectorySource().getType( path );
+}
+
+
+EType getTypeFromSymlinkStatus( const boost::filesystem::file_status& symlinkStatus )
+{
+	switch( symlinkStatus.type() )
 	{
-		return eTypeFolder;
+		case bfs::symlink_file:
+			return eTypeLink;
+		case bfs::regular_file:
+			return eTypeFile;
+		case bfs::directory_file:
+			return eTypeFolder;
+		default:
+			return eTypeUndefined;
 	}
-	return eTypeUndefined;
 }
 
 
@@ -68,6 +68,31 @@ public:
 		_path /= sequence.getFilenameWithStandardPattern();
 	}
 
+#if !defined(SWIG) && !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+	Item( const EType type, boost::filesystem::path&& filepath )
+	: _type(type)
+	, _path(std::move(filepath))
+	{
+		BOOST_ASSERT( type != eTypeSequence );
+	}
+
+	Item( Sequence&& sequence, const boost::filesystem::path& folder )
+	: _type(eTypeSequence)
+	, _path(folder)
+	, _sequence(std::move(sequence))
+	{
+		_path /= _sequence.getFilenameWithStandardPattern();
+	}
+
+	Item( Sequence&& sequence, const std::string& folder )
+	: _type(eTypeSequence)
+	, _path(folder)
+	, _sequence(std::move(sequence))
+	{
+		_path /= _sequence.getFilenameWithStandardPattern();
+	}
+#endif
+
 	EType getType() const { return _type; }
 
 	std::string getAbsoluteFilepath() const { return _path.string(); }
@@ -105,6 +130,14 @@ private:
 
 #ifndef SWIG
 EType getTypeFromPath( const boost::filesystem::path& path );
+
+/**
+ * @brief Same as getTypeFromPath, from the status of a directory entry
+ *        (without following symlinks).
+ * @note On most filesystems, the directory listing already gives this status,
+ *       so there is no stat call.
+ */
+EType getTypeFromSymlinkStatus( const boost::filesystem::file_status& symlinkStatus );
 #endif
 EType getTypeFromPath( const std::string& pathStr );
 
@@ -14,6 +14,7 @@ namespace bfs = boost::filesystem;
 namespace sequenceParser {
 
 ItemStat::ItemStat( const EType& type, const boost::filesystem::path& path, const bool approximative )
+: status( eBrowseStatusComplete )
 {
 	switch(type)
 	{
@@ -39,6 +40,18 @@ ItemStat::ItemStat( const EType& type, const boost::filesystem::path& path, cons
 }
 
 ItemStat::ItemStat( const Item& item, const bool approximative )
+: status( eBrowseStatusComplete )
+{
+	stat( item, approximative, NULL );
+}
+
+ItemStat::ItemStat( const Item& item, const BrowseOptions& options, const bool approximative )
+: status( eBrowseStatusComplete )
+{
+	stat( item, approximative, &options );
+}
+
+void ItemStat::stat( const Item& item, const bool approximative, const BrowseOptions* options )
 {
 	switch(item.getType())
 	{
@@ -59,12 +72,14 @@ ItemStat::ItemStat( const Item& item, const bool approximative )
 		}
 		case eTypeSequence:
 		{
-			statSequence( item, approximative );
-			break;
+			statSequence( item, approximative, options );
+			return;
 		}
 		case eTypeUndefined:
 			BOOST_ASSERT(false);
 	}
+	if( options )
+		status = options->addStatBytes( size );
 }
 
 std::string ItemStat::getUserName() const
@@ -259,7 +274,7 @@ void ItemStat::statFile( const boost::filesystem::path& path )
 	realSize = size / nbHardLinks;
 }
 
-void ItemStat::statSequence( const Item& item, const bool approximative )
+void ItemStat::statSequence( const Item& item, const bool approximative, const BrowseOptions* options )
 {
 	using namespace boost::filesystem;
 	using namespace sequenceParser;
@@ -305,6 +320,18 @@ void ItemStat::statSequence( const Item& item, const bool approximative )
 
 	bfs::path folder = item.getFolderPath();
 
+	// the options are only polled every few files
+	if( options )
+	{
+		status = options->getStatus();
+		if( status != eBrowseStatusComplete )
+		{
+			nbHardLinks = 0; // no file stat-ed
+			return;
+		}
+	}
+
+	std::size_t nbStatFiles = 0;
 	BOOST_FOREACH( Time t, seq.getFramesIterable() )
 	{
 		boost::filesystem::path filepath = folder / seq.getFilenameAt(t);
@@ -353,9 +380,21 @@ void ItemStat::statSequence( const Item& item, const bool approximative )
 			maxSize = fileStat.size;
 		realSize += fileStat.realSize;
 		sizeOnDisk += fileStat.sizeOnDisk;
+		++nbStatFiles;
+
+		if( options )
+		{
+			status = options->addStatBytes( fileStat.size );
+			if( status != eBrowseStatusComplete )
+				break;
+		}
 	}
 
-	nbHardLinks = fullNbHardLinks / (double)(seq.getLastTime() - seq.getFirstTime() + 1);
+	// a stopped stat only covers the first files
+	if( status != eBrowseStatusComplete )
+		nbHardLinks = fullNbHardLinks / (double)nbStatFiles;
+	else
+		nbHardLinks = fullNbHardLinks / (double)(seq.getLastTime() - seq.getFirstTime() + 1);
 }
 
 }
@@ -2,6 +2,7 @@
 #define _SEQUENCE_PARSER_ITEMSTAT_HPP_
 
 #include "common.hpp"
+#include "BrowseOptions.hpp"
 #include "Item.hpp"
 #include "system.hpp"
 
@@ -17,14 +18,22 @@ class ItemStat
 public:
 	ItemStat( const Item& item, const bool approximative=true );
 	ItemStat( const EType& type, const boost::filesystem::path& path, const bool approximative=true );
+	/**
+	 * @brief Stat controlled by options: the files of a sequence are counted
+	 *        in the progress, and the stat stops with the options.
+	 * @note If the stat has been stopped, the values only cover the first files of the sequence.
+	 * @see status
+	 */
+	ItemStat( const Item& item, const BrowseOptions& options, const bool approximative=true );
 
 	std::string getUserName() const;
 	std::string getGroupName() const;
 
 private:
+	void stat( const Item& item, const bool approximative, const BrowseOptions* options );
 	void statFolder( const boost::filesystem::path& path );
 	void statFile( const boost::filesystem::path& path );
-	void statSequence( const Item& item, const bool approximative );
+	void statSequence( const Item& item, const bool approximative, const BrowseOptions* options );
 	void statLink( const boost::filesystem::path& path );
 	void setDefaultValues();
 #ifdef __UNIX__
@@ -70,6 +79,8 @@ public:
 	bool otherCanRead;
 	bool otherCanWrite;
 	bool otherCanExecute;
+
+	EBrowseStatus status; ///< if the stat is complete, or how it has been stopped
 };
 
 }
@@ -1,6 +1,8 @@
 #include "Sequence.hpp"
 
+#include "detail/analyze.hpp"
 #include "detail/FileNumbers.hpp"
+#include "detail/PaddingHistogram.hpp"
 
 #include <boost/filesystem/path.hpp>
 #include <boost/regex.hpp>
@@ -105,23 +107,57 @@ std::size_t extractStep( const std::vector<Time>& times )
 }
 
 
-/**
- * @brief Extract step from a sorted vector of time values.
- */
-std::size_t extractStep( const std::vector<detail::FileNumbers>::const_iterator& timesBegin, const std::vector<detail::FileNumbers>::const_iterator& timesEnd, const std::size_t i )
+namespace {
+
+template<class Iterator>
+std::size_t extractStepOfNumbers( const Iterator& timesBegin, const Iterator& timesEnd, const std::size_t i )
 {
 	if( std::distance( timesBegin, timesEnd ) <= 1 )
 	{
 		return 1;
 	}
 	std::set<std::size_t> allSteps;
-	for( std::vector<detail::FileNumbers>::const_iterator itA = timesBegin, itB = boost::next(timesBegin), itEnd = timesEnd; itB != itEnd; ++itA, ++itB )
+	for( Iterator itA = timesBegin, itB = boost::next(timesBegin), itEnd = timesEnd; itB != itEnd; ++itA, ++itB )
 	{
 		allSteps.insert( itB->getTime( i ) - itA->getTime( i ) );
 	}
 	return greatestCommonDivisor( allSteps );
 }
 
+template<class Iterator>
+std::size_t extractPaddingOfNumbers( const Iterator& timesBegin, const Iterator& timesEnd, const std::size_t i )
+{
+	BOOST_ASSERT( timesBegin != timesEnd );
+
+	const detail::PaddingHistogram histogram( timesBegin, timesEnd, i );
+
+	if( histogram.getNbStrictPaddings() == 1 )
+	{
+		return histogram.getFirstPadding( 1 );
+	}
+
+	// no padding or
+	// @todo multi-padding !
+	// need to split into multiple sequences !
+	return 0;
+}
+
+}
+
+
+/**
+ * @brief Extract step from a sorted vector of time values.
+ */
+std::size_t extractStep( const std::vector<detail::FileNumbers>::const_iterator& timesBegin, const std::vector<detail::FileNumbers>::const_iterator& timesEnd, const std::size_t i )
+{
+	return extractStepOfNumbers( timesBegin, timesEnd, i );
+}
+
+std::size_t extractStep( const detail::FileNumbersVector::const_iterator& timesBegin, const detail::FileNumbersVector::const_iterator& timesEnd, const std::size_t i )
+{
+	return extractStepOfNumbers( timesBegin, timesEnd, i );
+}
+
 
 std::size_t getFixedPaddingFromStringNumber( const std::string& timeStr )
 {
@@ -159,34 +195,12 @@ std::size_t extractPadding( const std::vector<std::string>& timesStr )
 
 std::size_t extractPadding( const std::vector<detail::FileNumbers>::const_iterator& timesBegin, const std::vector<detail::FileNumbers>::const_iterator& timesEnd, const std::size_t i )
 {
-	BOOST_ASSERT( timesBegin != timesEnd );
+	return extractPaddingOfNumbers( timesBegin, timesEnd, i );
+}
 
-	std::set<std::size_t> padding;
-	std::set<std::size_t> maxPadding;
-	
-	for( std::vector<detail::FileNumbers>::const_iterator s = timesBegin;
-		 s != timesEnd;
-		 ++s )
-	{
-		padding.insert( s->getFixedPadding(i) );
-		maxPadding.insert( s->getMaxPadding(i) );
-	}
-	
-	std::set<std::size_t> pad = padding;
-	pad.erase(0);
-	
-	if( pad.size() == 0 )
-	{
-		return 0;
-	}
-	else if( pad.size() == 1 )
-	{
-		return *pad.begin();
-	}
-	
-	// @todo multi-padding !
-	// need to split into multiple sequences !
-	return 0;
+std::size_t extractPadding( const detail::FileNumbersVector::const_iterator& timesBegin, const detail::FileNumbersVector::const_iterator& timesEnd, const std::size_t i )
+{
+	return extractPaddingOfNumbers( timesBegin, timesEnd, i );
 }
 
 std::string Sequence::getFilenameAt( const Time time ) const
@@ -5,9 +5,11 @@
 #include "FrameRange.hpp"
 
 #include <boost/lexical_cast.hpp>
+#include <boost/config.hpp>
 
 #include <iomanip>
 #include <set>
+#include <utility>
 
 
 namespace sequenceParser {
@@ -57,13 +59,21 @@ public:
 	}
 
 	Sequence( const Sequence& v )
+	: _prefix( v._prefix )
+	, _suffix( v._suffix )
+	, _maxPadding( v._maxPadding )
+	, _fixedPadding( v._fixedPadding )
+	, _ranges( v._ranges )
 	{
-		operator=( v );
 	}
 
 	Sequence( const boost::filesystem::path& directory, const Sequence& v )
+	: _prefix( v._prefix )
+	, _suffix( v._suffix )
+	, _maxPadding( v._maxPadding )
+	, _fixedPadding( v._fixedPadding )
+	, _ranges( v._ranges )
 	{
-		operator=( v );
 	}
 
 	Sequence& operator=( const Sequence& other )
@@ -75,6 +85,45 @@ public:
 		_ranges = other._ranges;
 		return *this;
 	}
+
+#if !defined(SWIG) && !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+	Sequence( const std::string& pattern, std::vector<FrameRange>&& frameRanges, const EPattern accept = ePatternDefault )
+	{
+		if( initFromPattern( pattern, accept ) )
+		{
+			_ranges = std::move( frameRanges );
+		}
+	}
+
+	Sequence( Sequence&& v )
+	: _prefix( std::move( v._prefix ) )
+	, _suffix( std::move( v._suffix ) )
+	, _maxPadding( v._maxPadding )
+	, _fixedPadding( v._fixedPadding )
+	, _ranges( std::move( v._ranges ) )
+	{
+	}
+
+	Sequence( const boost::filesystem::path& directory, Sequence&& v )
+	: _prefix( std::move( v._prefix ) )
+	, _suffix( std::move( v._suffix ) )
+	, _maxPadding( v._maxPadding )
+	, _fixedPadding( v._fixedPadding )
+	, _ranges( std::move( v._ranges ) )
+	{
+	}
+
+	Sequence& operator=( Sequence&& other )
+	{
+		_prefix = std::move( other._prefix );
+		_suffix = std::move( other._suffix );
+		_maxPadding = other._maxPadding;
+		_fixedPadding = other._fixedPadding;
+		_ranges = std::move( other._ranges );
+		return *this;
+	}
+#endif
+
 	
 	Sequence* clone() const { return new Sequence(*this); }
 
@@ -123,9 +172,9 @@ public:
 	/// @brief filename without frame number
 	inline std::string getIdentification() const;
 
-	inline std::string getPrefix() const;
+	inline const std::string& getPrefix() const;
 
-	inline std::string getSuffix() const;
+	inline const std::string& getSuffix() const;
 
 	/**
 	 * @brief Check if the filename is inside the sequence and return it's time value.
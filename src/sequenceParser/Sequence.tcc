@@ -70,12 +70,12 @@ inline std::string Sequence::getIdentification() const
 	return _prefix + _suffix;
 }
 
-inline std::string Sequence::getPrefix() const
+inline const std::string& Sequence::getPrefix() const
 {
 	return _prefix;
 }
 
-inline std::string Sequence::getSuffix() const
+inline const std::string& Sequence::getSuffix() const
 {
 	return _suffix;
 }
@@ -0,0 +1,212 @@
+#include "SequenceBuilder.hpp"
+
+#include <boost/foreach.hpp>
+#include <boost/next_prior.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace sequenceParser {
+
+namespace {
+
+/// Number of frames added out of order before a merge.
+static const std::size_t maxPendingFrames = 1024;
+
+/**
+ * @brief Add a frame after the last one, like extractFrameRanges.
+ * @warning @p time needs to be after the last frame of the ranges.
+ */
+void appendFrame( std::vector<FrameRange>& ranges, const Time time )
+{
+	if( ranges.empty() )
+	{
+		ranges.push_back( FrameRange( time ) );
+		return;
+	}
+	FrameRange& prevRange = ranges.back();
+	const Time newStep = time - prevRange.last;
+	if( prevRange.step == newStep )
+	{
+		// same step as previous range, so update it.
+		prevRange.last = time;
+	}
+	else if( prevRange.first == prevRange.last )
+	{
+		// the previous range only contains one frame (without step)
+		// so update it with the new step
+		prevRange.last = time;
+		prevRange.step = newStep;
+	}
+	else if( prevRange.getNbFrames() == 2 )
+	{
+		// The previous range has only 2 frames, so it's not really a range...
+		// So steal the frame of the previous range.
+		const FrameRange newFrameRange( prevRange.last, time, newStep );
+		prevRange.last = prevRange.first;
+		prevRange.step = 1;
+		ranges.push_back( newFrameRange );
+	}
+	else
+	{
+		// The previous range is complete.
+		ranges.push_back( FrameRange( time ) );
+	}
+}
+
+bool isBeforeRange( const Time time, const FrameRange& range )
+{
+	return time < range.first;
+}
+
+bool isInRanges( const std::vector<FrameRange>& ranges, const Time time )
+{
+	// last range which begins before the frame
+	std::vector<FrameRange>::const_iterator it = std::upper_bound( ranges.begin(), ranges.end(), time, &isBeforeRange );
+	if( it == ranges.begin() )
+		return false;
+	--it;
+	return time <= it->last && ( time - it->first ) % it->step == 0;
+}
+
+}
+
+
+void SequenceBuilder::add( const Time time )
+{
+	if( _ranges.empty() || time > _ranges.back().last )
+	{
+		appendFrame( _ranges, time );
+		return;
+	}
+	if( time == _ranges.back().last )
+		return;
+
+	_pending.insert( time );
+	if( _pending.size() >= maxPendingFrames )
+		merge();
+}
+
+void SequenceBuilder::add( const std::vector<Time>& times )
+{
+	BOOST_FOREACH( const Time time, times )
+	{
+		add( time );
+	}
+}
+
+void SequenceBuilder::remove( const Time time )
+{
+	if( ! _pending.empty() )
+		merge();
+	if( ! isInRanges( _ranges, time ) )
+		return;
+
+	std::vector<Time> times;
+	extractFramesFrom( time, times );
+	BOOST_FOREACH( const Time t, times )
+	{
+		if( t != time )
+			appendFrame( _ranges, t );
+	}
+}
+
+bool SequenceBuilder::contains( const Time time ) const
+{
+	return _pending.count( time ) != 0 || isInRanges( _ranges, time );
+}
+
+std::size_t SequenceBuilder::getNbFrames() const
+{
+	std::size_t nbFrames = 0;
+	BOOST_FOREACH( const FrameRange& range, _ranges )
+	{
+		nbFrames += range.getNbFrames();
+	}
+	// the pending frames could already be in the ranges
+	BOOST_FOREACH( const Time time, _pending )
+	{
+		if( ! isInRanges( _ranges, time ) )
+			++nbFrames;
+	}
+	return nbFrames;
+}
+
+void SequenceBuilder::clear()
+{
+	_ranges.clear();
+	_pending.clear();
+}
+
+std::vector<FrameRange> SequenceBuilder::finalize()
+{
+	if( ! _pending.empty() )
+		merge();
+
+	std::vector<FrameRange> ranges( _ranges );
+	// like extractFrameRanges, a last range of 2 frames is not really a range
+	// (except if there are only 2 frames)
+	if( ranges.size() > 1 && ranges.back().getNbFrames() == 2 )
+	{
+		FrameRange& lastRange = ranges.back();
+		const Time last = lastRange.last;
+		lastRange.last = lastRange.first;
+		lastRange.step = 1;
+		ranges.push_back( FrameRange( last ) );
+	}
+	return ranges;
+}
+
+void SequenceBuilder::merge()
+{
+	std::vector<Time> times;
+	extractFramesFrom( *_pending.begin(), times );
+
+	std::vector<Time> allTimes;
+	allTimes.reserve( times.size() + _pending.size() );
+	std::merge( times.begin(), times.end(), _pending.begin(), _pending.end(), std::back_inserter( allTimes ) );
+	allTimes.erase( std::unique( allTimes.begin(), allTimes.end() ), allTimes.end() );
+	_pending.clear();
+
+	BOOST_FOREACH( const Time t, allTimes )
+	{
+		appendFrame( _ranges, t );
+	}
+}
+
+void SequenceBuilder::extractFramesFrom( const Time time, std::vector<Time>& outTimes )
+{
+	// The ranges before the one which contains the frame are not modified
+	// by the next frames: restart the detection from this range.
+	std::vector<FrameRange>::iterator restart = std::upper_bound( _ranges.begin(), _ranges.end(), time, &isBeforeRange );
+	if( restart != _ranges.begin() )
+		--restart;
+
+	if( restart != _ranges.end() && restart->first != restart->last && restart->first + restart->step < time )
+	{
+		// At least 2 frames of this range are before the frame:
+		// the range with only these frames is the state of the detection at this frame.
+		const Time lastBefore = std::min( restart->last, restart->first + ( ( time - 1 - restart->first ) / restart->step ) * restart->step );
+		for( Time t = lastBefore + restart->step; t <= restart->last; t += restart->step )
+			outTimes.push_back( t );
+		restart->last = lastBefore;
+		++restart;
+	}
+	else
+	{
+		// A single frame before the range could remain from a range of 2 frames
+		// whose last frame has been taken by this range: build them again too.
+		while( restart != _ranges.begin() && boost::prior( restart )->first == boost::prior( restart )->last )
+			--restart;
+	}
+	for( std::vector<FrameRange>::const_iterator it = restart; it != _ranges.end(); ++it )
+	{
+		for( Time t = it->first; t <= it->last; t += it->step )
+			outTimes.push_back( t );
+	}
+	_ranges.erase( restart, _ranges.end() );
+}
+
+
+}
@@ -0,0 +1,76 @@
+#ifndef _SEQUENCE_PARSER_SEQUENCE_BUILDER_HPP_
+#define _SEQUENCE_PARSER_SEQUENCE_BUILDER_HPP_
+
+#include "common.hpp"
+#include "FrameRange.hpp"
+
+#include <set>
+#include <vector>
+
+
+namespace sequenceParser {
+
+/**
+ * @brief Build the frame ranges of a sequence frame by frame.
+ *
+ * The frames could be added in any order (the duplicates are ignored).
+ * A frame after the last one extends the ranges immediately, the other
+ * frames are kept aside and merged when the ranges are needed (or when
+ * there are too many of them): only the ranges after the first of these
+ * frames are built again. A frame is removed the same way, by building
+ * again the ranges after it.
+ *
+ * The ranges are the same as extractFrameRanges on the sorted frames.
+ */
+class SequenceBuilder
+{
+public:
+	typedef SequenceBuilder This;
+
+public:
+	SequenceBuilder() {}
+
+public:
+	void add( const Time time );
+
+	void add( const std::vector<Time>& times );
+
+	/// @brief Remove a frame (nothing if the frame has not been added).
+	void remove( const Time time );
+
+	/// @return if the frame has been added
+	bool contains( const Time time ) const;
+
+	bool empty() const { return _ranges.empty() && _pending.empty(); }
+
+	/// @return number of frames added
+	std::size_t getNbFrames() const;
+
+	/// @brief Remove all the frames.
+	void clear();
+
+	/**
+	 * @brief Merge the frames added out of order.
+	 * @return the ranges of all the frames added (more frames could be added after)
+	 */
+	std::vector<FrameRange> finalize();
+
+private:
+	void merge();
+
+	/**
+	 * @brief Remove the frames from @p time from the ranges,
+	 *        the ranges are the state of the detection before this frame.
+	 * @param[out] outTimes: the removed frames, sorted
+	 */
+	void extractFramesFrom( const Time time, std::vector<Time>& outTimes );
+
+private:
+	std::vector<FrameRange> _ranges;
+	std::set<Time> _pending; ///< frames added before the last one, not in the ranges yet
+};
+
+
+}
+
+#endif
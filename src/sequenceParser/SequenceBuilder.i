@@ -0,0 +1,7 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/SequenceBuilder.hpp"
+%}
+
+%include "SequenceBuilder.hpp"
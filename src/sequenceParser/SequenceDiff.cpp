@@ -0,0 +1,295 @@
+#include "SequenceDiff.hpp"
+#include "SequenceIndex.hpp"
+
+#include "detail/SequenceIndexFormat.hpp"
+
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+
+
+namespace sequenceParser {
+
+namespace {
+
+/**
+ * @brief Identity of an entry of a BrowseResult.
+ */
+struct EntryKey
+{
+	std::string filename;
+	EType type;
+	std::size_t index;
+
+	bool operator<( const EntryKey& other ) const
+	{
+		const int c = filename.compare( other.filename );
+		if( c != 0 )
+			return c < 0;
+		return type < other.type;
+	}
+
+	bool operator==( const EntryKey& other ) const
+	{
+		return type == other.type && filename == other.filename;
+	}
+};
+
+/// @return the entries, sorted by identity
+std::vector<EntryKey> getSortedKeys( const BrowseResult& content )
+{
+	std::vector<EntryKey> keys( content.size() );
+	for( std::size_t i = 0; i < content.size(); ++i )
+	{
+		keys[i].filename = content.getFilename( i );
+		keys[i].type = content.getType( i );
+		keys[i].index = i;
+	}
+	std::sort( keys.begin(), keys.end() );
+	return keys;
+}
+
+/// @return the first frame of the range after @p time (the range needs to contain it)
+Time getNextFrame( const FrameRange& range, const Time time )
+{
+	if( time < range.first )
+		return range.first;
+	return range.first + ( ( time - range.first ) / range.step + 1 ) * range.step;
+}
+
+/// @return the last frame of the range before @p time (the range needs to contain it)
+Time getPreviousFrame( const FrameRange& range, const Time time )
+{
+	return range.first + ( ( time - 1 - range.first ) / range.step ) * range.step;
+}
+
+/// @return if all the frames of @p range between the bounds of @p other are in @p other
+bool isCoveredBy( const FrameRange& range, const FrameRange& other )
+{
+	return other.step == 1 ||
+	       ( range.step % other.step == 0 && ( range.first - other.first ) % other.step == 0 );
+}
+
+/// @brief Add a range, merged with the previous one if it continues it.
+void pushRange( std::vector<FrameRange>& ranges, const Time first, const Time last, const Time step )
+{
+	if( first > last )
+		return;
+	const FrameRange range = ( first == last ) ? FrameRange( first ) : FrameRange( first, last, step );
+	if( ! ranges.empty() )
+	{
+		FrameRange& previous = ranges.back();
+		const Time previousStep = ( previous.first == previous.last ) ? range.first - previous.last : previous.step;
+		if( ( range.first == range.last || range.step == previousStep ) &&
+		    range.first - previous.last == previousStep )
+		{
+			previous.last = range.last;
+			previous.step = previousStep;
+			return;
+		}
+	}
+	ranges.push_back( range );
+}
+
+/// @brief Compare the stats of the entries, if there are stats.
+struct EntryStats
+{
+	EntryStats( const SequenceIndex* index, const std::size_t directoryIndex )
+	: index( index )
+	, directoryIndex( directoryIndex )
+	{}
+
+	bool equals( const std::size_t entryIndex, const EntryStats& other, const std::size_t otherEntryIndex ) const
+	{
+		if( index == NULL || other.index == NULL )
+			return true;
+		return index->getEntrySize( directoryIndex, entryIndex ) == other.index->getEntrySize( other.directoryIndex, otherEntryIndex ) &&
+		       index->getEntryModificationTime( directoryIndex, entryIndex ) == other.index->getEntryModificationTime( other.directoryIndex, otherEntryIndex );
+	}
+
+	const SequenceIndex* index;
+	std::size_t directoryIndex;
+};
+
+/**
+ * @brief Merge the sorted entries of the two contents.
+ */
+void diffContents(
+		DirectoryDiff& diff,
+		const BrowseResult& before, const EntryStats& beforeStats,
+		const BrowseResult& after, const EntryStats& afterStats )
+{
+	diff.directory = after.getDirectory();
+	const std::vector<EntryKey> beforeKeys = getSortedKeys( before );
+	const std::vector<EntryKey> afterKeys = getSortedKeys( after );
+
+	std::vector<EntryKey>::const_iterator itBefore = beforeKeys.begin();
+	std::vector<EntryKey>::const_iterator itAfter = afterKeys.begin();
+	while( itBefore != beforeKeys.end() || itAfter != afterKeys.end() )
+	{
+		if( itAfter == afterKeys.end() || ( itBefore != beforeKeys.end() && *itBefore < *itAfter ) )
+		{
+			diff.removedItems.push_back( before.getItem( itBefore->index ) );
+			++itBefore;
+			continue;
+		}
+		if( itBefore == beforeKeys.end() || *itAfter < *itBefore )
+		{
+			diff.addedItems.push_back( after.getItem( itAfter->index ) );
+			++itAfter;
+			continue;
+		}
+
+		// same entry
+		const bool sameStats = beforeStats.equals( itBefore->index, afterStats, itAfter->index );
+		if( itAfter->type == eTypeSequence )
+		{
+			const Sequence beforeSequence = before.getSequence( itBefore->index );
+			const Item afterItem( after.getSequence( itAfter->index ), after.getDirectoryPath() );
+			const std::vector<FrameRange>& afterRanges = afterItem.getSequence().getFrameRanges();
+			if( beforeSequence.getFrameRanges() != afterRanges )
+			{
+				// built in place
+				diff.modifiedSequences.push_back( FramesDiff() );
+				FramesDiff& framesDiff = diff.modifiedSequences.back();
+				framesDiff.item = afterItem;
+				framesDiff.addedFrames = subtractFrameRanges( afterRanges, beforeSequence.getFrameRanges() );
+				framesDiff.removedFrames = subtractFrameRanges( beforeSequence.getFrameRanges(), afterRanges );
+			}
+			if( ! sameStats )
+				diff.modifiedItems.push_back( afterItem );
+		}
+		else if( ! sameStats )
+		{
+			diff.modifiedItems.push_back( after.getItem( itAfter->index ) );
+		}
+		++itBefore;
+		++itAfter;
+	}
+}
+
+bool haveSameStamp( const detail::index::DirectoryRecord& a, const detail::index::DirectoryRecord& b )
+{
+	return a.deviceId == b.deviceId &&
+	       a.inodeId == b.inodeId &&
+	       a.modificationTime == b.modificationTime &&
+	       a.lastChangeTime == b.lastChangeTime &&
+	       a.lastChangeTime != 0; // unknown stamp
+}
+
+}
+
+
+std::vector<FrameRange> subtractFrameRanges( const std::vector<FrameRange>& ranges, const std::vector<FrameRange>& removedRanges )
+{
+	std::vector<FrameRange> result;
+	std::vector<FrameRange>::const_iterator itRemoved = removedRanges.begin();
+	BOOST_FOREACH( const FrameRange& range, ranges )
+	{
+		// the removed ranges before this range can't overlap the next ones
+		while( itRemoved != removedRanges.end() && itRemoved->last < range.first )
+			++itRemoved;
+
+		Time current = range.first; // first frame not processed yet
+		for( std::vector<FrameRange>::const_iterator it = itRemoved;
+		     it != removedRanges.end() && it->first <= range.last && current <= range.last;
+		     ++it )
+		{
+			const FrameRange& removed = *it;
+			if( removed.last < current )
+				continue;
+			// the frames before the removed range are kept
+			if( current < removed.first )
+			{
+				pushRange( result, current, getPreviousFrame( range, removed.first ), range.step );
+				current = getNextFrame( range, removed.first - 1 );
+			}
+			const Time overlapLast = std::min( range.last, removed.last );
+			if( ! isCoveredBy( range, removed ) )
+			{
+				// incompatible steps, check each frame where the ranges overlap
+				for( Time t = current; t <= overlapLast; t += range.step )
+				{
+					if( ( t - removed.first ) % removed.step != 0 )
+						pushRange( result, t, t, 1 );
+				}
+			}
+			current = getNextFrame( range, overlapLast );
+		}
+		pushRange( result, current, range.last, range.step );
+	}
+	return result;
+}
+
+DirectoryDiff diffBrowseResults( const BrowseResult& before, const BrowseResult& after )
+{
+	DirectoryDiff diff;
+	diffContents( diff, before, EntryStats( NULL, 0 ), after, EntryStats( NULL, 0 ) );
+	return diff;
+}
+
+std::vector<DirectoryDiff> diffSequenceIndexes(
+		const SequenceIndex& before,
+		const SequenceIndex& after,
+		const bool compareStats )
+{
+	std::vector<DirectoryDiff> diffs;
+	if( ! before.isOpen() || ! after.isOpen() )
+		return diffs;
+
+	const bool withStats = compareStats && before.hasStats() && after.hasStats();
+	// with the same options, a directory with the same stamp has the same content
+	const bool useStamps = ! withStats && before.getDetectionOptions() == after.getDetectionOptions();
+
+	BrowseResult beforeContent;
+	BrowseResult afterContent;
+	const BrowseResult emptyContent;
+	std::size_t b = 0;
+	std::size_t a = 0;
+	while( b < before.getNbDirectories() || a < after.getNbDirectories() )
+	{
+		DirectoryDiff diff;
+		int c = 0;
+		if( b == before.getNbDirectories() )
+			c = 1;
+		else if( a == after.getNbDirectories() )
+			c = -1;
+		else
+			c = before.getDirectory( b ).compare( after.getDirectory( a ) );
+
+		if( c < 0 )
+		{
+			// removed directory
+			before.getContent( beforeContent, b );
+			diffContents( diff, beforeContent, EntryStats( NULL, 0 ), emptyContent, EntryStats( NULL, 0 ) );
+			diff.directory = beforeContent.getDirectory();
+			++b;
+		}
+		else if( c > 0 )
+		{
+			// new directory
+			after.getContent( afterContent, a );
+			diffContents( diff, emptyContent, EntryStats( NULL, 0 ), afterContent, EntryStats( NULL, 0 ) );
+			++a;
+		}
+		else
+		{
+			if( ! useStamps || ! haveSameStamp( before.getDirectoryRecord( b ), after.getDirectoryRecord( a ) ) )
+			{
+				before.getContent( beforeContent, b );
+				after.getContent( afterContent, a );
+				diffContents( diff,
+					beforeContent, EntryStats( withStats ? &before : NULL, b ),
+					afterContent, EntryStats( withStats ? &after : NULL, a ) );
+			}
+			++b;
+			++a;
+		}
+		if( ! diff.empty() )
+			diffs.push_back( diff );
+	}
+	return diffs;
+}
+
+
+}
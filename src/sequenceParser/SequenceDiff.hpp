@@ -0,0 +1,80 @@
+#ifndef _SEQUENCE_PARSER_SEQUENCE_DIFF_HPP_
+#define _SEQUENCE_PARSER_SEQUENCE_DIFF_HPP_
+
+#include "common.hpp"
+#include "BrowseResult.hpp"
+#include "FrameRange.hpp"
+#include "Item.hpp"
+
+#include <vector>
+
+
+namespace sequenceParser {
+
+class SequenceIndex;
+
+/**
+ * @brief Frames added and removed in a sequence present before and after.
+ */
+struct FramesDiff
+{
+	Item item; ///< the sequence after the modification
+	std::vector<FrameRange> addedFrames;
+	std::vector<FrameRange> removedFrames;
+};
+
+/**
+ * @brief Differences of the content of a directory between two browses.
+ *
+ * The entries are identified by their filename (the standard pattern for
+ * the sequences) and their type. A sequence with a new padding is a new
+ * sequence.
+ */
+struct DirectoryDiff
+{
+	bool empty() const
+	{
+		return addedItems.empty() && removedItems.empty() && modifiedSequences.empty() && modifiedItems.empty();
+	}
+
+	std::string directory;
+	std::vector<Item> addedItems;
+	std::vector<Item> removedItems;
+	std::vector<FramesDiff> modifiedSequences; ///< same sequence with other frames
+	/// same entry with another size or modification time (only when comparing the stats)
+	std::vector<Item> modifiedItems;
+};
+
+/**
+ * @brief Compare two contents of the same directory.
+ * @note The comparison of the sequences is done on the frame ranges,
+ *       the frames are not enumerated (except to compare ranges with
+ *       incompatible steps, only on the frames where they overlap).
+ */
+DirectoryDiff diffBrowseResults( const BrowseResult& before, const BrowseResult& after );
+
+/**
+ * @brief Compare two indexes of the same directory tree.
+ * @param[in] compareStats: also report the entries with another size or
+ *                          modification time (if both indexes have the stats).
+ *                          For a sequence, the total size and the last
+ *                          modification time of its files are compared.
+ * @return the modified directories, sorted by path.
+ *         A new directory has all its entries added,
+ *         a removed directory has all its entries removed.
+ */
+std::vector<DirectoryDiff> diffSequenceIndexes(
+	const SequenceIndex& before,
+	const SequenceIndex& after,
+	const bool compareStats = false );
+
+/**
+ * @return the frames of @p ranges which are not in @p removedRanges.
+ * @param[in] ranges, removedRanges: sorted ranges which don't overlap (like in a Sequence)
+ */
+std::vector<FrameRange> subtractFrameRanges( const std::vector<FrameRange>& ranges, const std::vector<FrameRange>& removedRanges );
+
+
+}
+
+#endif
@@ -0,0 +1,12 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/SequenceDiff.hpp"
+%}
+
+%include "SequenceDiff.hpp"
+
+namespace std {
+%template(FramesDiffVector) vector< sequenceParser::FramesDiff >;
+%template(DirectoryDiffVector) vector< sequenceParser::DirectoryDiff >;
+}
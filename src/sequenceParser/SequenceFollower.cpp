@@ -0,0 +1,344 @@
+#include "SequenceFollower.hpp"
+#include "DirectorySource.hpp"
+#include "SequenceBuilder.hpp"
+#include "system.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <algorithm>
+#include <map>
+
+#ifdef __LINUX__
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
+#ifdef __UNIX__
+#include <unistd.h>
+#endif
+#ifdef __WINDOWS__
+#include <windows.h>
+#endif
+
+
+namespace sequenceParser {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/// Last observation of a frame which is maybe not complete.
+struct FileState
+{
+	FileState()
+	: size( 0 )
+	, modificationTime( 0 )
+	{}
+
+	bool operator==( const FileState& other ) const
+	{
+		return size == other.size && modificationTime == other.modificationTime;
+	}
+
+	boost::uintmax_t size;
+	std::time_t modificationTime;
+};
+
+/// @return false if the file doesn't exist anymore
+bool getFileState( const bfs::path& filepath, FileState& state )
+{
+	boost::system::error_code errorCode;
+	state.size = bfs::file_size( filepath, errorCode );
+	if( errorCode )
+		return false;
+	state.modificationTime = bfs::last_write_time( filepath, errorCode );
+	return ! errorCode;
+}
+
+void sleepMilliseconds( const int duration )
+{
+#ifdef __WINDOWS__
+	Sleep( duration );
+#else
+	usleep( duration * 1000 );
+#endif
+}
+
+boost::posix_time::ptime now()
+{
+	return boost::posix_time::microsec_clock::universal_time();
+}
+
+}
+
+
+struct SequenceFollower::Data
+{
+	explicit Data( DirectorySource& source )
+	: source( &source )
+	, valid( false )
+	, fileDescriptor( -1 )
+	, minInterval( 50 )
+	, maxInterval( 1000 )
+	, interval( 50 )
+	{}
+
+	/// @return if the file is a frame of the sequence, not already arrived
+	bool isNewFrame( const std::string& filename, Time& time )
+	{
+		std::string timeStr;
+		if( ! sequence.isIn( filename, time, timeStr ) )
+			return false;
+		return ! frames.contains( time );
+	}
+
+	void setArrived( const Time time, std::vector<Time>& newFrames )
+	{
+		pending.erase( time );
+		if( frames.contains( time ) )
+			return;
+		frames.add( time );
+		newFrames.push_back( time );
+	}
+
+	/// @brief List the directory to find the frames which are not arrived yet.
+	void listDirectory( const bool report, std::vector<Time>& newFrames )
+	{
+		std::vector<DirectoryEntry> entries;
+		source->listDirectory( directory, entries );
+		BOOST_FOREACH( const DirectoryEntry& entry, entries )
+		{
+			Time time;
+			if( ! isNewFrame( entry.filename, time ) )
+				continue;
+			if( ! report )
+			{
+				frames.add( time );
+				continue;
+			}
+			// the state is compared at the next check
+			if( pending.find( time ) == pending.end() )
+			{
+				FileState state;
+				if( getFileState( directory / entry.filename, state ) )
+					pending[time] = state;
+			}
+		}
+	}
+
+	/// @brief The frames with the same size and modification time since the last check are arrived.
+	void checkPending( std::vector<Time>& newFrames )
+	{
+		std::vector<Time> arrived;
+		for( std::map<Time, FileState>::iterator it = pending.begin(); it != pending.end(); )
+		{
+			FileState state;
+			if( ! getFileState( directory / sequence.getFilenameAt( it->first ), state ) )
+			{
+				pending.erase( it++ ); // removed
+				continue;
+			}
+			if( state == it->second )
+				arrived.push_back( it->first );
+			else
+				it->second = state;
+			++it;
+		}
+		BOOST_FOREACH( const Time time, arrived )
+		{
+			setArrived( time, newFrames );
+		}
+	}
+
+#ifdef __LINUX__
+	/**
+	 * @brief Wait and read the inotify events.
+	 * @return false if some events are lost
+	 */
+	bool readEvents( const int timeout, std::vector<Time>& newFrames )
+	{
+		pollfd pollInfos;
+		pollInfos.fd = fileDescriptor;
+		pollInfos.events = POLLIN;
+		pollInfos.revents = 0;
+		if( poll( &pollInfos, 1, timeout ) <= 0 )
+			return true;
+
+		// aligned buffer for the inotify events
+		union
+		{
+			inotify_event event;
+			char data[16 * 1024];
+		} buffer;
+
+		bool complete = true;
+		for( ;; )
+		{
+			const ssize_t size = read( fileDescriptor, buffer.data, sizeof( buffer.data ) );
+			if( size <= 0 )
+				break; // EAGAIN: no more event
+
+			for( const char* ptr = buffer.data; ptr < buffer.data + size; )
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>( ptr );
+				ptr += sizeof( inotify_event ) + event->len;
+
+				if( event->mask & IN_Q_OVERFLOW )
+				{
+					complete = false;
+					continue;
+				}
+				Time time;
+				if( event->len == 0 || ! isNewFrame( event->name, time ) )
+					continue;
+				// the writer has closed the file, or the file has been renamed
+				// (written in a temporary file, then moved)
+				setArrived( time, newFrames );
+			}
+		}
+		return complete;
+	}
+#endif
+
+	DirectorySource* source; ///< where the directory is listed
+	bool valid;
+	Sequence sequence; ///< the pattern only, without frames
+	bfs::path directory;
+	SequenceBuilder frames; ///< arrived
+	std::map<Time, FileState> pending; ///< found, but maybe not complete
+
+	int fileDescriptor;
+	int minInterval;
+	int maxInterval;
+	int interval;
+};
+
+
+SequenceFollower::SequenceFollower( const std::string& pattern, const EPattern accept, const bool reportExisting )
+: _data( new Data( getFilesystemDirectorySource() ) )
+{
+	init( pattern, accept, reportExisting );
+}
+
+SequenceFollower::SequenceFollower( DirectorySource& source, const std::string& pattern, const EPattern accept, const bool reportExisting )
+: _data( new Data( source ) )
+{
+	init( pattern, accept, reportExisting );
+}
+
+void SequenceFollower::init( const std::string& pattern, const EPattern accept, const bool reportExisting )
+{
+	const bfs::path patternPath( pattern );
+	_data->valid = _data->sequence.initFromPattern( patternPath.filename().string(), accept );
+	if( ! _data->valid )
+		return;
+
+	_data->directory = patternPath.parent_path();
+	if( _data->directory.empty() ) // relative path
+		_data->directory = bfs::current_path();
+
+#ifdef __LINUX__
+	// watch before the listing, so no frame is lost
+	_data->fileDescriptor = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if( _data->fileDescriptor != -1 &&
+	    inotify_add_watch( _data->fileDescriptor, _data->directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR ) == -1 )
+	{
+		// the directory doesn't exist yet, or can't be watched
+		::close( _data->fileDescriptor );
+		_data->fileDescriptor = -1;
+	}
+#endif
+	std::vector<Time> newFrames;
+	_data->listDirectory( reportExisting, newFrames );
+}
+
+SequenceFollower::~SequenceFollower()
+{
+#ifdef __LINUX__
+	if( _data->fileDescriptor != -1 )
+		::close( _data->fileDescriptor );
+#endif
+}
+
+bool SequenceFollower::isValid() const
+{
+	return _data->valid;
+}
+
+bool SequenceFollower::usesEvents() const
+{
+	return _data->fileDescriptor != -1;
+}
+
+void SequenceFollower::setPollingInterval( const int minInterval, const int maxInterval )
+{
+	_data->minInterval = std::max( 1, minInterval );
+	_data->maxInterval = std::max( _data->minInterval, maxInterval );
+	_data->interval = _data->minInterval;
+}
+
+std::vector<Time> SequenceFollower::waitFrames( const int timeout )
+{
+	std::vector<Time> newFrames;
+	if( ! _data->valid )
+		return newFrames;
+
+	const boost::posix_time::ptime end = now() + boost::posix_time::milliseconds( std::max( 0, timeout ) );
+	for( ;; )
+	{
+		int remaining = -1; // infinite
+		if( timeout >= 0 )
+			remaining = std::max( 0, int( ( end - now() ).total_milliseconds() ) );
+		// the time to wait before the next check
+		int wait = _data->interval;
+		if( remaining != -1 )
+			wait = std::min( wait, remaining );
+
+		if( usesEvents() )
+		{
+#ifdef __LINUX__
+			// wait for an event, or the next check of the pending frames
+			const bool complete = _data->readEvents( _data->pending.empty() ? remaining : wait, newFrames );
+			_data->checkPending( newFrames );
+			if( ! complete )
+			{
+				// some events are lost
+				_data->listDirectory( true, newFrames );
+			}
+#endif
+		}
+		else
+		{
+			// the frames found by this listing are compared at the next check
+			_data->checkPending( newFrames );
+			_data->listDirectory( true, newFrames );
+		}
+
+		if( ! newFrames.empty() )
+		{
+			// frames are arriving, check again soon
+			_data->interval = _data->minInterval;
+			std::sort( newFrames.begin(), newFrames.end() );
+			return newFrames;
+		}
+		if( remaining == 0 )
+			return newFrames;
+
+		if( ! usesEvents() )
+		{
+			sleepMilliseconds( wait );
+			_data->interval = std::min( _data->interval * 2, _data->maxInterval );
+		}
+	}
+}
+
+Sequence SequenceFollower::getSequence() const
+{
+	Sequence sequence( _data->sequence );
+	sequence.getFrameRanges() = _data->frames.finalize();
+	return sequence;
+}
+
+
+}
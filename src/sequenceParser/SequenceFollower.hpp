@@ -0,0 +1,93 @@
+#ifndef _SEQUENCE_PARSER_SEQUENCE_FOLLOWER_HPP_
+#define _SEQUENCE_PARSER_SEQUENCE_FOLLOWER_HPP_
+
+#include "common.hpp"
+#include "Sequence.hpp"
+
+#include <boost/scoped_ptr.hpp>
+
+#include <vector>
+
+
+namespace sequenceParser {
+
+class DirectorySource;
+
+/**
+ * @brief Follow the frames of a sequence which arrive in a directory
+ *        (like the output of a render).
+ *
+ * A frame is reported once, when its file is complete:
+ * - with inotify (Linux), when the file is closed after writing or renamed
+ *   into the directory,
+ * - otherwise, the directory is listed at an adaptive interval, and a frame
+ *   is reported when its size and modification time are the same on two
+ *   consecutive listings (so files still growing are not reported).
+ *
+ * @warning Not thread safe, use the follower from one thread.
+ */
+class SequenceFollower
+{
+public:
+	typedef SequenceFollower This;
+
+public:
+	/**
+	 * @param[in] pattern: Absolute path of your sequence, like: "/tmp/foo####.jpg"
+	 * @param[in] accept: patterns to accept in the detection
+	 * @param[in] reportExisting: report the frames already in the directory
+	 *                            (otherwise they are considered as already arrived)
+	 */
+	SequenceFollower( const std::string& pattern, const EPattern accept = ePatternDefault, const bool reportExisting = false );
+
+	/**
+	 * @brief Same, but the directory is listed with another source than the filesystem
+	 *        (the events, sizes and modification times still come from the filesystem).
+	 * @param[in] source: it needs to outlive the follower
+	 */
+	SequenceFollower( DirectorySource& source, const std::string& pattern, const EPattern accept = ePatternDefault, const bool reportExisting = false );
+	~SequenceFollower();
+
+private:
+	SequenceFollower( const SequenceFollower& );
+	SequenceFollower& operator=( const SequenceFollower& );
+
+public:
+	/// @return false if the pattern is not recognized
+	bool isValid() const;
+
+	/// @return if the follower receives the filesystem events (otherwise it lists the directory)
+	bool usesEvents() const;
+
+	/**
+	 * @brief Set the interval between two listings of the directory (without events).
+	 * The interval starts at @p minInterval, and doubles each time no frame
+	 * is changing, up to @p maxInterval.
+	 * @param[in] minInterval: in milliseconds
+	 * @param[in] maxInterval: in milliseconds
+	 */
+	void setPollingInterval( const int minInterval, const int maxInterval );
+
+	/**
+	 * @brief Wait for new complete frames.
+	 * @param[in] timeout: maximal time to wait, in milliseconds
+	 *                     (0 to check immediately, -1 to wait indefinitely)
+	 * @return the new frames (sorted), empty if the timeout is reached
+	 */
+	std::vector<Time> waitFrames( const int timeout = -1 );
+
+	/// @return the sequence with all the frames arrived so far
+	Sequence getSequence() const;
+
+private:
+	void init( const std::string& pattern, const EPattern accept, const bool reportExisting );
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+
+}
+
+#endif
@@ -0,0 +1,10 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/SequenceFollower.hpp"
+%}
+
+%ignore sequenceParser::SequenceFollower::SequenceFollower( const SequenceFollower& );
+%ignore sequenceParser::SequenceFollower::operator=;
+
+%include "SequenceFollower.hpp"
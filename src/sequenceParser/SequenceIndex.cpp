@@ -0,0 +1,661 @@
+#include "SequenceIndex.hpp"
+#include "filesystem.hpp"
+#include "ItemStat.hpp"
+
+#include "detail/DirectoryStamp.hpp"
+#include "detail/MappedFile.hpp"
+#include "detail/SequenceIndexFormat.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <list>
+#include <cstring>
+#include <ctime>
+
+
+namespace sequenceParser {
+
+namespace bfs = boost::filesystem;
+using namespace detail::index;
+
+namespace {
+
+/// directories modified during the last seconds are listed again by the next update
+const boost::int64_t recentModificationDelay = 2;
+
+detail::DirectoryStamp getStamp( const DirectoryRecord& record )
+{
+	detail::DirectoryStamp stamp;
+	stamp.deviceId = record.deviceId;
+	stamp.inodeId = record.inodeId;
+	stamp.modificationTime = record.modificationTime;
+	stamp.lastChangeTime = record.lastChangeTime;
+	return stamp;
+}
+
+bool isValidSection( const Section& section, const std::size_t recordSize, const std::size_t fileSize )
+{
+	return ( section.offset % 8 == 0 ) &&
+	       ( section.offset <= fileSize ) &&
+	       ( section.count <= ( fileSize - section.offset ) / recordSize );
+}
+
+template<class Record>
+const Record* getRecords( const char* data, const Section& section )
+{
+	return reinterpret_cast<const Record*>( data + section.offset );
+}
+
+}
+
+
+SequenceIndex::SequenceIndex()
+: _file( new detail::MappedFile() )
+, _header( NULL )
+{}
+
+SequenceIndex::SequenceIndex( const std::string& filename )
+: _file( new detail::MappedFile() )
+, _header( NULL )
+{
+	open( filename );
+}
+
+SequenceIndex::~SequenceIndex()
+{}
+
+bool SequenceIndex::open( const std::string& filename )
+{
+	close();
+	if( ! _file->open( filename ) )
+		return false;
+	_header = reinterpret_cast<const Header*>( _file->data() );
+	if( ! isValid() )
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool SequenceIndex::isValid() const
+{
+	const std::size_t fileSize = _file->size();
+	if( fileSize < sizeof( Header ) )
+		return false;
+	if( std::memcmp( _header->magic, magic, sizeof( magic ) ) != 0 ||
+	    _header->version != version ||
+	    _header->endianTag != endianTag ||
+	    _header->fileSize != fileSize )
+		return false;
+	const bool stats = _header->flags & eFlagStats;
+	return isValidSection( _header->directories, sizeof( DirectoryRecord ), fileSize ) &&
+	       isValidSection( _header->entries, sizeof( EntryRecord ), fileSize ) &&
+	       isValidSection( _header->ranges, sizeof( RangeRecord ), fileSize ) &&
+	       isValidSection( _header->stats, sizeof( StatRecord ), fileSize ) &&
+	       isValidSection( _header->names, 1, fileSize ) &&
+	       _header->stats.count == ( stats ? _header->entries.count : 0 );
+}
+
+void SequenceIndex::close()
+{
+	_file->close();
+	_header = NULL;
+}
+
+bool SequenceIndex::isOpen() const
+{
+	return _header != NULL;
+}
+
+boost::string_ref SequenceIndex::getNameRef( const boost::uint64_t offset, const boost::uint64_t size ) const
+{
+	const boost::uint64_t namesSize = _header->names.count;
+	if( size > namesSize || offset > namesSize - size )
+		return boost::string_ref(); // invalid file
+	return boost::string_ref( _file->data() + _header->names.offset + offset, size );
+}
+
+std::string SequenceIndex::getName( const boost::uint64_t offset, const boost::uint64_t size ) const
+{
+	const boost::string_ref name = getNameRef( offset, size );
+	return std::string( name.begin(), name.end() );
+}
+
+std::string SequenceIndex::getRootDirectory() const
+{
+	return getName( _header->rootNameOffset, _header->rootNameSize );
+}
+
+EDetection SequenceIndex::getDetectionOptions() const
+{
+	return EDetection( _header->detectOptions );
+}
+
+bool SequenceIndex::hasStats() const
+{
+	return _header->flags & eFlagStats;
+}
+
+std::size_t SequenceIndex::getNbDirectories() const
+{
+	return _header->directories.count;
+}
+
+const DirectoryRecord& SequenceIndex::getDirectoryRecord( const std::size_t directoryIndex ) const
+{
+	BOOST_ASSERT( directoryIndex < _header->directories.count );
+	return getRecords<DirectoryRecord>( _file->data(), _header->directories )[directoryIndex];
+}
+
+const EntryRecord& SequenceIndex::getEntryRecord( const std::size_t directoryIndex, const std::size_t entryIndex ) const
+{
+	const DirectoryRecord& directory = getDirectoryRecord( directoryIndex );
+	BOOST_ASSERT( entryIndex < directory.nbEntries );
+	BOOST_ASSERT( directory.firstEntry + entryIndex < _header->entries.count );
+	return getRecords<EntryRecord>( _file->data(), _header->entries )[directory.firstEntry + entryIndex];
+}
+
+std::string SequenceIndex::getDirectory( const std::size_t directoryIndex ) const
+{
+	const DirectoryRecord& directory = getDirectoryRecord( directoryIndex );
+	return getName( directory.nameOffset, directory.nameSize );
+}
+
+std::ssize_t SequenceIndex::findDirectory( const std::string& directory ) const
+{
+	std::size_t first = 0;
+	std::size_t count = getNbDirectories();
+	// lower bound on the sorted paths
+	while( count > 0 )
+	{
+		const std::size_t step = count / 2;
+		const DirectoryRecord& record = getDirectoryRecord( first + step );
+		if( getNameRef( record.nameOffset, record.nameSize ).compare( directory ) < 0 )
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+	if( first < getNbDirectories() && getNameRef( getDirectoryRecord( first ).nameOffset, getDirectoryRecord( first ).nameSize ) == directory )
+		return first;
+	return -1;
+}
+
+std::size_t SequenceIndex::getNbEntries( const std::size_t directoryIndex ) const
+{
+	return getDirectoryRecord( directoryIndex ).nbEntries;
+}
+
+void SequenceIndex::getContent( BrowseResult& outResult, const std::size_t directoryIndex ) const
+{
+	outResult = BrowseResult( getDirectory( directoryIndex ) );
+	const RangeRecord* ranges = getRecords<RangeRecord>( _file->data(), _header->ranges );
+
+	for( std::size_t i = 0; i < getNbEntries( directoryIndex ); ++i )
+	{
+		const EntryRecord& entry = getEntryRecord( directoryIndex, i );
+		const std::string name = getName( entry.nameOffset, entry.nameSize );
+		if( entry.type != eTypeSequence )
+		{
+			outResult.addFile( EType( entry.type ), name );
+			continue;
+		}
+		Sequence sequence;
+		sequence._prefix = name.substr( 0, entry.prefixSize );
+		sequence._suffix = name.substr( std::min<std::size_t>( entry.prefixSize, name.size() ) );
+		sequence._fixedPadding = entry.fixedPadding;
+		sequence._maxPadding = entry.maxPadding;
+		if( entry.firstRange <= _header->ranges.count && entry.nbRanges <= _header->ranges.count - entry.firstRange )
+		{
+			for( std::size_t r = 0; r < entry.nbRanges; ++r )
+			{
+				const RangeRecord& range = ranges[entry.firstRange + r];
+				sequence._ranges.push_back( FrameRange( range.first, range.last, range.step ) );
+			}
+		}
+		outResult.addSequence( sequence );
+	}
+}
+
+std::vector<Item> SequenceIndex::getItems( const std::size_t directoryIndex ) const
+{
+	BrowseResult result;
+	getContent( result, directoryIndex );
+	return result.getItems();
+}
+
+long long SequenceIndex::getEntrySize( const std::size_t directoryIndex, const std::size_t entryIndex ) const
+{
+	if( ! hasStats() )
+		return -1;
+	const std::size_t i = getDirectoryRecord( directoryIndex ).firstEntry + entryIndex;
+	if( i >= _header->stats.count )
+		return -1;
+	return getRecords<StatRecord>( _file->data(), _header->stats )[i].size;
+}
+
+long long SequenceIndex::getEntryModificationTime( const std::size_t directoryIndex, const std::size_t entryIndex ) const
+{
+	if( ! hasStats() )
+		return -1;
+	const std::size_t i = getDirectoryRecord( directoryIndex ).firstEntry + entryIndex;
+	if( i >= _header->stats.count )
+		return -1;
+	return getRecords<StatRecord>( _file->data(), _header->stats )[i].modificationTime;
+}
+
+
+namespace {
+
+/// @return if the stat is complete, or how it has been stopped by the options
+EBrowseStatus getStat( const Item& item, const BrowseOptions& options, StatRecord& outStat )
+{
+	if( item.getType() == eTypeUndefined )
+	{
+		outStat.size = 0;
+		outStat.modificationTime = -1;
+		return eBrowseStatusComplete;
+	}
+	const ItemStat itemStat( item, options );
+	outStat.size = itemStat.size;
+	outStat.modificationTime = itemStat.modificationTime;
+	return itemStat.status;
+}
+
+boost::uint64_t align( const boost::uint64_t offset )
+{
+	return ( offset + 7 ) & ~boost::uint64_t( 7 );
+}
+
+/**
+ * @brief Removes the temporary files of the index when leaving the scope,
+ *        on success as on failure.
+ */
+class TemporaryFiles
+{
+public:
+	~TemporaryFiles()
+	{
+		boost::system::error_code errorCode;
+		BOOST_FOREACH( const std::string& filename, _filenames )
+		{
+			bfs::remove( filename, errorCode );
+		}
+	}
+
+	const std::string& add( const std::string& filename )
+	{
+		_filenames.push_back( filename );
+		return _filenames.back();
+	}
+
+private:
+	std::list<std::string> _filenames;
+};
+
+/**
+ * @brief Writes the index while the tree is browsed.
+ *
+ * The records of each directory are appended to a temporary file per
+ * section as soon as the directory is listed, only the directory records and
+ * the distinct entry names stay in memory. The sections are assembled in
+ * the index file by write(), after sorting the directory records.
+ */
+class IndexWriter
+{
+public:
+	IndexWriter( const std::string& indexFilename, const bool withStats )
+	: _indexFilename( indexFilename )
+	, _withStats( withStats )
+	, _nbEntries( 0 )
+	, _nbRanges( 0 )
+	, _nbStats( 0 )
+	, _namesSize( 0 )
+	{
+		open( _entries, indexFilename + ".entries.tmp" );
+		open( _ranges, indexFilename + ".ranges.tmp" );
+		open( _stats, indexFilename + ".stats.tmp" );
+		open( _names, indexFilename + ".names.tmp" );
+	}
+
+	bool isValid() const
+	{
+		return _entries && _ranges && _stats && _names;
+	}
+
+	void addDirectory(
+			const std::string& path,
+			const detail::DirectoryStamp& stamp,
+			const BrowseResult& content,
+			const std::vector<StatRecord>& stats )
+	{
+		_directories.push_back( IndexedDirectory() );
+		IndexedDirectory& directory = _directories.back();
+		directory.path = path;
+		DirectoryRecord& record = directory.record;
+		record.nameOffset = appendName( path );
+		record.nameSize = path.size();
+		record.firstEntry = _nbEntries;
+		record.nbEntries = content.size();
+		record.deviceId = stamp.deviceId;
+		record.inodeId = stamp.inodeId;
+		record.modificationTime = stamp.modificationTime;
+		record.lastChangeTime = stamp.lastChangeTime;
+
+		for( std::size_t i = 0; i < content.size(); ++i )
+		{
+			EntryRecord entry;
+			std::memset( &entry, 0, sizeof( EntryRecord ) );
+			entry.type = content.getType( i );
+			if( entry.type == eTypeSequence )
+			{
+				const Sequence sequence = content.getSequence( i );
+				const std::string name = sequence.getPrefix() + sequence.getSuffix();
+				entry.nameOffset = addName( name );
+				entry.nameSize = name.size();
+				entry.prefixSize = sequence.getPrefix().size();
+				entry.fixedPadding = sequence.getFixedPadding();
+				entry.maxPadding = sequence.getMaxPadding();
+				entry.firstRange = _nbRanges;
+				entry.nbRanges = sequence.getFrameRanges().size();
+				BOOST_FOREACH( const FrameRange& range, sequence.getFrameRanges() )
+				{
+					const RangeRecord rangeRecord = { range.first, range.last, range.step };
+					writeRecord( _ranges, rangeRecord );
+					++_nbRanges;
+				}
+			}
+			else
+			{
+				const std::string name = content.getFilename( i );
+				entry.nameOffset = addName( name );
+				entry.nameSize = name.size();
+			}
+			writeRecord( _entries, entry );
+			++_nbEntries;
+		}
+		if( _withStats )
+		{
+			BOOST_FOREACH( const StatRecord& stat, stats )
+			{
+				writeRecord( _stats, stat );
+				++_nbStats;
+			}
+		}
+	}
+
+	/**
+	 * @brief Write the index in a temporary file, then replace the index in
+	 *        one step: the readers of the previous index keep a valid file.
+	 */
+	bool write( const std::string& rootDirectory, const EDetection detectOptions )
+	{
+		Header header;
+		std::memset( &header, 0, sizeof( Header ) );
+		std::memcpy( header.magic, magic, sizeof( magic ) );
+		header.version = version;
+		header.endianTag = endianTag;
+		header.detectOptions = detectOptions;
+		header.flags = _withStats ? eFlagStats : eFlagNone;
+		header.rootNameOffset = appendName( rootDirectory );
+		header.rootNameSize = rootDirectory.size();
+
+		_entries.close();
+		_ranges.close();
+		_stats.close();
+		_names.close();
+		if( ! _entries || ! _ranges || ! _stats || ! _names )
+			return false;
+
+		header.directories.offset = sizeof( Header );
+		header.directories.count = _directories.size();
+		header.entries.offset = header.directories.offset + _directories.size() * sizeof( DirectoryRecord );
+		header.entries.count = _nbEntries;
+		header.ranges.offset = header.entries.offset + _nbEntries * sizeof( EntryRecord );
+		header.ranges.count = _nbRanges;
+		header.stats.offset = header.ranges.offset + _nbRanges * sizeof( RangeRecord );
+		header.stats.count = _nbStats;
+		header.names.offset = header.stats.offset + _nbStats * sizeof( StatRecord );
+		header.names.count = _namesSize;
+		header.fileSize = align( header.names.offset + header.names.count );
+
+		_directories.sort();
+
+		const std::string& tmpFilename = _temporaryFiles.add( _indexFilename + ".tmp" );
+		{
+			std::ofstream file( tmpFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+			if( ! file )
+				return false;
+			writeRecord( file, header );
+			BOOST_FOREACH( const IndexedDirectory& directory, _directories )
+			{
+				writeRecord( file, directory.record );
+			}
+			if( ! appendSection( file, _indexFilename + ".entries.tmp", _nbEntries ) ||
+			    ! appendSection( file, _indexFilename + ".ranges.tmp", _nbRanges ) ||
+			    ! appendSection( file, _indexFilename + ".stats.tmp", _nbStats ) ||
+			    ! appendSection( file, _indexFilename + ".names.tmp", _namesSize ) )
+				return false;
+			const char padding[8] = { 0 };
+			file.write( padding, header.fileSize - header.names.offset - header.names.count );
+			if( ! file )
+				return false;
+		}
+		boost::system::error_code errorCode;
+		bfs::rename( tmpFilename, _indexFilename, errorCode );
+		return ! errorCode;
+	}
+
+private:
+	struct IndexedDirectory
+	{
+		std::string path;
+		DirectoryRecord record;
+
+		bool operator<( const IndexedDirectory& other ) const
+		{
+			return path < other.path;
+		}
+	};
+
+	void open( std::ofstream& file, const std::string& filename )
+	{
+		file.open( _temporaryFiles.add( filename ).c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	}
+
+	template<class Record>
+	static void writeRecord( std::ofstream& file, const Record& record )
+	{
+		file.write( reinterpret_cast<const char*>( &record ), sizeof( Record ) );
+	}
+
+	static bool appendSection( std::ofstream& file, const std::string& sectionFilename, const boost::uint64_t count )
+	{
+		if( count == 0 )
+			return true; // inserting an empty stream buffer sets the failbit
+		std::ifstream section( sectionFilename.c_str(), std::ios::in | std::ios::binary );
+		file << section.rdbuf();
+		return section && file;
+	}
+
+	/// the paths of the directories are unique, they are not looked up in the pool
+	boost::uint64_t appendName( const std::string& name )
+	{
+		const boost::uint64_t offset = _namesSize;
+		_names.write( name.data(), name.size() );
+		_namesSize += name.size();
+		return offset;
+	}
+
+	/// identical entry names are stored once
+	boost::uint64_t addName( const std::string& name )
+	{
+		const NameOffsets::const_iterator it = _nameOffsets.find( name );
+		if( it != _nameOffsets.end() )
+			return it->second;
+		const boost::uint64_t offset = appendName( name );
+		_nameOffsets.insert( std::make_pair( name, offset ) );
+		return offset;
+	}
+
+private:
+	typedef boost::unordered_map<std::string, boost::uint64_t> NameOffsets;
+
+	const std::string _indexFilename;
+	const bool _withStats;
+	TemporaryFiles _temporaryFiles;
+	std::ofstream _entries;
+	std::ofstream _ranges;
+	std::ofstream _stats;
+	std::ofstream _names;
+	boost::uint64_t _nbEntries;
+	boost::uint64_t _nbRanges;
+	boost::uint64_t _nbStats;
+	boost::uint64_t _namesSize;
+	std::list<IndexedDirectory> _directories;
+	NameOffsets _nameOffsets;
+};
+
+/**
+ * @brief Browse the directory tree, reusing the content of the directories
+ *        which have not been modified since the previous index.
+ *        Each directory is given to the writer as soon as it is listed.
+ * @return if the tree is complete, or how it has been stopped by the options
+ */
+EBrowseStatus indexDirectories(
+		IndexWriter& writer,
+		const std::string& rootDirectory,
+		const BrowseOptions& options,
+		const EDetection detectOptions,
+		const bool withStats,
+		const SequenceIndex* previous )
+{
+	const std::time_t now = std::time( NULL );
+	BrowseResult content;
+	std::vector<StatRecord> stats;
+	std::vector<std::string> toVisit( 1, rootDirectory );
+	while( ! toVisit.empty() )
+	{
+		const std::string directory = toVisit.back();
+		toVisit.pop_back();
+
+		// the directories reused from the previous index are not browsed
+		const EBrowseStatus status = options.getStatus();
+		if( status != eBrowseStatusComplete )
+			return status;
+
+		detail::DirectoryStamp stamp;
+		if( ! detail::getDirectoryStamp( directory, stamp ) )
+			continue;
+
+		stats.clear();
+		const std::ssize_t previousIndex = previous ? previous->findDirectory( directory ) : -1;
+		if( previousIndex != -1 && getStamp( previous->getDirectoryRecord( previousIndex ) ) == stamp )
+		{
+			previous->getContent( content, previousIndex );
+			for( std::size_t i = 0; withStats && i < content.size(); ++i )
+			{
+				StatRecord stat;
+				stat.size = previous->getEntrySize( previousIndex, i );
+				stat.modificationTime = previous->getEntryModificationTime( previousIndex, i );
+				stats.push_back( stat );
+			}
+		}
+		else
+		{
+			EBrowseStatus browseStatus;
+			try
+			{
+				browseStatus = browse( content, directory, options, detectOptions );
+			}
+			catch( const bfs::filesystem_error& )
+			{
+				// the directory can't be read
+				continue;
+			}
+			for( std::size_t i = 0; withStats && browseStatus == eBrowseStatusComplete && i < content.size(); ++i )
+			{
+				StatRecord stat;
+				browseStatus = getStat( content.getItem( i ), options, stat );
+				stats.push_back( stat );
+			}
+			if( browseStatus != eBrowseStatusComplete )
+				return browseStatus;
+		}
+
+		// a directory modified just now could be modified again with the same
+		// timestamp, keep an invalid stamp to list it again on the next update
+		writer.addDirectory( directory, stamp.isRecent( now, recentModificationDelay ) ? detail::DirectoryStamp() : stamp, content, stats );
+
+		for( std::size_t i = 0; i < content.size(); ++i )
+		{
+			if( content.getType( i ) == eTypeFolder )
+				toVisit.push_back( ( bfs::path( directory ) / content.getFilename( i ) ).string() );
+		}
+	}
+	return eBrowseStatusComplete;
+}
+
+}
+
+
+bool buildSequenceIndex(
+		const std::string& indexFilename,
+		const std::string& rootDirectory,
+		const EDetection detectOptions,
+		const bool withStats )
+{
+	return buildSequenceIndex( indexFilename, rootDirectory, BrowseOptions(), detectOptions, withStats );
+}
+
+bool buildSequenceIndex(
+		const std::string& indexFilename,
+		const std::string& rootDirectory,
+		const BrowseOptions& options,
+		const EDetection detectOptions,
+		const bool withStats )
+{
+	IndexWriter writer( indexFilename, withStats );
+	if( ! writer.isValid() )
+		return false;
+	if( indexDirectories( writer, rootDirectory, options, detectOptions, withStats, NULL ) != eBrowseStatusComplete )
+		return false;
+	return writer.write( rootDirectory, detectOptions );
+}
+
+bool updateSequenceIndex( const std::string& indexFilename )
+{
+	return updateSequenceIndex( indexFilename, BrowseOptions() );
+}
+
+bool updateSequenceIndex( const std::string& indexFilename, const BrowseOptions& options )
+{
+	SequenceIndex previous;
+	if( ! previous.open( indexFilename ) )
+		return false;
+
+	const std::string rootDirectory = previous.getRootDirectory();
+	const EDetection detectOptions = previous.getDetectionOptions();
+	const bool withStats = previous.hasStats();
+
+	IndexWriter writer( indexFilename, withStats );
+	if( ! writer.isValid() )
+		return false;
+	if( indexDirectories( writer, rootDirectory, options, detectOptions, withStats, &previous ) != eBrowseStatusComplete )
+		return false;
+	previous.close();
+	return writer.write( rootDirectory, detectOptions );
+}
+
+
+}
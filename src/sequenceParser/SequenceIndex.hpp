@@ -0,0 +1,173 @@
+#ifndef _SEQUENCE_PARSER_SEQUENCE_INDEX_HPP_
+#define _SEQUENCE_PARSER_SEQUENCE_INDEX_HPP_
+
+#include "common.hpp"
+#include "BrowseOptions.hpp"
+#include "BrowseResult.hpp"
+#include "Item.hpp"
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/cstdint.hpp>
+#ifndef SWIG
+#include <boost/utility/string_ref.hpp>
+#endif
+
+#include <vector>
+
+
+namespace sequenceParser {
+
+#ifndef SWIG
+namespace detail {
+class MappedFile;
+namespace index {
+struct Header;
+struct DirectoryRecord;
+struct EntryRecord;
+}
+}
+#endif
+
+/**
+ * @brief Content of a whole directory tree, stored in a file.
+ *
+ * The index is built from a recursive browse (see buildSequenceIndex):
+ * it contains the directories, their files and sequences (with their
+ * frame ranges), and optionally the size and modification time of each entry.
+ * The file is memory mapped and used in place, without any parsing,
+ * so opening an index is immediate whatever its size.
+ *
+ * The index could be updated with updateSequenceIndex: only the directories
+ * modified since the last build are listed again.
+ */
+class SequenceIndex
+{
+public:
+	typedef SequenceIndex This;
+
+public:
+	SequenceIndex();
+	explicit SequenceIndex( const std::string& filename );
+	~SequenceIndex();
+
+private:
+	SequenceIndex( const SequenceIndex& );
+	SequenceIndex& operator=( const SequenceIndex& );
+
+public:
+	/**
+	 * @brief Open an index file (the previous one is closed).
+	 * @return false if the file doesn't exist, or is not a valid index
+	 *         written by this version on a machine with the same byte order
+	 */
+	bool open( const std::string& filename );
+	void close();
+	bool isOpen() const;
+
+	/// @return the directory given to buildSequenceIndex
+	std::string getRootDirectory() const;
+
+	/// @return the detection options used to build the index
+	EDetection getDetectionOptions() const;
+
+	/// @return if the index contains the size and modification time of the entries
+	bool hasStats() const;
+
+	/// @return number of directories, sorted by path
+	std::size_t getNbDirectories() const;
+
+	std::string getDirectory( const std::size_t directoryIndex ) const;
+
+	/// @return the index of the directory, or -1 if the directory is not in the index
+	std::ssize_t findDirectory( const std::string& directory ) const;
+
+	/// @return number of entries (files, folders, links and sequences) of the directory
+	std::size_t getNbEntries( const std::size_t directoryIndex ) const;
+
+	/**
+	 * @brief Get the content of a directory, like browse.
+	 * @param[out] outResult: the content of the directory (previous content is removed).
+	 */
+	void getContent( BrowseResult& outResult, const std::size_t directoryIndex ) const;
+
+	/// @return the content of a directory, like browse
+	std::vector<Item> getItems( const std::size_t directoryIndex ) const;
+
+	/**
+	 * @return the size of the entry (total size of the files for a sequence),
+	 *         -1 without stats
+	 */
+	long long getEntrySize( const std::size_t directoryIndex, const std::size_t entryIndex ) const;
+
+	/**
+	 * @return the modification time of the entry (the last one for a sequence),
+	 *         -1 without stats
+	 */
+	long long getEntryModificationTime( const std::size_t directoryIndex, const std::size_t entryIndex ) const;
+
+#ifndef SWIG
+	const detail::index::DirectoryRecord& getDirectoryRecord( const std::size_t directoryIndex ) const;
+	const detail::index::EntryRecord& getEntryRecord( const std::size_t directoryIndex, const std::size_t entryIndex ) const;
+
+private:
+	boost::string_ref getNameRef( const boost::uint64_t offset, const boost::uint64_t size ) const;
+	std::string getName( const boost::uint64_t offset, const boost::uint64_t size ) const;
+	bool isValid() const;
+#endif
+
+private:
+	boost::scoped_ptr<detail::MappedFile> _file;
+	const detail::index::Header* _header;
+};
+
+/**
+ * @brief Browse a directory tree and write its content in an index file.
+ * Links to directories are not followed, directories which can't be read are skipped.
+ * @param[in] indexFilename: file to write (replaced atomically if it exists)
+ * @param[in] rootDirectory: the directory to browse recursively
+ * @param[in] detectOptions: options of the browse
+ * @param[in] withStats: also store the size and modification time of the entries
+ *                       (needs a stat on each file)
+ * @return false if the index can't be written
+ */
+bool buildSequenceIndex(
+	const std::string& indexFilename,
+	const std::string& rootDirectory,
+	const EDetection detectOptions = eDetectionDefault,
+	const bool withStats = false );
+
+/**
+ * @brief Same as buildSequenceIndex, controlled by options (cancellation, deadline, progress).
+ * @return false if the index can't be written, or if the build has been stopped
+ *         (see BrowseOptions::getStatus): a partial index is never written,
+ *         the previous index file is kept.
+ * @see buildSequenceIndex
+ */
+bool buildSequenceIndex(
+	const std::string& indexFilename,
+	const std::string& rootDirectory,
+	const BrowseOptions& options,
+	const EDetection detectOptions = eDetectionDefault,
+	const bool withStats = false );
+
+/**
+ * @brief Update an index file built by buildSequenceIndex, with the same options.
+ * Only the directories modified since the index was written are listed again.
+ * @warning The stats of unmodified directories are kept,
+ *          even if a file has been rewritten in place since.
+ * @return false if the index can't be read or written
+ */
+bool updateSequenceIndex( const std::string& indexFilename );
+
+/**
+ * @brief Same as updateSequenceIndex, controlled by options (cancellation, deadline, progress).
+ * @return false if the index can't be read or written, or if the update has been stopped
+ *         (the previous index file is kept)
+ * @see updateSequenceIndex
+ */
+bool updateSequenceIndex( const std::string& indexFilename, const BrowseOptions& options );
+
+
+}
+
+#endif
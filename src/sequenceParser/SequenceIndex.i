@@ -0,0 +1,10 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/SequenceIndex.hpp"
+%}
+
+%ignore sequenceParser::SequenceIndex::SequenceIndex( const SequenceIndex& );
+%ignore sequenceParser::SequenceIndex::operator=;
+
+%include "SequenceIndex.hpp"
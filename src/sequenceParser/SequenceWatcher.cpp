@@ -0,0 +1,560 @@
+#include "SequenceWatcher.hpp"
+#include "DirectorySource.hpp"
+#include "SequenceBuilder.hpp"
+#include "system.hpp"
+#include "utils.hpp"
+
+#include "detail/analyze.hpp"
+#include "detail/Arena.hpp"
+#include "detail/FileNumbers.hpp"
+#include "detail/FileStrings.hpp"
+#include "detail/SeqIdMap.hpp"
+#include "detail/materialize.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+
+#include <map>
+#include <set>
+
+#ifdef __LINUX__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+
+namespace sequenceParser {
+
+using detail::FileNumbers;
+using detail::FileStrings;
+namespace bfs = boost::filesystem;
+
+namespace {
+
+typedef std::map<std::string, EType> Files;
+
+/**
+ * @brief Files of a directory which share the same FileStrings.
+ */
+struct WatchedGroup
+{
+	WatchedGroup()
+	: isSingleSequence( false )
+	{}
+
+	Files files;
+	std::vector<Item> items; ///< files, sequences and directories built from the files
+
+	/// the files are regular files which build one sequence with a single padding
+	bool isSingleSequence;
+	Sequence sequence; ///< only with isSingleSequence
+	SequenceBuilder frames; ///< frames of the sequence, only with isSingleSequence
+};
+
+struct WatchedDirectory
+{
+	WatchedDirectory()
+	: source( NULL )
+	, detectOptions( eDetectionNone )
+	, watchDescriptor( -1 )
+	{}
+
+	DirectorySource* source; ///< where the directory is listed
+	bfs::path path;
+	EDetection detectOptions;
+	std::vector<boost::regex> filters;
+	std::string filterFilename;
+	int watchDescriptor;
+
+	Files files; ///< entries without number
+	std::map<std::string, WatchedGroup> groups; ///< entries with numbers, by FileStrings
+	std::set<std::string> modifiedGroups; ///< groups to build again
+};
+
+/// @return a key which identifies the FileStrings
+std::string getGroupKey( const FileStrings& stringParts )
+{
+	std::string key;
+	BOOST_FOREACH( const boost::string_ref& part, stringParts.getId() )
+	{
+		key.append( part.begin(), part.end() );
+		key += '\0'; // not allowed in filenames
+	}
+	return key;
+}
+
+/**
+ * @brief Get the frame of a file in a sequence (only unsigned numbers).
+ * @param[out] padding: fixed padding of the number, 0 without padding
+ * @param[out] digits: number of digits of the number
+ */
+bool getFrame( Sequence& sequence, const std::string& filename, Time& time, std::size_t& padding, std::size_t& digits )
+{
+	std::string timeStr;
+	if( ! sequence.isIn( filename, time, timeStr ) ||
+	    timeStr.find_first_not_of( "0123456789" ) != std::string::npos )
+		return false;
+	digits = timeStr.size();
+	padding = ( digits > 1 && timeStr[0] == '0' ) ? digits : 0;
+	return true;
+}
+
+/**
+ * @brief Add or remove a frame of a group which builds a single sequence,
+ *        only the ranges of the sequence are updated.
+ * @return false if the group needs to be built again
+ */
+bool updateSequenceFrames( const WatchedDirectory& directory, WatchedGroup& group, const std::string& filename, const EType type, const bool removed )
+{
+	if( ! group.isSingleSequence || ( ! removed && type != eTypeFile ) )
+		return false;
+
+	Time time = 0;
+	std::size_t padding = 0;
+	std::size_t digits = 0;
+	if( ! getFrame( group.sequence, filename, time, padding, digits ) ||
+	    padding != group.sequence.getFixedPadding() )
+		return false;
+	// without padding, the max padding is the smallest number of digits
+	if( padding == 0 && ( digits < group.sequence.getMaxPadding() || ( removed && digits == group.sequence.getMaxPadding() ) ) )
+		return false;
+
+	if( removed )
+	{
+		group.frames.remove( time );
+		// a single frame could be considered as a file
+		if( group.frames.getNbFrames() < 2 )
+			return false;
+	}
+	else
+	{
+		group.frames.add( time );
+	}
+	group.sequence.getFrameRanges() = group.frames.finalize();
+	group.items.front() = Item( group.sequence, directory.path );
+	return true;
+}
+
+/**
+ * @brief Add, update or remove a file in the content of the directory.
+ * @return if the content of the directory has changed
+ */
+bool updateFile( WatchedDirectory& directory, const std::string& filename, const EType type, const bool removed )
+{
+	if( ! filepathRespectsAllFilters( directory.path / filename, directory.filters, directory.filterFilename, directory.detectOptions ) )
+		return false;
+
+	FileStrings stringParts;
+	FileNumbers numberParts;
+	if( ! decomposeFilename( filename, stringParts, numberParts, directory.detectOptions ) )
+	{
+		if( removed )
+			return directory.files.erase( filename ) != 0;
+		EType& fileType = directory.files[filename];
+		const bool changed = ( fileType != type );
+		fileType = type;
+		return changed;
+	}
+
+	const std::string key = getGroupKey( stringParts );
+	WatchedGroup* group = NULL;
+	if( removed )
+	{
+		const std::map<std::string, WatchedGroup>::iterator it = directory.groups.find( key );
+		if( it == directory.groups.end() || it->second.files.erase( filename ) == 0 )
+			return false;
+		if( it->second.files.empty() )
+		{
+			directory.groups.erase( it );
+			directory.modifiedGroups.erase( key );
+			return true;
+		}
+		group = &it->second;
+	}
+	else
+	{
+		group = &directory.groups[key];
+		EType& fileType = group->files[filename];
+		if( fileType == type )
+			return false;
+		fileType = type;
+	}
+	if( directory.modifiedGroups.count( key ) != 0 ||
+	    ! updateSequenceFrames( directory, *group, filename, type, removed ) )
+		directory.modifiedGroups.insert( key );
+	return true;
+}
+
+/**
+ * @brief Build the sequences of a group from its files.
+ */
+void buildGroup( const WatchedDirectory& directory, WatchedGroup& group )
+{
+	detail::Arena arena;
+	detail::FileNumbersGroup numbersGroup( &arena );
+	FileStrings stringParts( &arena );
+	FileStrings tmpStringParts( &arena );
+	FileNumbers tmpNumberParts( &arena );
+
+	BOOST_FOREACH( const Files::value_type& file, group.files )
+	{
+		tmpStringParts.clear();
+		tmpNumberParts.clear();
+		// the parts reference the filename, which is the key of the map
+		decomposeFilename( file.first, tmpStringParts, tmpNumberParts, directory.detectOptions );
+		if( numbersGroup.numbers.empty() )
+		{
+			stringParts = tmpStringParts;
+			numbersGroup.firstType = file.second;
+		}
+		numbersGroup.numbers.push_back( tmpNumberParts );
+		numbersGroup.types |= file.second;
+	}
+
+	group.items.clear();
+	detail::ItemsOutput output( group.items, directory.path );
+	detail::materializeGroup( output, directory.path, stringParts, numbersGroup, directory.detectOptions, directory.source );
+
+	// the next frames of a single sequence only update its ranges
+	group.isSingleSequence = false;
+	group.frames.clear();
+	if( group.items.size() != 1 || group.items.front().getType() != eTypeSequence ||
+	    ( directory.detectOptions & eDetectionSequenceWithoutHoles ) )
+		return;
+	group.sequence = group.items.front().getSequence();
+	BOOST_FOREACH( const Files::value_type& file, group.files )
+	{
+		Time time = 0;
+		std::size_t padding = 0;
+		std::size_t digits = 0;
+		if( file.second != eTypeFile ||
+		    ! getFrame( group.sequence, file.first, time, padding, digits ) ||
+		    padding != group.sequence.getFixedPadding() )
+			return;
+		group.frames.add( time );
+	}
+	group.isSingleSequence = true;
+}
+
+void buildModifiedGroups( WatchedDirectory& directory )
+{
+	BOOST_FOREACH( const std::string& key, directory.modifiedGroups )
+	{
+		buildGroup( directory, directory.groups[key] );
+	}
+	directory.modifiedGroups.clear();
+}
+
+/**
+ * @brief List the directory and build all its sequences.
+ */
+bool loadDirectory( WatchedDirectory& directory )
+{
+	directory.files.clear();
+	directory.groups.clear();
+	directory.modifiedGroups.clear();
+
+	std::vector<DirectoryEntry> entries;
+	const bool listed = directory.source->listDirectory( directory.path, entries );
+	BOOST_FOREACH( const DirectoryEntry& entry, entries )
+	{
+		updateFile( directory, entry.filename, entry.type, false );
+	}
+	buildModifiedGroups( directory );
+	return listed;
+}
+
+}
+
+
+struct SequenceWatcher::Data
+{
+	Data()
+	: source( &getFilesystemDirectorySource() )
+	, fileDescriptor( -1 )
+	, nextSubscriberId( 0 )
+	{}
+
+	typedef std::map<std::string, WatchedDirectory> Directories;
+	DirectorySource* source;
+	Directories directories; ///< by directory, as given to watch
+	/// several keys could resolve to the same directory (a pattern, a trailing '/'),
+	/// inotify gives them the same watch descriptor
+	typedef std::map<int, std::set<std::string> > WatchDescriptors;
+	WatchDescriptors watchDescriptors;
+
+	int fileDescriptor;
+
+	typedef std::map<std::size_t, Callback> Subscribers;
+	Subscribers subscribers;
+	std::size_t nextSubscriberId;
+
+	void notify( const std::set<std::string>& modifiedDirectories ) const
+	{
+		BOOST_FOREACH( const std::string& directory, modifiedDirectories )
+		{
+			BOOST_FOREACH( const Subscribers::value_type& subscriber, subscribers )
+			{
+				subscriber.second( directory );
+			}
+		}
+	}
+};
+
+
+SequenceWatcher::SequenceWatcher()
+: _data( new Data() )
+{
+#ifdef __LINUX__
+	_data->fileDescriptor = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+#endif
+}
+
+SequenceWatcher::~SequenceWatcher()
+{
+#ifdef __LINUX__
+	if( _data->fileDescriptor != -1 )
+		::close( _data->fileDescriptor );
+#endif
+}
+
+bool SequenceWatcher::isSupported()
+{
+#ifdef __LINUX__
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SequenceWatcher::setDirectorySource( DirectorySource& source )
+{
+	_data->source = &source;
+}
+
+bool SequenceWatcher::watch(
+		const std::string& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	std::string tmpDir( directory );
+	std::vector<std::string> tmpFilters( filters );
+	std::string filename;
+	if( ! detectDirectoryInResearch( *_data->source, tmpDir, tmpFilters, filename ) )
+		return false;
+
+	WatchedDirectory& watched = _data->directories[directory];
+	watched.source = _data->source;
+	watched.path = tmpDir;
+	watched.detectOptions = detectOptions;
+	watched.filters = convertFilterToRegex( tmpFilters, detectOptions );
+	watched.filterFilename = filename;
+
+#ifdef __LINUX__
+	// watch before the listing, so no event is lost
+	// (the events already included in the listing have no effect)
+	if( _data->fileDescriptor != -1 && watched.watchDescriptor == -1 )
+	{
+		watched.watchDescriptor = inotify_add_watch( _data->fileDescriptor, tmpDir.c_str(),
+			IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE |
+			IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR );
+		if( watched.watchDescriptor != -1 )
+		{
+			_data->watchDescriptors[watched.watchDescriptor].insert( directory );
+		}
+		else if( _data->source == &getFilesystemDirectorySource() )
+		{
+			_data->directories.erase( directory );
+			return false;
+		}
+		// else a directory of another source could be unknown by the filesystem,
+		// it's only updated by reload
+	}
+#endif
+	if( ! loadDirectory( watched ) )
+	{
+		unwatch( directory );
+		return false;
+	}
+	return true;
+}
+
+void SequenceWatcher::unwatch( const std::string& directory )
+{
+	const Data::Directories::iterator it = _data->directories.find( directory );
+	if( it == _data->directories.end() )
+		return;
+#ifdef __LINUX__
+	if( it->second.watchDescriptor != -1 )
+	{
+		// the watch is removed with the last key of the directory
+		const Data::WatchDescriptors::iterator itDescriptor = _data->watchDescriptors.find( it->second.watchDescriptor );
+		itDescriptor->second.erase( directory );
+		if( itDescriptor->second.empty() )
+		{
+			inotify_rm_watch( _data->fileDescriptor, it->second.watchDescriptor );
+			_data->watchDescriptors.erase( itDescriptor );
+		}
+	}
+#endif
+	_data->directories.erase( it );
+}
+
+bool SequenceWatcher::isWatched( const std::string& directory ) const
+{
+	return _data->directories.find( directory ) != _data->directories.end();
+}
+
+std::vector<std::string> SequenceWatcher::getDirectories() const
+{
+	std::vector<std::string> directories;
+	BOOST_FOREACH( const Data::Directories::value_type& directory, _data->directories )
+	{
+		directories.push_back( directory.first );
+	}
+	return directories;
+}
+
+bool SequenceWatcher::reload( const std::string& directory )
+{
+	const Data::Directories::iterator it = _data->directories.find( directory );
+	if( it == _data->directories.end() )
+		return false;
+	return loadDirectory( it->second );
+}
+
+std::vector<Item> SequenceWatcher::getItems( const std::string& directory ) const
+{
+	std::vector<Item> items;
+	const Data::Directories::const_iterator it = _data->directories.find( directory );
+	if( it == _data->directories.end() )
+		return items;
+
+	const WatchedDirectory& watched = it->second;
+	BOOST_FOREACH( const Files::value_type& file, watched.files )
+	{
+		items.push_back( Item( file.second, watched.path / file.first ) );
+	}
+	typedef std::map<std::string, WatchedGroup>::value_type GroupValue;
+	BOOST_FOREACH( const GroupValue& group, watched.groups )
+	{
+		items.insert( items.end(), group.second.items.begin(), group.second.items.end() );
+	}
+	return items;
+}
+
+std::size_t SequenceWatcher::processEvents( const int timeout )
+{
+	std::set<std::string> modifiedDirectories;
+#ifdef __LINUX__
+	if( _data->fileDescriptor == -1 )
+		return 0;
+
+	pollfd pollInfos;
+	pollInfos.fd = _data->fileDescriptor;
+	pollInfos.events = POLLIN;
+	pollInfos.revents = 0;
+	if( poll( &pollInfos, 1, timeout ) <= 0 )
+		return 0;
+
+	// aligned buffer for the inotify events
+	union
+	{
+		inotify_event event;
+		char data[64 * 1024];
+	} buffer;
+
+	bool overflow = false;
+	for( ;; )
+	{
+		const ssize_t size = read( _data->fileDescriptor, buffer.data, sizeof( buffer.data ) );
+		if( size <= 0 )
+			break; // EAGAIN: no more event
+
+		for( const char* ptr = buffer.data; ptr < buffer.data + size; )
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>( ptr );
+			ptr += sizeof( inotify_event ) + event->len;
+
+			if( event->mask & IN_Q_OVERFLOW )
+			{
+				overflow = true;
+				continue;
+			}
+			const Data::WatchDescriptors::iterator itDescriptor = _data->watchDescriptors.find( event->wd );
+			if( itDescriptor == _data->watchDescriptors.end() )
+				continue;
+			// copy, the keys could be unwatched
+			const std::set<std::string> directoryKeys = itDescriptor->second;
+
+			if( event->mask & ( IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED ) )
+			{
+				// the directory doesn't exist anymore at this path
+				BOOST_FOREACH( const std::string& directoryKey, directoryKeys )
+				{
+					modifiedDirectories.insert( directoryKey );
+					unwatch( directoryKey );
+				}
+				continue;
+			}
+			if( event->len == 0 )
+				continue;
+
+			const std::string filename( event->name );
+			const bool removed = event->mask & ( IN_DELETE | IN_MOVED_FROM );
+			EType type = eTypeFolder;
+			if( ! removed && ! ( event->mask & IN_ISDIR ) )
+			{
+				const WatchedDirectory& watched = _data->directories[*directoryKeys.begin()];
+				type = watched.source->getType( watched.path / filename );
+				if( type == eTypeUndefined )
+					type = eTypeFile; // already removed
+			}
+			BOOST_FOREACH( const std::string& directoryKey, directoryKeys )
+			{
+				if( updateFile( _data->directories[directoryKey], filename, type, removed ) )
+					modifiedDirectories.insert( directoryKey );
+			}
+		}
+	}
+
+	if( overflow )
+	{
+		// some events are lost, list all the directories again
+		BOOST_FOREACH( Data::Directories::value_type& directory, _data->directories )
+		{
+			loadDirectory( directory.second );
+			modifiedDirectories.insert( directory.first );
+		}
+	}
+	BOOST_FOREACH( const std::string& directoryKey, modifiedDirectories )
+	{
+		const Data::Directories::iterator it = _data->directories.find( directoryKey );
+		if( it != _data->directories.end() )
+			buildModifiedGroups( it->second );
+	}
+	_data->notify( modifiedDirectories );
+#endif
+	return modifiedDirectories.size();
+}
+
+int SequenceWatcher::getFileDescriptor() const
+{
+	return _data->fileDescriptor;
+}
+
+std::size_t SequenceWatcher::subscribe( const Callback& callback )
+{
+	const std::size_t id = _data->nextSubscriberId++;
+	_data->subscribers[id] = callback;
+	return id;
+}
+
+void SequenceWatcher::unsubscribe( const std::size_t id )
+{
+	_data->subscribers.erase( id );
+}
+
+
+}
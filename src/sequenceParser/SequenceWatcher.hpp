@@ -0,0 +1,118 @@
+#ifndef _SEQUENCE_PARSER_SEQUENCE_WATCHER_HPP_
+#define _SEQUENCE_PARSER_SEQUENCE_WATCHER_HPP_
+
+#include "common.hpp"
+#include "Item.hpp"
+
+#include <boost/scoped_ptr.hpp>
+#ifndef SWIG
+#include <boost/function.hpp>
+#endif
+
+#include <vector>
+
+
+namespace sequenceParser {
+
+class DirectorySource;
+
+/**
+ * @brief Live content of a set of directories, kept up to date with the
+ *        filesystem events (inotify on Linux).
+ *
+ * Each directory is listed once when it is watched. Then the events
+ * (creation, deletion, move and end of write of a file) update the files
+ * and sequences of the directory without listing it again: a frame added
+ * to or removed from a sequence only updates its ranges, the other changes
+ * build again the sequences which share the filename of the modified file.
+ *
+ * The events are processed by processEvents, so the content is updated
+ * in the thread which calls it (the file descriptor could be used to wait
+ * for the events with select or poll).
+ *
+ * @warning Not thread safe, use the watcher from one thread.
+ * @note Without inotify (see isSupported), the content is only updated by reload.
+ */
+class SequenceWatcher
+{
+public:
+	typedef SequenceWatcher This;
+#ifndef SWIG
+	/// Called with the directory (as given to watch) when its content has changed.
+	typedef boost::function<void( const std::string& directory )> Callback;
+#endif
+
+public:
+	SequenceWatcher();
+	~SequenceWatcher();
+
+private:
+	SequenceWatcher( const SequenceWatcher& );
+	SequenceWatcher& operator=( const SequenceWatcher& );
+
+public:
+	/// @return if the filesystem events are available on this system
+	static bool isSupported();
+
+	/**
+	 * @brief List the directories with another source than the filesystem
+	 *        (for the next watches). The events still come from the filesystem:
+	 *        a directory unknown by the filesystem is only updated by reload.
+	 * @param[in] source: it needs to outlive the watcher
+	 */
+	void setDirectorySource( DirectorySource& source );
+
+	/**
+	 * @brief Start to watch a directory (or update its options if already watched).
+	 * @param[in] directory: the directory to watch (not recursive),
+	 *                       or a pattern in this directory (like browse)
+	 * @param[in] detectOptions: some options to choose how to consider sequences.
+	 * @param[in] filters: set filters to limit the search (see browse).
+	 * @return false if the directory can't be listed or watched
+	 */
+	bool watch(
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+	void unwatch( const std::string& directory );
+
+	bool isWatched( const std::string& directory ) const;
+
+	std::vector<std::string> getDirectories() const;
+
+	/// @brief List the directory again (in case of lost events).
+	bool reload( const std::string& directory );
+
+	/**
+	 * @return the content of a watched directory, like browse:
+	 *         the entries without number, then the sequences.
+	 */
+	std::vector<Item> getItems( const std::string& directory ) const;
+
+	/**
+	 * @brief Wait and process the pending filesystem events.
+	 * @param[in] timeout: maximal time to wait for the first event, in milliseconds
+	 *                     (0 to return immediately, -1 to wait indefinitely)
+	 * @return number of directories modified by the events
+	 */
+	std::size_t processEvents( const int timeout = 0 );
+
+	/// @return the file descriptor which is readable when there are events, -1 without inotify
+	int getFileDescriptor() const;
+
+#ifndef SWIG
+	/// @return an id to unsubscribe
+	std::size_t subscribe( const Callback& callback );
+	void unsubscribe( const std::size_t id );
+#endif
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+
+}
+
+#endif
@@ -0,0 +1,10 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/SequenceWatcher.hpp"
+%}
+
+%ignore sequenceParser::SequenceWatcher::SequenceWatcher( const SequenceWatcher& );
+%ignore sequenceParser::SequenceWatcher::operator=;
+
+%include "SequenceWatcher.hpp"
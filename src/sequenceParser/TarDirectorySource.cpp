@@ -0,0 +1,487 @@
+#include "TarDirectorySource.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/foreach.hpp>
+#include <boost/cstdint.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <map>
+
+
+namespace sequenceParser {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+const std::size_t blockSize = 512;
+const std::size_t gnuSparseIsExtended = 482; ///< offset in the header of an old GNU sparse file
+const std::size_t gnuSparseExtensionIsExtended = 504; ///< offset in the next blocks
+
+/// Fields of a tar header (ustar layout, the GNU and pax headers use the same one).
+struct TarHeader
+{
+	char name[100];
+	char mode[8];
+	char uid[8];
+	char gid[8];
+	char size[12];
+	char mtime[12];
+	char checksum[8];
+	char typeflag;
+	char linkname[100];
+	char magic[6];
+	char version[2];
+	char uname[32];
+	char gname[32];
+	char devmajor[8];
+	char devminor[8];
+	char prefix[155];
+	char padding[12];
+};
+
+/// @return the string of a field, which is not terminated if it uses all the field
+std::string getField( const char* field, const std::size_t size )
+{
+	return std::string( field, std::find( field, field + size, '\0' ) );
+}
+
+/**
+ * @brief Read a number field, in octal or in base-256 (GNU extension for the big values).
+ * @return false if it's not a number
+ */
+bool parseNumber( const char* field, const std::size_t size, boost::uint64_t& value )
+{
+	value = 0;
+	if( static_cast<unsigned char>( field[0] ) & 0x80 )
+	{
+		value = static_cast<unsigned char>( field[0] ) & 0x7F;
+		for( std::size_t i = 1; i < size; ++i )
+			value = ( value << 8 ) | static_cast<unsigned char>( field[i] );
+		return true;
+	}
+	std::size_t i = 0;
+	while( i < size && field[i] == ' ' )
+		++i;
+	for( ; i < size && field[i] != '\0' && field[i] != ' '; ++i )
+	{
+		if( field[i] < '0' || field[i] > '7' )
+			return false;
+		value = ( value << 3 ) | boost::uint64_t( field[i] - '0' );
+	}
+	return true;
+}
+
+/// @return if the checksum of the header is right (signed or unsigned sum, like tar)
+bool checkHeader( const char* block )
+{
+	const TarHeader& header = *reinterpret_cast<const TarHeader*>( block );
+	boost::uint64_t expected;
+	if( ! parseNumber( header.checksum, sizeof( header.checksum ), expected ) )
+		return false;
+
+	const std::size_t checksumBegin = offsetof( TarHeader, checksum );
+	const std::size_t checksumEnd = checksumBegin + sizeof( header.checksum );
+	long unsignedSum = 0;
+	long signedSum = 0;
+	for( std::size_t i = 0; i < blockSize; ++i )
+	{
+		const bool inChecksum = ( i >= checksumBegin && i < checksumEnd );
+		unsignedSum += inChecksum ? ' ' : static_cast<unsigned char>( block[i] );
+		signedSum += inChecksum ? ' ' : static_cast<signed char>( block[i] );
+	}
+	return boost::uint64_t( unsignedSum ) == expected || boost::uint64_t( signedSum ) == expected;
+}
+
+bool isZeroBlock( const char* block )
+{
+	for( std::size_t i = 0; i < blockSize; ++i )
+	{
+		if( block[i] != '\0' )
+			return false;
+	}
+	return true;
+}
+
+boost::uint64_t getPaddedSize( const boost::uint64_t size )
+{
+	return ( size + blockSize - 1 ) / blockSize * blockSize;
+}
+
+/**
+ * @brief Path of an entry relative to the root of the archive,
+ *        without "." and ".." (they are resolved) and without separators
+ *        at the beginning or the end.
+ * @param[out] outside: set to true if ".." goes above the root
+ */
+std::string normalizeArchivePath( const std::string& path, bool* outside = NULL )
+{
+	std::vector<std::string> components;
+	std::string::size_type begin = 0;
+	while( begin <= path.size() )
+	{
+		std::string::size_type end = path.find( '/', begin );
+		if( end == std::string::npos )
+			end = path.size();
+		const std::string component = path.substr( begin, end - begin );
+		if( component == ".." )
+		{
+			if( ! components.empty() )
+				components.pop_back();
+			else if( outside )
+				*outside = true;
+		}
+		else if( ! component.empty() && component != "." )
+		{
+			components.push_back( component );
+		}
+		begin = end + 1;
+	}
+
+	std::string result;
+	BOOST_FOREACH( const std::string& component, components )
+	{
+		if( ! result.empty() )
+			result += '/';
+		result += component;
+	}
+	return result;
+}
+
+/**
+ * @brief Read the records of a pax extended header, like "30 path=render/img.0001.exr\n".
+ */
+void parsePaxRecords( const std::string& records, std::string& path, std::string& linkPath, boost::uint64_t& size, bool& hasSize )
+{
+	std::string sparseName; // the real name of a GNU sparse file, instead of its path
+	std::string::size_type begin = 0;
+	while( begin < records.size() )
+	{
+		const std::string::size_type space = records.find( ' ', begin );
+		if( space == std::string::npos )
+			break;
+		if( space == begin || records.find_first_not_of( "0123456789", begin ) != space )
+			break;
+		std::size_t length = 0;
+		for( std::string::size_type i = begin; i < space; ++i )
+			length = length * 10 + std::size_t( records[i] - '0' );
+		if( length <= space - begin || begin + length > records.size() )
+			break;
+
+		// "key=value\n"
+		const std::string record = records.substr( space + 1, begin + length - space - 2 );
+		const std::string::size_type equal = record.find( '=' );
+		if( equal != std::string::npos )
+		{
+			const std::string key = record.substr( 0, equal );
+			const std::string value = record.substr( equal + 1 );
+			if( key == "path" )
+				path = value;
+			else if( key == "GNU.sparse.name" )
+				sparseName = value;
+			else if( key == "linkpath" )
+				linkPath = value;
+			else if( key == "size" && ! value.empty() && value.find_first_not_of( "0123456789" ) == std::string::npos )
+			{
+				size = 0;
+				BOOST_FOREACH( const char c, value )
+					size = size * 10 + boost::uint64_t( c - '0' );
+				hasSize = true;
+			}
+		}
+		begin += length;
+	}
+	if( ! sparseName.empty() )
+		path = sparseName;
+}
+
+}
+
+
+struct TarDirectorySource::Data
+{
+	Data()
+	: nbEntries( 0 )
+	{}
+
+	void clear()
+	{
+		archive.clear();
+		entries.clear();
+		links.clear();
+		nbEntries = 0;
+	}
+
+	void addEntry( const std::string& path, const EType type, const EType targetType = eTypeUndefined )
+	{
+		entries.addEntry( ( archive / path ).string(), type, targetType );
+	}
+
+	/// @brief Read the headers from the stream.
+	bool readHeaders( std::istream& stream );
+
+	/**
+	 * @brief Path relative to the root of the archive.
+	 * @return false if the path is not inside the archive
+	 */
+	bool getRelativePath( const bfs::path& path, std::string& relativePath ) const;
+
+	/**
+	 * @brief Replace the links inside a path relative to the root of the archive by their targets.
+	 * @return false if a link points outside of the archive (or there are too many links)
+	 */
+	bool resolveLinks( const std::string& relativePath, std::string& resolvedPath, const std::size_t depth = 0 ) const;
+
+	/// @return the path of an entry, with the links resolved in the directories (not the entry itself)
+	bfs::path getEntryPath( const bfs::path& path ) const;
+
+	bfs::path archive;
+	MemoryDirectorySource entries; ///< by directory, the archive is the root
+	std::map<std::string, std::string> links; ///< targets of the symbolic links, relative to the root (absolute if outside)
+	std::size_t nbEntries;
+};
+
+
+bool TarDirectorySource::Data::readHeaders( std::istream& stream )
+{
+	char block[blockSize];
+
+	// values from the GNU or pax headers, for the next entry
+	std::string longName;
+	std::string longLinkName;
+	boost::uint64_t paxSize = 0;
+	bool hasPaxSize = false;
+
+	while( stream.read( block, blockSize ) )
+	{
+		if( isZeroBlock( block ) )
+			return true; // end of the archive
+		if( ! checkHeader( block ) )
+			return false;
+
+		const TarHeader& header = *reinterpret_cast<const TarHeader*>( block );
+		const char typeflag = header.typeflag; // the block is reused for the GNU sparse headers
+		boost::uint64_t size;
+		if( ! parseNumber( header.size, sizeof( header.size ), size ) )
+			return false;
+
+		// headers which describe the next entry, their content is read
+		if( typeflag == 'L' || typeflag == 'K' || typeflag == 'x' )
+		{
+			std::string content( static_cast<std::size_t>( getPaddedSize( size ) ), '\0' );
+			if( ! content.empty() && ! stream.read( &content[0], content.size() ) )
+				return false;
+			content.resize( static_cast<std::size_t>( size ) );
+
+			if( typeflag == 'L' )
+				longName = getField( content.data(), content.size() );
+			else if( typeflag == 'K' )
+				longLinkName = getField( content.data(), content.size() );
+			else
+				parsePaxRecords( content, longName, longLinkName, paxSize, hasPaxSize );
+			continue;
+		}
+
+		std::string name = longName;
+		if( name.empty() )
+		{
+			name = getField( header.name, sizeof( header.name ) );
+			const bool isUstar = ( std::strncmp( header.magic, "ustar", 5 ) == 0 );
+			if( isUstar && header.prefix[0] != '\0' )
+				name = getField( header.prefix, sizeof( header.prefix ) ) + "/" + name;
+		}
+		const std::string linkName = longLinkName.empty() ? getField( header.linkname, sizeof( header.linkname ) ) : longLinkName;
+		if( hasPaxSize )
+			size = paxSize;
+		longName.clear();
+		longLinkName.clear();
+		hasPaxSize = false;
+
+		// the old GNU sparse files could describe their holes in the next blocks
+		if( typeflag == 'S' && block[gnuSparseIsExtended] != '\0' )
+		{
+			do
+			{
+				if( ! stream.read( block, blockSize ) )
+					return false;
+			}
+			while( block[gnuSparseExtensionIsExtended] != '\0' );
+		}
+
+		// skip the content of the entry
+		if( size != 0 && ! stream.seekg( static_cast<std::streamoff>( getPaddedSize( size ) ), std::ios::cur ) )
+			return false;
+
+		const std::string path = normalizeArchivePath( name );
+		if( path.empty() || typeflag == 'g' || typeflag == 'V' ) // the root, a global pax header or a volume name
+			continue;
+
+		++nbEntries;
+		switch( typeflag )
+		{
+			case '5': // directory
+			case 'D': // GNU dump of a directory
+				addEntry( path, eTypeFolder );
+				break;
+			case '2': // symbolic link, relative to its directory
+			{
+				const std::string::size_type separator = path.rfind( '/' );
+				const std::string directory = ( separator == std::string::npos ) ? std::string() : path.substr( 0, separator );
+				bool outside = ( ! linkName.empty() && linkName[0] == '/' );
+				const std::string target = outside ? linkName : normalizeArchivePath( directory + "/" + linkName, &outside );
+				links[path] = outside ? "/" + target : target;
+				addEntry( path, eTypeLink );
+				break;
+			}
+			case '3': // character device
+			case '4': // block device
+			case '6': // FIFO
+				// like the filesystem source, the special files have no type
+				addEntry( path, eTypeUndefined );
+				break;
+			default:
+				// the old archives have no type for the directories
+				addEntry( path, ( name[name.size() - 1] == '/' ) ? eTypeFolder : eTypeFile );
+				break;
+		}
+	}
+	return false; // truncated archive
+}
+
+bool TarDirectorySource::Data::getRelativePath( const bfs::path& path, std::string& relativePath ) const
+{
+	const std::string pathStr = path.string();
+	const std::string archiveStr = archive.string();
+	if( pathStr.compare( 0, archiveStr.size(), archiveStr ) != 0 )
+		return false;
+	if( pathStr.size() == archiveStr.size() )
+	{
+		relativePath.clear();
+		return true;
+	}
+	if( pathStr[archiveStr.size()] != '/' )
+		return false;
+	bool outside = false;
+	relativePath = normalizeArchivePath( pathStr.substr( archiveStr.size() + 1 ), &outside );
+	return ! outside;
+}
+
+bool TarDirectorySource::Data::resolveLinks( const std::string& relativePath, std::string& resolvedPath, const std::size_t depth ) const
+{
+	// like the systems (ELOOP), for the cycles
+	static const std::size_t maxLinkDepth = 40;
+
+	resolvedPath.clear();
+	std::string::size_type begin = 0;
+	while( begin < relativePath.size() )
+	{
+		std::string::size_type end = relativePath.find( '/', begin );
+		if( end == std::string::npos )
+			end = relativePath.size();
+		const std::string candidate = ( resolvedPath.empty() ? std::string() : resolvedPath + "/" ) + relativePath.substr( begin, end - begin );
+		begin = end + 1;
+
+		const std::map<std::string, std::string>::const_iterator link = links.find( candidate );
+		if( link == links.end() )
+		{
+			resolvedPath = candidate;
+			continue;
+		}
+		if( depth >= maxLinkDepth || ( ! link->second.empty() && link->second[0] == '/' ) )
+			return false;
+		if( ! resolveLinks( link->second, resolvedPath, depth + 1 ) )
+			return false;
+	}
+	return true;
+}
+
+bfs::path TarDirectorySource::Data::getEntryPath( const bfs::path& path ) const
+{
+	std::string relativePath;
+	if( ! getRelativePath( path, relativePath ) || relativePath.empty() )
+		return path;
+
+	const std::string::size_type separator = relativePath.rfind( '/' );
+	if( separator == std::string::npos )
+		return path; // directly in the root
+
+	std::string resolvedDirectory;
+	if( ! resolveLinks( relativePath.substr( 0, separator ), resolvedDirectory ) )
+		return bfs::path(); // nothing
+	return archive / resolvedDirectory / relativePath.substr( separator + 1 );
+}
+
+
+TarDirectorySource::TarDirectorySource()
+: _data( new Data() )
+{}
+
+TarDirectorySource::TarDirectorySource( const std::string& archive )
+: _data( new Data() )
+{
+	open( archive );
+}
+
+TarDirectorySource::~TarDirectorySource()
+{}
+
+bool TarDirectorySource::open( const std::string& archive )
+{
+	_data->clear();
+	_data->archive = archive;
+
+	bfs::ifstream stream( _data->archive, std::ios::in | std::ios::binary );
+	if( ! stream )
+		return false;
+	_data->entries.addEntry( _data->archive.string(), eTypeFolder );
+
+	const bool succeeded = _data->readHeaders( stream );
+
+	// the types of the targets, when all the entries are known
+	// (resolveLinks also follows the last component of the path, so a link
+	// to a link gets the type of the final target, with the same depth limit)
+	typedef std::map<std::string, std::string>::value_type Link;
+	BOOST_FOREACH( const Link& link, _data->links )
+	{
+		std::string target;
+		const EType targetType = _data->resolveLinks( link.second, target ) ?
+			_data->entries.getType( _data->archive / target ) : eTypeUndefined;
+		_data->addEntry( link.first, eTypeLink, targetType );
+	}
+	return succeeded;
+}
+
+const boost::filesystem::path& TarDirectorySource::getArchive() const
+{
+	return _data->archive;
+}
+
+std::size_t TarDirectorySource::getNbEntries() const
+{
+	return _data->nbEntries;
+}
+
+bool TarDirectorySource::listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries )
+{
+	std::string relativePath;
+	if( ! _data->getRelativePath( directory, relativePath ) )
+		return _data->entries.listDirectory( directory, outEntries ); // the directories of the archive itself
+
+	std::string resolvedPath;
+	if( ! _data->resolveLinks( relativePath, resolvedPath ) )
+		return false;
+	return _data->entries.listDirectory( _data->archive / resolvedPath, outEntries );
+}
+
+EType TarDirectorySource::getType( const boost::filesystem::path& path, const bool followLinks )
+{
+	const bfs::path entryPath = _data->getEntryPath( path );
+	if( entryPath.empty() )
+		return eTypeUndefined;
+	return _data->entries.getType( entryPath, followLinks );
+}
+
+
+}
@@ -0,0 +1,68 @@
+#ifndef _SEQUENCE_PARSER_TAR_DIRECTORY_SOURCE_HPP_
+#define _SEQUENCE_PARSER_TAR_DIRECTORY_SOURCE_HPP_
+
+#include "DirectorySource.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace sequenceParser {
+
+/**
+ * @brief The directories inside a tar archive, without any extraction.
+ *
+ * Only the headers of the archive are read, once, when it's opened
+ * (the content of the files is skipped), so browsing a big archive costs one
+ * sequential scan of its headers.
+ * The archive is seen as a directory: the paths of its entries start with
+ * the path of the archive, like "/archives/shot010.tar/render/img.0001.exr".
+ *
+ * The ustar, GNU (long names, big sizes) and pax (path, linkpath, size)
+ * headers are supported.
+ */
+class TarDirectorySource : public DirectorySource
+{
+public:
+	typedef TarDirectorySource This;
+
+public:
+	TarDirectorySource();
+	/// @see open
+	explicit TarDirectorySource( const std::string& archive );
+	~TarDirectorySource();
+
+private:
+	TarDirectorySource( const TarDirectorySource& );
+	TarDirectorySource& operator=( const TarDirectorySource& );
+
+public:
+	/**
+	 * @brief Read the headers of an archive (the previous one is closed).
+	 * @return false if the archive can't be read, or is corrupted
+	 *         (the entries before the error are kept).
+	 */
+	bool open( const std::string& archive );
+
+	/// @return the path of the archive, which is the root directory of its entries
+	const boost::filesystem::path& getArchive() const;
+
+	/// @return number of entries in the archive
+	std::size_t getNbEntries() const;
+
+	using DirectorySource::listDirectory;
+	bool listDirectory( const boost::filesystem::path& directory, std::vector<DirectoryEntry>& outEntries );
+	EType getType( const boost::filesystem::path& path, const bool followLinks = false );
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+
+}
+
+#endif
@@ -0,0 +1,20 @@
+%include "common.i"
+
+%{
+#include "sequenceParser/TarDirectorySource.hpp"
+%}
+
+%ignore sequenceParser::TarDirectorySource::TarDirectorySource( const TarDirectorySource& );
+%ignore sequenceParser::TarDirectorySource::operator=;
+%ignore sequenceParser::TarDirectorySource::getArchive;
+
+%include "TarDirectorySource.hpp"
+
+%extend sequenceParser::TarDirectorySource
+{
+	std::string getArchive() const
+	{
+		return $self->getArchive().string();
+	}
+}
+
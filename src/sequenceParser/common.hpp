@@ -27,6 +27,7 @@ typedef ::ssize_t ssize_t;
 namespace boost {
 namespace filesystem {
 class path;
+class file_status;
 }
 }
 
@@ -16,6 +16,18 @@ namespace sequenceParser {
 typedef int Time;
 }
 
+#ifdef SWIGPYTHON
+// the frames as a tuple of numbers
+%typemap(out) std::vector<sequenceParser::Time>
+{
+	$result = PyTuple_New( $1.size() );
+	for( std::size_t i = 0; i < $1.size(); ++i )
+	{
+		PyTuple_SetItem( $result, i, PyLong_FromLongLong( $1[i] ) );
+	}
+}
+#endif
+
 %exception {
 try
 {
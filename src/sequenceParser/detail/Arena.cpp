@@ -0,0 +1,83 @@
+#include "Arena.hpp"
+
+#include <boost/foreach.hpp>
+#include <boost/assert.hpp>
+
+#include <cstring>
+
+namespace sequenceParser {
+namespace detail {
+
+
+Arena::Arena( const std::size_t blockSize )
+: _blockSize( blockSize )
+, _current( NULL )
+, _end( NULL )
+, _nbBytes( 0 )
+{
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+char* Arena::allocateBlock( const std::size_t size )
+{
+	char* block = static_cast<char*>( ::operator new( size ) );
+	_blocks.push_back( block );
+	_nbBytes += size;
+	return block;
+}
+
+void* Arena::allocate( const std::size_t size, const std::size_t alignment )
+{
+	BOOST_ASSERT( alignment != 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+
+	const std::size_t misalignment = reinterpret_cast<std::size_t>( _current ) & ( alignment - 1 );
+	const std::size_t padding = misalignment ? alignment - misalignment : 0;
+
+	if( _current && std::size_t( _end - _current ) >= size + padding )
+	{
+		void* p = _current + padding;
+		_current += padding + size;
+		return p;
+	}
+
+	if( size + alignment > _blockSize / 4 )
+	{
+		// big allocation: use a dedicated block, keep the current one
+		// (::operator new is aligned for any standard type)
+		return allocateBlock( size );
+	}
+
+	_current = allocateBlock( _blockSize );
+	_end = _current + _blockSize;
+	void* p = _current;
+	_current += size;
+	return p;
+}
+
+boost::string_ref Arena::copy( const boost::string_ref& str )
+{
+	if( str.empty() )
+		return boost::string_ref();
+	char* p = static_cast<char*>( allocate( str.size(), 1 ) );
+	std::memcpy( p, str.data(), str.size() );
+	return boost::string_ref( p, str.size() );
+}
+
+void Arena::release()
+{
+	BOOST_FOREACH( char* block, _blocks )
+	{
+		::operator delete( block );
+	}
+	_blocks.clear();
+	_current = NULL;
+	_end = NULL;
+	_nbBytes = 0;
+}
+
+}
+}
@@ -0,0 +1,127 @@
+#ifndef _SEQUENCE_PARSER_ARENA_HPP_
+#define _SEQUENCE_PARSER_ARENA_HPP_
+
+#include <boost/noncopyable.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <vector>
+#include <new>
+#include <limits>
+#include <cstddef>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Monotonic memory pool used during a detection.
+ * Internal structures to detect sequence inside a directory.
+ *
+ * Memory is taken from big blocks and is never given back individually:
+ * everything is released at once when the arena is destroyed.
+ * An arena is not thread safe, use one arena per detection.
+ */
+class Arena : boost::noncopyable
+{
+public:
+	explicit Arena( const std::size_t blockSize = 64 * 1024 );
+	~Arena();
+
+	void* allocate( const std::size_t size, const std::size_t alignment );
+
+	/// @brief Copy characters inside the arena.
+	boost::string_ref copy( const boost::string_ref& str );
+
+	/// @brief Free all the memory allocated by the arena.
+	void release();
+
+	/// @return total size of the blocks allocated by the arena
+	std::size_t getNbBytes() const { return _nbBytes; }
+
+private:
+	char* allocateBlock( const std::size_t size );
+
+private:
+	std::vector<char*> _blocks;
+	std::size_t _blockSize;
+	char* _current; ///< next free byte of the current block
+	char* _end; ///< end of the current block
+	std::size_t _nbBytes;
+};
+
+
+/**
+ * @brief STL allocator which takes its memory from an Arena.
+ * Without arena, it uses the standard heap.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef ArenaAllocator<U> other;
+	};
+
+public:
+	ArenaAllocator( Arena* arena = NULL )
+	: _arena( arena )
+	{}
+
+	template<typename U>
+	ArenaAllocator( const ArenaAllocator<U>& other )
+	: _arena( other.getArena() )
+	{}
+
+	pointer allocate( const size_type n, const void* = 0 )
+	{
+		if( _arena )
+			return static_cast<pointer>( _arena->allocate( n * sizeof(T), boost::alignment_of<T>::value ) );
+		return static_cast<pointer>( ::operator new( n * sizeof(T) ) );
+	}
+
+	void deallocate( pointer p, const size_type )
+	{
+		// the arena releases everything at once
+		if( ! _arena )
+			::operator delete( p );
+	}
+
+	void construct( pointer p, const T& value ) { new( static_cast<void*>( p ) ) T( value ); }
+	void destroy( pointer p ) { p->~T(); }
+
+	pointer address( reference x ) const { return &x; }
+	const_pointer address( const_reference x ) const { return &x; }
+	size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+	Arena* getArena() const { return _arena; }
+
+private:
+	Arena* _arena;
+};
+
+template<typename T, typename U>
+inline bool operator==( const ArenaAllocator<T>& a, const ArenaAllocator<U>& b )
+{
+	return a.getArena() == b.getArena();
+}
+
+template<typename T, typename U>
+inline bool operator!=( const ArenaAllocator<T>& a, const ArenaAllocator<U>& b )
+{
+	return a.getArena() != b.getArena();
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,282 @@
+#include "DigitScanner.hpp"
+
+#include <cstring>
+#include <limits>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define SEQUENCE_PARSER_DIGITS_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is only compiled for the functions which need it, and used if the processor supports it
+#if defined(SEQUENCE_PARSER_DIGITS_SSE2) && ( defined(__x86_64__) || defined(__i386__) ) && \
+    ( defined(__clang__) || ( defined(__GNUC__) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) )
+#define SEQUENCE_PARSER_DIGITS_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+namespace sequenceParser {
+namespace detail {
+
+namespace {
+
+inline bool isDigit( const char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+const char* findDigitScalar( const char* begin, const char* end )
+{
+	while( begin != end && ! isDigit( *begin ) )
+		++begin;
+	return begin;
+}
+
+const char* findNonDigitScalar( const char* begin, const char* end )
+{
+	while( begin != end && isDigit( *begin ) )
+		++begin;
+	return begin;
+}
+
+#ifdef SEQUENCE_PARSER_DIGITS_SSE2
+
+inline unsigned countTrailingZeros( const unsigned mask )
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward( &index, mask );
+	return index;
+#else
+	return __builtin_ctz( mask );
+#endif
+}
+
+/// @return a bit for each digit of the 16 characters
+inline unsigned digitMask16( const char* str )
+{
+	const __m128i chars = _mm_loadu_si128( reinterpret_cast<const __m128i*>( str ) );
+	// signed comparisons: the characters above 127 are negative, so not digits
+	const __m128i afterZero = _mm_cmpgt_epi8( chars, _mm_set1_epi8( '0' - 1 ) );
+	const __m128i beforeNine = _mm_cmplt_epi8( chars, _mm_set1_epi8( '9' + 1 ) );
+	return unsigned( _mm_movemask_epi8( _mm_and_si128( afterZero, beforeNine ) ) );
+}
+
+const char* findDigitSSE2( const char* begin, const char* end )
+{
+	for( ; end - begin >= 16; begin += 16 )
+	{
+		const unsigned mask = digitMask16( begin );
+		if( mask )
+			return begin + countTrailingZeros( mask );
+	}
+	return findDigitScalar( begin, end );
+}
+
+const char* findNonDigitSSE2( const char* begin, const char* end )
+{
+	for( ; end - begin >= 16; begin += 16 )
+	{
+		const unsigned mask = ~digitMask16( begin ) & 0xFFFF;
+		if( mask )
+			return begin + countTrailingZeros( mask );
+	}
+	return findNonDigitScalar( begin, end );
+}
+
+#endif
+
+#ifdef SEQUENCE_PARSER_DIGITS_AVX2
+
+/// @return a bit for each digit of the 32 characters
+__attribute__(( target( "avx2" ) ))
+inline unsigned digitMask32( const char* str )
+{
+	const __m256i chars = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( str ) );
+	const __m256i afterZero = _mm256_cmpgt_epi8( chars, _mm256_set1_epi8( '0' - 1 ) );
+	const __m256i beforeNine = _mm256_cmpgt_epi8( _mm256_set1_epi8( '9' + 1 ), chars );
+	return unsigned( _mm256_movemask_epi8( _mm256_and_si256( afterZero, beforeNine ) ) );
+}
+
+__attribute__(( target( "avx2" ) ))
+const char* findDigitAVX2( const char* begin, const char* end )
+{
+	for( ; end - begin >= 32; begin += 32 )
+	{
+		const unsigned mask = digitMask32( begin );
+		if( mask )
+			return begin + countTrailingZeros( mask );
+	}
+	return findDigitSSE2( begin, end );
+}
+
+__attribute__(( target( "avx2" ) ))
+const char* findNonDigitAVX2( const char* begin, const char* end )
+{
+	for( ; end - begin >= 32; begin += 32 )
+	{
+		const unsigned mask = ~digitMask32( begin );
+		if( mask )
+			return begin + countTrailingZeros( mask );
+	}
+	return findNonDigitSSE2( begin, end );
+}
+
+#endif
+
+/**
+ * @brief Implementation of the scan for the processor, chosen once.
+ */
+struct DigitScanner
+{
+	typedef const char* (*FindFunction)( const char*, const char* );
+
+	DigitScanner()
+	{
+		if( ! select( "avx2" ) && ! select( "sse2" ) )
+			select( "scalar" );
+	}
+
+	/// @return false if the instructions are not supported
+	bool select( const std::string& newName )
+	{
+		if( newName == "scalar" )
+			return set( "scalar", &findDigitScalar, &findNonDigitScalar );
+#ifdef SEQUENCE_PARSER_DIGITS_SSE2
+		if( newName == "sse2" )
+			return set( "sse2", &findDigitSSE2, &findNonDigitSSE2 );
+#endif
+#ifdef SEQUENCE_PARSER_DIGITS_AVX2
+		__builtin_cpu_init();
+		if( newName == "avx2" && __builtin_cpu_supports( "avx2" ) )
+			return set( "avx2", &findDigitAVX2, &findNonDigitAVX2 );
+#endif
+		return false;
+	}
+
+	bool set( const char* newName, FindFunction newFindDigit, FindFunction newFindNonDigit )
+	{
+		name = newName;
+		findDigit = newFindDigit;
+		findNonDigit = newFindNonDigit;
+		return true;
+	}
+
+	const char* name;
+	FindFunction findDigit;
+	FindFunction findNonDigit;
+};
+
+static DigitScanner digitScanner;
+
+inline bool isLittleEndian()
+{
+	const boost::uint16_t one = 1;
+	return *reinterpret_cast<const unsigned char*>( &one ) == 1;
+}
+
+/// @return if the 8 characters are digits
+inline bool areEightDigits( const char* str )
+{
+	boost::uint64_t value;
+	std::memcpy( &value, str, sizeof( value ) );
+	// each byte needs to be 0x3N, with N + 6 < 16
+	return ( value & 0xF0F0F0F0F0F0F0F0ULL ) == 0x3030303030303030ULL &&
+	       ( ( value + 0x0606060606060606ULL ) & 0xF0F0F0F0F0F0F0F0ULL ) == 0x3030303030303030ULL;
+}
+
+}
+
+
+const char* findDigit( const char* begin, const char* end )
+{
+	return digitScanner.findDigit( begin, end );
+}
+
+const char* findNonDigit( const char* begin, const char* end )
+{
+	return digitScanner.findNonDigit( begin, end );
+}
+
+const char* getDigitScannerName()
+{
+	return digitScanner.name;
+}
+
+bool setDigitScanner( const std::string& name )
+{
+	return digitScanner.select( name );
+}
+
+boost::uint32_t parseEightDigits( const char* str )
+{
+	if( ! isLittleEndian() )
+	{
+		boost::uint32_t value = 0;
+		for( int i = 0; i < 8; ++i )
+			value = value * 10 + boost::uint32_t( str[i] - '0' );
+		return value;
+	}
+	boost::uint64_t value;
+	std::memcpy( &value, str, sizeof( value ) );
+	value -= 0x3030303030303030ULL;
+	// pairs of digits, then groups of 4 digits, then the 8 digits
+	value = ( value * 10 ) + ( value >> 8 );
+	value = ( ( ( value & 0x000000FF000000FFULL ) * ( 100 + ( 1000000ULL << 32 ) ) ) +
+	          ( ( ( value >> 16 ) & 0x000000FF000000FFULL ) * ( 1 + ( 10000ULL << 32 ) ) ) ) >> 32;
+	return boost::uint32_t( value );
+}
+
+bool parseTime( const boost::string_ref& str, Time& time )
+{
+	const char* it = str.begin();
+	const char* const end = str.end();
+
+	bool negative = false;
+	if( it != end && ( *it == '-' || *it == '+' ) )
+	{
+		negative = ( *it == '-' );
+		++it;
+	}
+	if( it == end )
+		return false;
+
+	const boost::uint64_t maxValue = negative ?
+		boost::uint64_t( std::numeric_limits<Time>::max() ) + 1 :
+		boost::uint64_t( std::numeric_limits<Time>::max() );
+
+	boost::uint64_t value = 0;
+	for( ; end - it >= 8; it += 8 )
+	{
+		if( ! areEightDigits( it ) )
+			return false;
+		const boost::uint64_t digits = parseEightDigits( it );
+		if( value > ( maxValue - digits ) / 100000000 )
+			return false; // out of range
+		value = value * 100000000 + digits;
+	}
+	for( ; it != end; ++it )
+	{
+		if( ! isDigit( *it ) )
+			return false;
+		const boost::uint64_t digit = boost::uint64_t( *it - '0' );
+		if( value > ( maxValue - digit ) / 10 )
+			return false; // out of range
+		value = value * 10 + digit;
+	}
+
+	if( ! negative || value == 0 )
+		time = Time( value );
+	else
+		time = -Time( value - 1 ) - 1; // -(max + 1) is not a positive Time
+	return true;
+}
+
+}
+}
@@ -0,0 +1,53 @@
+#ifndef _SEQUENCE_PARSER_DETAIL_DIGIT_SCANNER_HPP_
+#define _SEQUENCE_PARSER_DETAIL_DIGIT_SCANNER_HPP_
+
+#include <sequenceParser/common.hpp>
+
+#include <boost/cstdint.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <string>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Character classification of the filenames, to find the numbers.
+ * Internal functions to detect sequence inside a directory.
+ *
+ * The characters are compared by blocks of 16 (SSE2) or 32 (AVX2) when
+ * the processor supports it (checked at runtime), one by one otherwise.
+ */
+
+/// @return the first digit of [begin, end), or end
+const char* findDigit( const char* begin, const char* end );
+
+/// @return the first character of [begin, end) which is not a digit, or end
+const char* findNonDigit( const char* begin, const char* end );
+
+/// @return name of the instructions used by findDigit and findNonDigit ("avx2", "sse2" or "scalar")
+const char* getDigitScannerName();
+
+/**
+ * @brief Use other instructions than the fastest ones, to compare them.
+ * @warning Not thread safe: no scan should run at the same time.
+ * @return false if the processor or the build doesn't support them (nothing changes)
+ */
+bool setDigitScanner( const std::string& name );
+
+/**
+ * @brief Value of 8 decimal digits, computed in a 64 bits integer at once (SWAR).
+ * @warning the 8 characters need to be digits
+ */
+boost::uint32_t parseEightDigits( const char* str );
+
+/**
+ * @brief Convert a number with an optional sign, like boost::lexical_cast<Time>.
+ * @return false if it's not a number, or if it's out of range
+ */
+bool parseTime( const boost::string_ref& str, Time& time );
+
+}
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "DirectoryStamp.hpp"
+
+#include <sequenceParser/system.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#ifdef __UNIX__
+#include <sys/stat.h>
+#endif
+
+namespace sequenceParser {
+namespace detail {
+
+namespace {
+const boost::int64_t nanoseconds = 1000000000;
+}
+
+bool DirectoryStamp::isRecent( const boost::int64_t now, const boost::int64_t delay ) const
+{
+	return modificationTime / nanoseconds + delay >= now ||
+	       lastChangeTime / nanoseconds + delay >= now;
+}
+
+bool getDirectoryStamp( const boost::filesystem::path& directory, DirectoryStamp& outStamp )
+{
+#ifdef __UNIX__
+	struct stat statInfos;
+	if( stat( directory.c_str(), &statInfos ) == -1 )
+		return false;
+	outStamp.deviceId = statInfos.st_dev;
+	outStamp.inodeId = statInfos.st_ino;
+#if defined( __MACOS__ )
+	outStamp.modificationTime = statInfos.st_mtimespec.tv_sec * nanoseconds + statInfos.st_mtimespec.tv_nsec;
+	outStamp.lastChangeTime = statInfos.st_ctimespec.tv_sec * nanoseconds + statInfos.st_ctimespec.tv_nsec;
+#else
+	outStamp.modificationTime = statInfos.st_mtim.tv_sec * nanoseconds + statInfos.st_mtim.tv_nsec;
+	outStamp.lastChangeTime = statInfos.st_ctim.tv_sec * nanoseconds + statInfos.st_ctim.tv_nsec;
+#endif
+#else
+	boost::system::error_code errorCode;
+	const std::time_t modificationTime = boost::filesystem::last_write_time( directory, errorCode );
+	if( errorCode )
+		return false;
+	outStamp.deviceId = 0;
+	outStamp.inodeId = 0;
+	outStamp.modificationTime = modificationTime * nanoseconds;
+	outStamp.lastChangeTime = 0;
+#endif
+	return true;
+}
+
+}
+}
@@ -0,0 +1,59 @@
+#ifndef _SEQUENCE_PARSER_DIRECTORY_STAMP_HPP_
+#define _SEQUENCE_PARSER_DIRECTORY_STAMP_HPP_
+
+#include <sequenceParser/common.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/cstdint.hpp>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Identity and modification times of a directory.
+ *
+ * The modification time of a directory changes when an entry is
+ * created, removed or renamed inside, so two equal stamps mean the same
+ * listing (with one stat instead of a full listing).
+ */
+struct DirectoryStamp
+{
+	DirectoryStamp()
+	: deviceId( 0 )
+	, inodeId( 0 )
+	, modificationTime( 0 )
+	, lastChangeTime( 0 )
+	{}
+
+	bool operator==( const DirectoryStamp& other ) const
+	{
+		return deviceId == other.deviceId &&
+		       inodeId == other.inodeId &&
+		       modificationTime == other.modificationTime &&
+		       lastChangeTime == other.lastChangeTime;
+	}
+
+	bool operator!=( const DirectoryStamp& other ) const
+	{
+		return !operator==( other );
+	}
+
+	/// @return if the directory was modified less than @p delay seconds before @p now
+	bool isRecent( const boost::int64_t now, const boost::int64_t delay ) const;
+
+	boost::uint64_t deviceId;
+	boost::uint64_t inodeId;
+	boost::int64_t modificationTime; ///< in nanoseconds
+	boost::int64_t lastChangeTime; ///< in nanoseconds
+};
+
+/**
+ * @brief Get the stamp of a directory.
+ * @return false if the directory can't be stat
+ */
+bool getDirectoryStamp( const boost::filesystem::path& directory, DirectoryStamp& outStamp );
+
+}
+}
+
+#endif
@@ -0,0 +1,296 @@
+#include "ExternalSort.hpp"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+#include <string>
+
+
+namespace sequenceParser {
+namespace detail {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/// Size of the buffer of each run file.
+static const std::size_t runBufferSize = 64 * 1024;
+
+bool isRecordBefore( const ExternalSort::Record& a, const ExternalSort::Record& b )
+{
+	const int keyOrder = a.key.compare( b.key );
+	if( keyOrder != 0 )
+		return keyOrder < 0;
+	return a.numbers < b.numbers;
+}
+
+/**
+ * @brief Write the records of a run, sorted by key.
+ *
+ * A record is written as: key '\0' numbers '\0' type,
+ * with an empty key if it's the key of the previous record
+ * (the key of a filename with numbers is never empty).
+ */
+class RunWriter
+{
+public:
+	explicit RunWriter( std::ostream& stream )
+	: _stream( stream )
+	{}
+
+	void write( const ExternalSort::Record& record )
+	{
+		if( record.key != _previousKey )
+		{
+			_stream.write( record.key.data(), record.key.size() );
+			_previousKey.assign( record.key.begin(), record.key.end() );
+		}
+		_stream.put( '\0' );
+		_stream.write( record.numbers.data(), record.numbers.size() );
+		_stream.put( '\0' );
+		_stream.put( char( record.type ) );
+	}
+
+private:
+	std::ostream& _stream;
+	std::string _previousKey;
+};
+
+}
+
+
+/**
+ * @brief Read the records of a run file, one by one.
+ */
+class ExternalSort::RunReader : boost::noncopyable
+{
+public:
+	explicit RunReader( const bfs::path& filepath )
+	: _buffer( runBufferSize )
+	{
+		_stream.rdbuf()->pubsetbuf( &_buffer[0], _buffer.size() );
+		_stream.open( filepath, std::ios::in | std::ios::binary );
+	}
+
+	bool isOpen() const { return _stream.is_open(); }
+
+	/// @return false at the end of the run
+	bool read()
+	{
+		if( ! std::getline( _stream, _nextKey, '\0' ) )
+			return false;
+		if( ! _nextKey.empty() )
+			_key.swap( _nextKey );
+		if( ! std::getline( _stream, _numbers, '\0' ) )
+			return false;
+		char type = 0;
+		if( ! _stream.get( type ) )
+			return false;
+		_record.key = _key;
+		_record.numbers = _numbers;
+		_record.type = EType( static_cast<unsigned char>( type ) );
+		return true;
+	}
+
+	const Record& getRecord() const { return _record; }
+
+private:
+	std::vector<char> _buffer;
+	bfs::ifstream _stream;
+	std::string _key;
+	std::string _nextKey;
+	std::string _numbers;
+	Record _record;
+};
+
+namespace {
+
+/// Order of the heap: the reader with the smallest record on top.
+bool isReaderAfter( const ExternalSort::RunReader* a, const ExternalSort::RunReader* b )
+{
+	return isRecordBefore( b->getRecord(), a->getRecord() );
+}
+
+}
+
+
+const std::size_t ExternalSort::defaultMinMemoryBudget;
+const std::size_t ExternalSort::defaultMaxMergedRuns;
+
+ExternalSort::ExternalSort(
+		const std::size_t memoryBudget,
+		const boost::filesystem::path& tmpDirectory,
+		const std::size_t minMemoryBudget,
+		const std::size_t maxMergedRuns )
+: _memoryBudget( std::max( memoryBudget, minMemoryBudget ) )
+, _tmpDirectory( tmpDirectory )
+, _maxMergedRuns( std::max( maxMergedRuns, std::size_t( 2 ) ) )
+, _nextRecord( 0 )
+, _nbRuns( 0 )
+, _nbMergedRuns( 0 )
+, _currentReader( NULL )
+{
+}
+
+ExternalSort::~ExternalSort()
+{
+	_readers.clear(); // close the files before removing them
+	BOOST_FOREACH( const bfs::path& runFile, _runFiles )
+	{
+		boost::system::error_code errorCode;
+		bfs::remove( runFile, errorCode );
+	}
+}
+
+std::size_t ExternalSort::getMemorySize() const
+{
+	return _arena.getNbBytes() + _records.size() * sizeof( Record );
+}
+
+bool ExternalSort::add( const boost::string_ref& key, const boost::string_ref& numbers, const EType type )
+{
+	Record record;
+	// the files of a group are often consecutive in the listing
+	if( ! _records.empty() && _records.back().key == key )
+		record.key = _records.back().key;
+	else
+		record.key = _arena.copy( key );
+	record.numbers = _arena.copy( numbers );
+	record.type = type;
+	_records.push_back( record );
+
+	if( getMemorySize() > _memoryBudget )
+		return writeRun();
+	return true;
+}
+
+bfs::path ExternalSort::newRunFile()
+{
+	const bfs::path runFile = _tmpDirectory / bfs::unique_path( "sequenceParser-%%%%-%%%%-%%%%-%%%%.run" );
+	_runFiles.push_back( runFile );
+	return runFile;
+}
+
+bool ExternalSort::writeRun()
+{
+	std::sort( _records.begin(), _records.end(), &isRecordBefore );
+
+	bfs::ofstream stream( newRunFile(), std::ios::out | std::ios::binary | std::ios::trunc );
+	RunWriter writer( stream );
+	BOOST_FOREACH( const Record& record, _records )
+	{
+		writer.write( record );
+	}
+	stream.close();
+	++_nbRuns;
+
+	std::vector<Record>().swap( _records );
+	_arena.release();
+	return ! stream.fail();
+}
+
+bool ExternalSort::openReaders( const std::size_t begin, const std::size_t end )
+{
+	_readers.clear();
+	_heap.clear();
+	_currentReader = NULL;
+	for( std::size_t i = begin; i < end; ++i )
+	{
+		_readers.push_back( new RunReader( _runFiles[i] ) );
+		RunReader& reader = _readers.back();
+		if( ! reader.isOpen() )
+			return false;
+		if( reader.read() )
+			_heap.push_back( &reader );
+	}
+	std::make_heap( _heap.begin(), _heap.end(), &isReaderAfter );
+	return true;
+}
+
+bool ExternalSort::mergeRuns( const std::size_t nbRuns )
+{
+	if( ! openReaders( 0, nbRuns ) )
+		return false;
+
+	const bfs::path runFile = newRunFile();
+	bfs::ofstream stream( runFile, std::ios::out | std::ios::binary | std::ios::trunc );
+	RunWriter writer( stream );
+	Record record;
+	while( nextFromReaders( record ) )
+	{
+		writer.write( record );
+	}
+	stream.close();
+	_readers.clear();
+	++_nbMergedRuns;
+
+	// the merged runs are not needed anymore
+	for( std::size_t i = 0; i < nbRuns; ++i )
+	{
+		boost::system::error_code errorCode;
+		bfs::remove( _runFiles[i], errorCode );
+	}
+	_runFiles.erase( _runFiles.begin(), _runFiles.begin() + nbRuns );
+	return ! stream.fail();
+}
+
+bool ExternalSort::finish()
+{
+	if( _runFiles.empty() )
+	{
+		// everything fits in memory
+		std::sort( _records.begin(), _records.end(), &isRecordBefore );
+		_nextRecord = 0;
+		return true;
+	}
+	if( ! _records.empty() && ! writeRun() )
+		return false;
+
+	// limit the number of files opened at once
+	while( _runFiles.size() > _maxMergedRuns )
+	{
+		if( ! mergeRuns( _maxMergedRuns ) )
+			return false;
+	}
+	return openReaders( 0, _runFiles.size() );
+}
+
+bool ExternalSort::nextFromReaders( Record& record )
+{
+	// the previous record is valid until now
+	if( _currentReader )
+	{
+		if( _currentReader->read() )
+		{
+			_heap.push_back( _currentReader );
+			std::push_heap( _heap.begin(), _heap.end(), &isReaderAfter );
+		}
+		_currentReader = NULL;
+	}
+	if( _heap.empty() )
+		return false;
+
+	std::pop_heap( _heap.begin(), _heap.end(), &isReaderAfter );
+	_currentReader = _heap.back();
+	_heap.pop_back();
+	record = _currentReader->getRecord();
+	return true;
+}
+
+bool ExternalSort::next( Record& record )
+{
+	if( _runFiles.empty() )
+	{
+		if( _nextRecord >= _records.size() )
+			return false;
+		record = _records[_nextRecord++];
+		return true;
+	}
+	return nextFromReaders( record );
+}
+
+
+}
+}
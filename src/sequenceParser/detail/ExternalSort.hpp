@@ -0,0 +1,115 @@
+#ifndef _SEQUENCE_PARSER_DETAIL_EXTERNAL_SORT_HPP_
+#define _SEQUENCE_PARSER_DETAIL_EXTERNAL_SORT_HPP_
+
+#include "Arena.hpp"
+
+#include <sequenceParser/common.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <vector>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Sort directory entries by key, with a bound on the memory used.
+ *
+ * An entry is the key of its group (the strings of the filename) and its
+ * numbers, the filename is rebuilt from both.
+ * The entries are kept in memory until the budget is reached, then they are
+ * sorted and written in a temporary file (a run), where the key is only
+ * written when it changes. At the end, the runs are merged to read all the
+ * entries in order, with several passes if there are too many runs to open
+ * them at once.
+ * Without any run written, everything stays in memory.
+ *
+ * The keys and numbers can't contain '\0' (like filenames).
+ */
+class ExternalSort : boost::noncopyable
+{
+public:
+	struct Record
+	{
+		boost::string_ref key;
+		boost::string_ref numbers;
+		EType type;
+	};
+
+	class RunReader;
+
+	/// Minimal memory of a run by default, to avoid a run file for each entry.
+	static const std::size_t defaultMinMemoryBudget = 256 * 1024;
+	/// Maximal number of runs merged at once by default (each one is an open file).
+	static const std::size_t defaultMaxMergedRuns = 64;
+
+public:
+	/**
+	 * @param[in] memoryBudget: maximal size of the entries kept in memory, in bytes
+	 * @param[in] tmpDirectory: directory of the temporary files
+	 * @param[in] minMemoryBudget: the memory budget is at least this size
+	 * @param[in] maxMergedRuns: maximal number of runs merged at once (at least 2)
+	 */
+	ExternalSort(
+		const std::size_t memoryBudget,
+		const boost::filesystem::path& tmpDirectory,
+		const std::size_t minMemoryBudget = defaultMinMemoryBudget,
+		const std::size_t maxMergedRuns = defaultMaxMergedRuns );
+	/// @brief Remove the temporary files.
+	~ExternalSort();
+
+	/// @return false if a temporary file can't be written
+	bool add( const boost::string_ref& key, const boost::string_ref& numbers, const EType type );
+
+	/**
+	 * @brief End of the entries, prepare the merge.
+	 * @return false if a temporary file can't be written or read
+	 */
+	bool finish();
+
+	/**
+	 * @brief Read the next entry, sorted by key and name.
+	 * @param[out] record: valid until the next call
+	 * @return false at the end
+	 */
+	bool next( Record& record );
+
+	/// @return number of runs written from the memory
+	std::size_t getNbRuns() const { return _nbRuns; }
+
+	/// @return number of runs written by merging other runs
+	std::size_t getNbMergedRuns() const { return _nbMergedRuns; }
+
+private:
+	std::size_t getMemorySize() const;
+	boost::filesystem::path newRunFile();
+	bool writeRun();
+	bool openReaders( const std::size_t begin, const std::size_t end );
+	bool mergeRuns( const std::size_t nbRuns );
+	bool nextFromReaders( Record& record );
+
+private:
+	std::size_t _memoryBudget;
+	boost::filesystem::path _tmpDirectory;
+	std::size_t _maxMergedRuns;
+
+	// current run, in memory
+	Arena _arena;
+	std::vector<Record> _records;
+	std::size_t _nextRecord; ///< read position, without any run on disk
+
+	std::size_t _nbRuns;
+	std::size_t _nbMergedRuns;
+	std::vector<boost::filesystem::path> _runFiles; ///< not merged yet
+	boost::ptr_vector<RunReader> _readers;
+	std::vector<RunReader*> _heap; ///< readers with a record, by their current record
+	RunReader* _currentReader; ///< reader of the last record returned, to advance
+};
+
+}
+}
+
+#endif
@@ -63,6 +63,20 @@ bool FileNumbers::SortByDigit::operator()( const FileNumbers& a, const FileNumbe
 	return false; // equals
 }
 
+void reorder( const FileNumbersVector::iterator& numberPartsBegin, std::vector<std::size_t>& positions )
+{
+	// follow the cycles of the permutation
+	for( std::size_t i = 0; i < positions.size(); ++i )
+	{
+		while( positions[i] != i )
+		{
+			const std::size_t p = positions[i];
+			swap( *(numberPartsBegin + i), *(numberPartsBegin + p) );
+			std::swap( positions[i], positions[p] );
+		}
+	}
+}
+
 std::ostream& operator<<(std::ostream& os, const FileNumbers& p)
 {
     os << "[";
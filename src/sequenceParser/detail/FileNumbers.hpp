@@ -3,6 +3,10 @@
 
 #include <sequenceParser/common.hpp>
 
+#include "Arena.hpp"
+#include "DigitScanner.hpp"
+
+#include <boost/utility/string_ref.hpp>
 #include <boost/regex.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/lambda/lambda.hpp>
@@ -18,41 +22,45 @@ namespace detail {
  * @brief Numbers inside a filename.
  * Each number can be a time inside a sequence.
  * Internal structures to detect sequence inside a directory
+ *
+ * The number strings are not copied, they reference the characters
+ * of the filename, which needs to outlive this object.
  */
 class FileNumbers
 {
 
 public:
 	typedef FileNumbers This;
-	typedef std::pair<Time, std::string> Pair;
-	typedef std::vector<Pair> Vec;
+	typedef std::pair<Time, boost::string_ref> Pair;
+	typedef std::vector<Pair, ArenaAllocator<Pair> > Vec;
 
 public:
 
-	FileNumbers()
+	/**
+	 * @param[in] arena: memory used by the numbers (standard heap if NULL)
+	 */
+	explicit FileNumbers( Arena* arena = NULL )
+	: _numbers( ArenaAllocator<Pair>( arena ) )
 	{
 		// we preverse reserve and take memory,
 		// that realloc and takes time.
 		_numbers.reserve( 10 );
 	}
 
+	/// @brief Copy the numbers, with the memory of another arena.
+	FileNumbers( const This& other, Arena* arena )
+	: _numbers( other._numbers.begin(), other._numbers.end(), ArenaAllocator<Pair>( arena ) )
+	{}
+
 public:
 
-	void push_back( const std::string& s )
+	void push_back( const boost::string_ref& s )
 	{
 		Time t;
-		try
-		{
-			t = boost::lexical_cast<Time > ( s );
+		// if the number can't be retrieved, it's probably
+		// out of range for Time type.
+		if( parseTime( s, t ) )
 			_numbers.push_back( Pair( t, s ) );
-		}
-		catch( ... )
-		{
-			// can't retrieve the number,
-			// the number inside the string is probably
-			// ouf of range for Time type.
-			t = 0;
-		}
 	}
 
 	void clear()
@@ -60,15 +68,20 @@ public:
 		_numbers.clear();
 	}
 
-	const std::string& getString( const std::size_t& i ) const
+	void swap( This& other )
+	{
+		_numbers.swap( other._numbers );
+	}
+
+	const boost::string_ref& getString( const std::size_t& i ) const
 	{
 		return _numbers[i].second;
 	}
 
 	
-	static bool hasSign( const std::string& s ) { return ( ( s[0] == '-' ) || ( s[0] == '+' ) ); }
+	static bool hasSign( const boost::string_ref& s ) { return ( ( s[0] == '-' ) || ( s[0] == '+' ) ); }
 	
-	static std::size_t extractPadding( const std::string& str )
+	static std::size_t extractPadding( const boost::string_ref& str )
 	{
 		if( str.size() == 1 )
 			return 0;
@@ -76,7 +89,7 @@ public:
 		return str[withSign] == '0' ? str.size()-withSign : 0;
 	}
 	
-	static std::size_t extractMaxPadding( const std::string& s )
+	static std::size_t extractMaxPadding( const boost::string_ref& s )
 	{
 		return s.size() - hasSign( s );
 	}
@@ -140,6 +153,22 @@ private:
 	Vec _numbers;
 };
 
+/// @brief Numbers of several filenames
+typedef std::vector<FileNumbers, ArenaAllocator<FileNumbers> > FileNumbersVector;
+
+/// @brief Allows std algorithms to reorder FileNumbers without copying the strings.
+inline void swap( FileNumbers& a, FileNumbers& b )
+{
+	a.swap( b );
+}
+
+/**
+ * @brief Move each FileNumbers of a range to its new position, in place.
+ * @param[in] numberPartsBegin beginning of the range
+ * @param[inout] positions new position of each element of the range (used as a buffer)
+ */
+void reorder( const FileNumbersVector::iterator& numberPartsBegin, std::vector<std::size_t>& positions );
+
 }
 }
 
@@ -0,0 +1,123 @@
+#include "FileNumbersColumns.hpp"
+
+#include <boost/algorithm/cxx11/is_sorted.hpp>
+
+#include <algorithm>
+
+namespace sequenceParser {
+namespace detail {
+
+
+FileNumbersColumns::FileNumbersColumns( const FileNumbersVector& numberParts )
+: _nbRows( numberParts.size() )
+, _nbColumns( numberParts.empty() ? 0 : numberParts.front().size() )
+{
+	_times.resize( _nbRows * _nbColumns );
+	_formats.resize( _nbRows * _nbColumns );
+	_paddings.resize( _nbRows * _nbColumns );
+
+	for( std::size_t row = 0; row < _nbRows; ++row )
+	{
+		const FileNumbers& numbers = numberParts[row];
+		BOOST_ASSERT( numbers.size() == _nbColumns );
+		for( std::size_t column = 0; column < _nbColumns; ++column )
+		{
+			const std::size_t i = column * _nbRows + row;
+			_times[i] = numbers.getTime( column );
+			_formats[i] = getFormat( numbers.getString( column ) );
+			_paddings[i] = numbers.getFixedPadding( column );
+		}
+	}
+}
+
+FileNumbersColumns::Format FileNumbersColumns::getFormat( const boost::string_ref& numberStr )
+{
+	// the number of characters can't exceed 5 bits (see decomposeFilename)
+	BOOST_ASSERT( numberStr.size() < 32 );
+	Format format = numberStr.size();
+	if( numberStr[0] == '+' )
+		format |= 32;
+	else if( numberStr[0] == '-' )
+		format |= 64;
+	return format;
+}
+
+bool FileNumbersColumns::isVarying( const std::size_t column ) const
+{
+	if( _nbRows == 0 )
+		return false;
+
+	const Time* times = &_times[column * _nbRows];
+	const Format* formats = &_formats[column * _nbRows];
+	const Time firstTime = times[0];
+	const Format firstFormat = formats[0];
+
+	// no early exit, so the compiler can vectorize the loop
+	bool varying = false;
+	for( std::size_t row = 1; row < _nbRows; ++row )
+	{
+		varying |= ( times[row] != firstTime ) | ( formats[row] != firstFormat );
+	}
+	return varying;
+}
+
+bool FileNumbersColumns::getVaryingNumber( std::ssize_t& index, const std::size_t rowA, const std::size_t rowB ) const
+{
+	bool foundOne = false;
+	for( std::size_t column = 0; column < _nbColumns; ++column )
+	{
+		if( ! equals( rowA, rowB, column ) )
+		{
+			if( foundOne )
+			{
+				index = -1;
+				return false; // more than one element founded
+			}
+			foundOne = true;
+			index = column;
+		}
+	}
+	if( !foundOne )
+		index = -1;
+	return foundOne; // we found one varying index
+}
+
+struct FileNumbersColumns::SortRowsByPadding
+{
+	SortRowsByPadding( const FileNumbersColumns& columns )
+	: _columns( columns )
+	{}
+
+	bool operator()( const std::size_t a, const std::size_t b ) const
+	{
+		for( std::size_t column = 0; column < _columns._nbColumns; ++column )
+		{
+			const std::size_t aPadding = _columns.getFixedPadding( a, column );
+			const std::size_t bPadding = _columns.getFixedPadding( b, column );
+			if( aPadding != bPadding )
+				return aPadding < bPadding;
+
+			const Time aTime = _columns.getTime( a, column );
+			const Time bTime = _columns.getTime( b, column );
+			if( aTime != bTime )
+				return aTime < bTime;
+		}
+		return false; // equals
+	}
+
+	const FileNumbersColumns& _columns;
+};
+
+std::vector<std::size_t> FileNumbersColumns::getRowsSortedByPadding() const
+{
+	std::vector<std::size_t> rows( _nbRows );
+	for( std::size_t row = 0; row < _nbRows; ++row )
+		rows[row] = row;
+	// the rows of sorted filenames are usually already sorted
+	if( ! boost::algorithm::is_sorted( rows.begin(), rows.end(), SortRowsByPadding( *this ) ) )
+		std::sort( rows.begin(), rows.end(), SortRowsByPadding( *this ) );
+	return rows;
+}
+
+}
+}
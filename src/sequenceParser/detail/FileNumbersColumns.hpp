@@ -0,0 +1,80 @@
+#ifndef _SEQUENCE_PARSER_FILE_NUMBERS_COLUMNS_HPP_
+#define _SEQUENCE_PARSER_FILE_NUMBERS_COLUMNS_HPP_
+
+#include "FileNumbers.hpp"
+
+#include <vector>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Numbers of all the filenames of a group (same FileStrings),
+ *        stored column by column as integers.
+ * Internal structures to detect sequence inside a directory.
+ *
+ * Two numbers are written the same way in the filenames if they have
+ * the same value and the same format (number of characters and sign),
+ * so the columns can be compared without any string comparison.
+ */
+class FileNumbersColumns
+{
+public:
+	typedef FileNumbersColumns This;
+	/// number of characters of the number, and its sign character
+	typedef unsigned char Format;
+
+public:
+	FileNumbersColumns( const FileNumbersVector& numberParts );
+
+public:
+	/// @return number of filenames
+	std::size_t getNbRows() const { return _nbRows; }
+
+	/// @return number of numbers inside each filename
+	std::size_t getNbColumns() const { return _nbColumns; }
+
+	Time getTime( const std::size_t row, const std::size_t column ) const { return _times[column * _nbRows + row]; }
+	std::size_t getFixedPadding( const std::size_t row, const std::size_t column ) const { return _paddings[column * _nbRows + row]; }
+
+	/// @return if the two numbers are written the same way in the filenames
+	bool equals( const std::size_t rowA, const std::size_t rowB, const std::size_t column ) const
+	{
+		const std::size_t a = column * _nbRows + rowA;
+		const std::size_t b = column * _nbRows + rowB;
+		return _times[a] == _times[b] && _formats[a] == _formats[b];
+	}
+
+	/// @return if the number at @p column is not written the same way in all the filenames
+	bool isVarying( const std::size_t column ) const;
+
+	/**
+	 * @brief Find the only number written differently in the two filenames.
+	 * @param[out] index: the varying number, -1 if there is none or more than one
+	 * @return if we found exactly one varying number
+	 */
+	bool getVaryingNumber( std::ssize_t& index, const std::size_t rowA, const std::size_t rowB ) const;
+
+	/**
+	 * @brief Rows order, sorted by padding then by number for each column
+	 *        (like FileNumbers::SortByPadding).
+	 */
+	std::vector<std::size_t> getRowsSortedByPadding() const;
+
+	static Format getFormat( const boost::string_ref& numberStr );
+
+private:
+	struct SortRowsByPadding;
+
+private:
+	std::size_t _nbRows;
+	std::size_t _nbColumns;
+	std::vector<Time> _times; ///< column-major values
+	std::vector<Format> _formats; ///< column-major formats
+	std::vector<unsigned char> _paddings; ///< column-major fixed paddings
+};
+
+}
+}
+
+#endif
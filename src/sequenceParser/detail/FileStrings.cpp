@@ -11,7 +11,8 @@ std::size_t FileStrings::getHash() const
 
 	BOOST_FOREACH( const Vec::value_type & i, _id )
 	{
-		boost::hash_combine( seed, i );
+		// same value as the hash of a std::string
+		boost::hash_combine( seed, boost::hash_range( i.begin(), i.end() ) );
 		boost::hash_combine( seed, 1 ); // not like the hash of the concatenation of _id
 	}
 	return seed;
@@ -1,6 +1,9 @@
 #ifndef _SEQUENCE_PARSER_FILE_STRINGS_HPP_
 #define _SEQUENCE_PARSER_FILE_STRINGS_HPP_
 
+#include "Arena.hpp"
+
+#include <boost/utility/string_ref.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
@@ -13,15 +16,29 @@ namespace detail {
 /**
  * @brief Unique identification for a sequence.
  * Internal structures to detect sequence inside a directory.
+ *
+ * The strings are not copied, they reference the characters
+ * of the filename, which needs to outlive this object.
  */
 class FileStrings
 {
 
 public:
 	typedef FileStrings This;
-	typedef std::vector<std::string> Vec;
+	typedef std::vector<boost::string_ref, ArenaAllocator<boost::string_ref> > Vec;
 
 public:
+	/**
+	 * @param[in] arena: memory used by the strings (standard heap if NULL)
+	 */
+	explicit FileStrings( Arena* arena = NULL )
+	: _id( ArenaAllocator<boost::string_ref>( arena ) )
+	{}
+
+	/// @brief Copy the strings references, with the memory of another arena.
+	FileStrings( const This& other, Arena* arena )
+	: _id( other._id.begin(), other._id.end(), ArenaAllocator<boost::string_ref>( arena ) )
+	{}
 
 	Vec& getId()
 	{
@@ -54,7 +71,7 @@ public:
 		return true;
 	}
 
-	const std::string& operator[]( const std::size_t i ) const
+	const boost::string_ref& operator[]( const std::size_t i ) const
 	{
 		return _id[i];
 	}
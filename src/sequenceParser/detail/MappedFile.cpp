@@ -0,0 +1,85 @@
+#include "MappedFile.hpp"
+
+#include <sequenceParser/system.hpp>
+
+#include <fstream>
+
+#ifdef __UNIX__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace sequenceParser {
+namespace detail {
+
+
+MappedFile::MappedFile()
+: _data( NULL )
+, _size( 0 )
+, _mapped( false )
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open( const std::string& filename )
+{
+	close();
+#ifdef __UNIX__
+	const int fd = ::open( filename.c_str(), O_RDONLY );
+	if( fd == -1 )
+		return false;
+	struct stat statInfos;
+	if( fstat( fd, &statInfos ) == -1 || statInfos.st_size == 0 )
+	{
+		::close( fd );
+		return false;
+	}
+	void* mapping = mmap( NULL, statInfos.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	// the mapping stays valid after closing the file
+	::close( fd );
+	if( mapping == MAP_FAILED )
+		return false;
+	_data = static_cast<const char*>( mapping );
+	_size = statInfos.st_size;
+	_mapped = true;
+#else
+	std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+	if( ! file )
+		return false;
+	file.seekg( 0, std::ios::end );
+	const std::streamoff fileSize = file.tellg();
+	if( fileSize <= 0 )
+		return false;
+	file.seekg( 0, std::ios::beg );
+	_buffer.resize( fileSize );
+	if( ! file.read( &_buffer[0], fileSize ) )
+	{
+		_buffer.clear();
+		return false;
+	}
+	_data = &_buffer[0];
+	_size = _buffer.size();
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef __UNIX__
+	if( _mapped )
+		munmap( const_cast<char*>( _data ), _size );
+#endif
+	std::vector<char>().swap( _buffer );
+	_data = NULL;
+	_size = 0;
+	_mapped = false;
+}
+
+}
+}
@@ -0,0 +1,41 @@
+#ifndef _SEQUENCE_PARSER_MAPPED_FILE_HPP_
+#define _SEQUENCE_PARSER_MAPPED_FILE_HPP_
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Read-only content of a file, mapped in memory.
+ * On systems without mmap, the file is read in memory.
+ */
+class MappedFile : boost::noncopyable
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	/// @return false if the file can't be read (the previous file is closed)
+	bool open( const std::string& filename );
+	void close();
+
+	bool isOpen() const { return _data != NULL; }
+	const char* data() const { return _data; }
+	std::size_t size() const { return _size; }
+
+private:
+	const char* _data;
+	std::size_t _size;
+	bool _mapped; ///< if the data are mapped, or in _buffer
+	std::vector<char> _buffer;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include "PaddingHistogram.hpp"
+
+#include <algorithm>
+
+namespace sequenceParser {
+namespace detail {
+
+
+void PaddingHistogram::reset( const std::size_t nbFiles )
+{
+	std::fill( _paddings, _paddings + size, 0 );
+	std::fill( _digits, _digits + size, 0 );
+	std::fill( _ambiguousDigits, _ambiguousDigits + size, 0 );
+
+	_paddingKeys.reserve( nbFiles );
+	_digitsKeys.reserve( nbFiles );
+}
+
+void PaddingHistogram::add( const FileNumbers& numbers, const std::size_t index )
+{
+	const std::size_t padding = numbers.getFixedPadding( index );
+	const std::size_t digits = numbers.getMaxPadding( index );
+	BOOST_ASSERT( padding < size && digits < size );
+
+	++_paddings[padding];
+	++_digits[digits];
+	if( padding == 0 )
+		++_ambiguousDigits[digits];
+
+	_paddingKeys.push_back( padding );
+	_digitsKeys.push_back( digits );
+}
+
+std::size_t PaddingHistogram::getNbPaddings() const
+{
+	return size - std::count( _paddings, _paddings + size, 0 );
+}
+
+std::size_t PaddingHistogram::getNbStrictPaddings() const
+{
+	return getNbPaddings() - hasPadding( 0 );
+}
+
+std::size_t PaddingHistogram::getFirstPadding( const std::size_t minPadding ) const
+{
+	return getFirstNonEmpty( _paddings, minPadding );
+}
+
+std::size_t PaddingHistogram::getFirstAmbiguousDigits() const
+{
+	return getFirstNonEmpty( _ambiguousDigits, 0 );
+}
+
+std::size_t PaddingHistogram::getFirstNonEmpty( const std::size_t* histogram, const std::size_t first )
+{
+	std::size_t k = first;
+	while( k < size && histogram[k] == 0 )
+		++k;
+	return k;
+}
+
+bool PaddingHistogram::hasAmbiguousDigitsWithoutPadding() const
+{
+	for( std::size_t digits = 0; digits < size; ++digits )
+	{
+		if( _ambiguousDigits[digits] && ! _paddings[digits] )
+			return true;
+	}
+	return false;
+}
+
+
+void partitionByKey(
+	const FileNumbersVector::iterator& numberPartsBegin,
+	const FileNumbersVector::iterator& numberPartsEnd,
+	const std::vector<unsigned char>& keys,
+	const std::size_t* histogram,
+	std::vector<std::size_t>& bucketSizes )
+{
+	const std::size_t nbFiles = keys.size();
+	BOOST_ASSERT( nbFiles == std::size_t( std::distance( numberPartsBegin, numberPartsEnd ) ) );
+
+	// start position of each bucket
+	std::size_t offsets[PaddingHistogram::size];
+	std::size_t offset = 0;
+	bucketSizes.clear();
+	for( std::size_t k = 0; k < PaddingHistogram::size; ++k )
+	{
+		offsets[k] = offset;
+		offset += histogram[k];
+		if( histogram[k] )
+			bucketSizes.push_back( histogram[k] );
+	}
+
+	// final position of each element (stable)
+	std::vector<std::size_t> positions( nbFiles );
+	for( std::size_t i = 0; i < nbFiles; ++i )
+	{
+		positions[i] = offsets[keys[i]]++;
+	}
+
+	reorder( numberPartsBegin, positions );
+
+	// sort each bucket by number
+	FileNumbersVector::iterator bucketBegin = numberPartsBegin;
+	BOOST_FOREACH( const std::size_t bucketSize, bucketSizes )
+	{
+		const FileNumbersVector::iterator bucketEnd = bucketBegin + bucketSize;
+		std::sort( bucketBegin, bucketEnd, FileNumbers::SortByNumber() );
+		bucketBegin = bucketEnd;
+	}
+}
+
+}
+}
@@ -0,0 +1,100 @@
+#ifndef _SEQUENCE_PARSER_PADDING_HISTOGRAM_HPP_
+#define _SEQUENCE_PARSER_PADDING_HISTOGRAM_HPP_
+
+#include "FileNumbers.hpp"
+
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Histograms of the paddings and number of digits used by one number
+ *        (at @p index) inside a group of filenames.
+ * Internal structures to detect sequence inside a directory.
+ *
+ * A number can't have more digits than decomposeFilename accepts,
+ * so small fixed-size arrays are enough to count them in a single pass.
+ * The padding and number of digits of each filename is kept,
+ * to partition the group afterwards without parsing the strings again.
+ */
+class PaddingHistogram
+{
+public:
+	typedef PaddingHistogram This;
+
+	/// Maximum number of digits (padding included) of a detected number, plus one.
+	static const std::size_t size = std::numeric_limits<std::size_t>::digits10 + 1;
+
+public:
+	/// @param[in] numberPartsBegin, numberPartsEnd: range of FileNumbers
+	template<class Iterator>
+	PaddingHistogram( const Iterator& numberPartsBegin, const Iterator& numberPartsEnd, const std::size_t index )
+	{
+		reset( std::distance( numberPartsBegin, numberPartsEnd ) );
+		for( Iterator it = numberPartsBegin; it != numberPartsEnd; ++it )
+		{
+			add( *it, index );
+		}
+	}
+
+public:
+	/// @return number of different paddings (0 included)
+	std::size_t getNbPaddings() const;
+
+	/// @return the smallest padding used, greater or equal to @p minPadding
+	std::size_t getFirstPadding( const std::size_t minPadding = 0 ) const;
+
+	/// @return the smallest number of digits of numbers without padding
+	std::size_t getFirstAmbiguousDigits() const;
+
+	/// @return number of different paddings (0 excluded)
+	std::size_t getNbStrictPaddings() const;
+
+	bool hasPadding( const std::size_t padding ) const { return _paddings[padding] != 0; }
+
+	/**
+	 * @return if there is a number without padding which has a number
+	 *         of digits not used as a padding by other numbers.
+	 */
+	bool hasAmbiguousDigitsWithoutPadding() const;
+
+	const std::size_t* getPaddingHistogram() const { return _paddings; }
+	const std::size_t* getDigitsHistogram() const { return _digits; }
+	const std::vector<unsigned char>& getPaddingKeys() const { return _paddingKeys; }
+	const std::vector<unsigned char>& getDigitsKeys() const { return _digitsKeys; }
+
+private:
+	void reset( const std::size_t nbFiles );
+	void add( const FileNumbers& numbers, const std::size_t index );
+
+	static std::size_t getFirstNonEmpty( const std::size_t* histogram, const std::size_t first );
+
+private:
+	std::size_t _paddings[size]; ///< number of files for each padding
+	std::size_t _digits[size]; ///< number of files for each number of digits
+	std::size_t _ambiguousDigits[size]; ///< number of files without padding for each number of digits
+	std::vector<unsigned char> _paddingKeys;
+	std::vector<unsigned char> _digitsKeys;
+};
+
+/**
+ * @brief Reorder the FileNumbers according to small integer keys, like a counting sort,
+ *        then sort each bucket by number.
+ * @param[in] keys the key of each element of the range, in the range order
+ * @param[in] histogram number of elements for each key value
+ * @param[out] bucketSizes size of each non-empty bucket, in order
+ */
+void partitionByKey(
+	const FileNumbersVector::iterator& numberPartsBegin,
+	const FileNumbersVector::iterator& numberPartsEnd,
+	const std::vector<unsigned char>& keys,
+	const std::size_t* histogram,
+	std::vector<std::size_t>& bucketSizes );
+
+}
+}
+
+#endif
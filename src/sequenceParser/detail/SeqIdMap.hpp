@@ -0,0 +1,49 @@
+#ifndef _SEQUENCE_PARSER_SEQ_ID_MAP_HPP_
+#define _SEQUENCE_PARSER_SEQ_ID_MAP_HPP_
+
+#include "Arena.hpp"
+#include "FileNumbers.hpp"
+#include "FileStrings.hpp"
+
+#include <sequenceParser/common.hpp>
+
+#include <boost/unordered_map.hpp>
+
+#include <vector>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief All the files of a directory which share the same FileStrings.
+ * Internal structures to detect sequence inside a directory.
+ */
+struct FileNumbersGroup
+{
+	/**
+	 * @param[in] arena: memory used by the group (standard heap if NULL)
+	 */
+	explicit FileNumbersGroup( Arena* arena = NULL )
+	: numbers( ArenaAllocator<FileNumbers>( arena ) )
+	, firstType( eTypeUndefined )
+	, types( eTypeUndefined )
+	{}
+
+	FileNumbersVector numbers; ///< numbers of each file
+	EType firstType; ///< type of the first file, known from the directory listing
+	EType types; ///< types of all the files, known from the directory listing
+};
+
+/**
+ * @brief Files of a directory grouped by FileStrings.
+ * All the nodes can be allocated in the Arena of the detection.
+ */
+typedef boost::unordered_map<
+		FileStrings, FileNumbersGroup, SeqIdHash, std::equal_to<FileStrings>,
+		ArenaAllocator<std::pair<const FileStrings, FileNumbersGroup> >
+	> SeqIdMap;
+
+}
+}
+
+#endif
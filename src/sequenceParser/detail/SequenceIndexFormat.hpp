@@ -0,0 +1,111 @@
+#ifndef _SEQUENCE_PARSER_SEQUENCE_INDEX_FORMAT_HPP_
+#define _SEQUENCE_PARSER_SEQUENCE_INDEX_FORMAT_HPP_
+
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+
+namespace sequenceParser {
+namespace detail {
+namespace index {
+
+/**
+ * Binary layout of a sequence index file.
+ * Internal structures of SequenceIndex.
+ *
+ * The file is used in place (memory mapped), so all the records have a fixed
+ * size and are aligned on 8 bytes, in the byte order of the machine which
+ * wrote the file (checked with Header::endianTag).
+ *
+ * Layout:
+ *   Header
+ *   DirectoryRecord[] sorted by path
+ *   EntryRecord[]     the entries of each directory are contiguous
+ *   RangeRecord[]     the ranges of each sequence are contiguous
+ *   StatRecord[]      one per entry, only with eFlagStats
+ *   names             characters of all the names (without separators),
+ *                     identical entry names are stored once
+ */
+
+static const char magic[8] = { 'S', 'E', 'Q', 'I', 'N', 'D', 'E', 'X' };
+static const boost::uint32_t version = 1;
+static const boost::uint32_t endianTag = 0x01020304;
+
+enum EFlags
+{
+	eFlagNone = 0,
+	eFlagStats = 1 ///< the file contains a StatRecord per entry
+};
+
+struct Section
+{
+	boost::uint64_t offset; ///< in bytes, from the beginning of the file
+	boost::uint64_t count; ///< number of records (or characters for the names)
+};
+
+struct Header
+{
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t endianTag;
+	boost::uint32_t detectOptions; ///< EDetection used to build the index
+	boost::uint32_t flags; ///< EFlags
+	boost::uint64_t fileSize;
+	boost::uint64_t rootNameOffset;
+	boost::uint64_t rootNameSize;
+	Section directories;
+	Section entries;
+	Section ranges;
+	Section stats;
+	Section names;
+};
+
+struct DirectoryRecord
+{
+	boost::uint64_t nameOffset; ///< absolute path of the directory
+	boost::uint64_t nameSize;
+	boost::uint64_t firstEntry;
+	boost::uint64_t nbEntries;
+	// DirectoryStamp of the directory when it was listed
+	boost::uint64_t deviceId;
+	boost::uint64_t inodeId;
+	boost::int64_t modificationTime;
+	boost::int64_t lastChangeTime;
+};
+
+struct EntryRecord
+{
+	boost::uint64_t nameOffset; ///< filename, or prefix followed by suffix for sequences
+	boost::uint32_t nameSize;
+	boost::uint32_t prefixSize; ///< only for sequences
+	boost::uint64_t firstRange; ///< only for sequences
+	boost::uint32_t nbRanges; ///< only for sequences
+	boost::uint8_t type; ///< EType
+	boost::uint8_t fixedPadding; ///< only for sequences
+	boost::uint8_t maxPadding; ///< only for sequences
+	boost::uint8_t reserved;
+};
+
+struct RangeRecord
+{
+	boost::int64_t first;
+	boost::int64_t last;
+	boost::int64_t step;
+};
+
+struct StatRecord
+{
+	boost::int64_t size; ///< total size of the files, in bytes
+	boost::int64_t modificationTime; ///< last modification of the files, -1 if unknown
+};
+
+BOOST_STATIC_ASSERT( sizeof( Header ) == 128 );
+BOOST_STATIC_ASSERT( sizeof( DirectoryRecord ) == 64 );
+BOOST_STATIC_ASSERT( sizeof( EntryRecord ) == 32 );
+BOOST_STATIC_ASSERT( sizeof( RangeRecord ) == 24 );
+BOOST_STATIC_ASSERT( sizeof( StatRecord ) == 16 );
+
+}
+}
+}
+
+#endif
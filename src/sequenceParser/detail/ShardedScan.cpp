@@ -0,0 +1,284 @@
+#include "ShardedScan.hpp"
+
+#include "analyze.hpp"
+#include "Arena.hpp"
+#include "FileNumbers.hpp"
+#include "FileStrings.hpp"
+#include "SeqIdMap.hpp"
+#include "listing.hpp"
+#include "materialize.hpp"
+#include "parallel.hpp"
+
+#include <sequenceParser/utils.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#include <algorithm>
+#include <new>
+
+
+namespace sequenceParser {
+namespace detail {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/// An entry of the directory listing.
+struct FileEntry
+{
+	FileEntry( const EType type, const boost::string_ref& filename )
+	: type( type )
+	, filename( filename )
+	{}
+
+	EType type;
+	boost::string_ref filename;
+};
+
+/// An entry with numbers, tokenized.
+struct TokenizedEntry
+{
+	explicit TokenizedEntry( Arena* arena )
+	: stringParts( arena )
+	, numberParts( arena )
+	, type( eTypeUndefined )
+	{}
+
+	FileStrings stringParts;
+	FileNumbers numberParts;
+	EType type;
+};
+
+/// Entries tokenized by one task.
+struct Batch
+{
+	Batch( const std::size_t begin, const std::size_t end )
+	: begin( begin )
+	, end( end )
+	{}
+
+	Arena arena; ///< memory of the tokenized entries
+	std::size_t begin;
+	std::size_t end;
+	std::vector<std::size_t> files; ///< entries without number
+	std::vector<const TokenizedEntry*> shards[ShardedScan::nbShards]; ///< entries with numbers of each shard
+};
+
+/// Groups of one shard.
+struct Shard
+{
+	Shard()
+	: groups( ( ArenaAllocator<SeqIdMap::value_type>( &arena ) ) )
+	{}
+
+	Arena arena; ///< memory of the groups
+	SeqIdMap groups;
+	BufferedOutput output;
+};
+
+}
+
+
+struct ShardedScan::Data
+{
+	Data( DirectorySource& source, const bfs::path& directory, const EDetection detectOptions, const std::size_t nbThreads )
+	: source( &source )
+	, directory( directory )
+	, detectOptions( detectOptions )
+	, nbThreads( getNbThreads( nbThreads ) )
+	, status( eBrowseStatusComplete )
+	{}
+
+	DirectorySource* source;
+	bfs::path directory;
+	EDetection detectOptions;
+	std::size_t nbThreads;
+	EBrowseStatus status;
+
+	Arena arena; ///< memory of the filenames
+	std::vector<FileEntry> entries; ///< in the listing order
+	boost::ptr_vector<Batch> batches;
+	boost::ptr_vector<Shard> shards;
+};
+
+
+ShardedScan::ShardedScan(
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters,
+		const std::size_t nbThreads,
+		const std::size_t minBatchSize,
+		const BrowseOptions* options )
+: _data( new Data( source, directory, detectOptions, nbThreads ) )
+{
+	if( options )
+	{
+		_data->status = options->getStatus();
+		if( _data->status != eBrowseStatusComplete )
+			return; // don't even list the directory
+	}
+
+	std::string tmpDir( directory.string() );
+	std::vector<std::string> tmpFilters( filters );
+	std::string filename;
+
+	if( ! detectDirectoryInResearch( source, tmpDir, tmpFilters, filename ) )
+		return;
+
+	const std::vector<boost::regex> reFilters = convertFilterToRegex( tmpFilters, detectOptions );
+
+	// the listing itself is sequential, the options are only polled by this thread
+	std::vector<DirectoryEntry> listing;
+	_data->status = listDirectory( source, directory, listing, options );
+	BOOST_FOREACH( const DirectoryEntry& entry, listing )
+	{
+		if( filepathRespectsAllFilters( directory / entry.filename, reFilters, filename, detectOptions ) )
+		{
+			_data->entries.push_back( FileEntry( entry.type, _data->arena.copy( entry.filename ) ) );
+		}
+	}
+	if( options && _data->status == eBrowseStatusComplete )
+		options->addDirectory();
+
+	// a few batches per thread, to balance the work
+	const std::size_t nbEntries = _data->entries.size();
+	const std::size_t batchSize = std::max( std::max( minBatchSize, std::size_t( 1 ) ), nbEntries / ( _data->nbThreads * 4 ) + 1 );
+	for( std::size_t begin = 0; begin < nbEntries; begin += batchSize )
+	{
+		_data->batches.push_back( new Batch( begin, std::min( begin + batchSize, nbEntries ) ) );
+	}
+	parallelFor( _data->batches.size(), _data->nbThreads, boost::bind( &ShardedScan::tokenizeBatch, this, _1 ) );
+
+	for( std::size_t i = 0; i < nbShards; ++i )
+	{
+		_data->shards.push_back( new Shard() );
+	}
+	parallelFor( nbShards, _data->nbThreads, boost::bind( &ShardedScan::groupShard, this, _1 ) );
+}
+
+ShardedScan::~ShardedScan()
+{}
+
+std::size_t ShardedScan::getNbBatches() const
+{
+	return _data->batches.size();
+}
+
+EBrowseStatus ShardedScan::getStatus() const
+{
+	return _data->status;
+}
+
+void ShardedScan::tokenizeBatch( const std::size_t batchIndex )
+{
+	Batch& batch = _data->batches[batchIndex];
+	Arena& arena = batch.arena;
+
+	TokenizedEntry* entry = NULL;
+	for( std::size_t i = batch.begin; i < batch.end; ++i )
+	{
+		if( entry )
+		{
+			// reuse the entry of a file without number
+			entry->stringParts.clear();
+			entry->numberParts.clear();
+		}
+		else
+		{
+			// all the memory of the entry is in the arena, it's never destroyed
+			entry = new( arena.allocate( sizeof( TokenizedEntry ), boost::alignment_of<TokenizedEntry>::value ) ) TokenizedEntry( &arena );
+		}
+
+		const FileEntry& file = _data->entries[i];
+		if( decomposeFilename( file.filename, entry->stringParts, entry->numberParts, _data->detectOptions ) )
+		{
+			entry->type = file.type;
+			batch.shards[entry->stringParts.getHash() % nbShards].push_back( entry );
+			entry = NULL;
+		}
+		else
+		{
+			batch.files.push_back( i );
+		}
+	}
+}
+
+void ShardedScan::groupShard( const std::size_t shardIndex )
+{
+	Shard& shard = _data->shards[shardIndex];
+	Arena& arena = shard.arena;
+	SeqIdMap& groups = shard.groups;
+
+	// the batches are in the listing order
+	BOOST_FOREACH( const Batch& batch, _data->batches )
+	{
+		BOOST_FOREACH( const TokenizedEntry* entry, batch.shards[shardIndex] )
+		{
+			// the tokens are copied with the memory of the shard,
+			// the arena of the batch is shared with the other shards
+			const SeqIdMap::iterator it( groups.find( entry->stringParts ) );
+			if( it != groups.end() )
+			{
+				it->second.numbers.push_back( FileNumbers( entry->numberParts, &arena ) );
+				it->second.types |= entry->type;
+			}
+			else
+			{
+				FileNumbersGroup group( &arena );
+				group.numbers.push_back( FileNumbers( entry->numberParts, &arena ) );
+				group.firstType = entry->type;
+				group.types = entry->type;
+				groups.insert( SeqIdMap::value_type( FileStrings( entry->stringParts, &arena ), group ) );
+			}
+		}
+	}
+}
+
+void ShardedScan::materializeShard( const std::size_t shardIndex )
+{
+	Shard& shard = _data->shards[shardIndex];
+	BOOST_FOREACH( SeqIdMap::value_type & p, shard.groups )
+	{
+		materializeGroup( shard.output, _data->directory, p.first, p.second, _data->detectOptions, _data->source );
+	}
+}
+
+template<class Output>
+void ShardedScan::materializeTo( Output& output )
+{
+	parallelFor( _data->shards.size(), _data->nbThreads, boost::bind( &ShardedScan::materializeShard, this, _1 ) );
+
+	BOOST_FOREACH( const Batch& batch, _data->batches )
+	{
+		BOOST_FOREACH( const std::size_t i, batch.files )
+		{
+			output.addFile( _data->entries[i].type, _data->entries[i].filename );
+		}
+	}
+	BOOST_FOREACH( Shard& shard, _data->shards )
+	{
+		shard.output.moveTo( output );
+	}
+}
+
+void ShardedScan::materialize( std::vector<Item>& outItems )
+{
+	outItems.clear();
+	ItemsOutput output( outItems, _data->directory );
+	materializeTo( output );
+}
+
+void ShardedScan::materialize( BrowseResult& outResult )
+{
+	outResult = BrowseResult( _data->directory );
+	materializeTo( outResult );
+}
+
+}
+}
@@ -0,0 +1,88 @@
+#ifndef _SEQUENCE_PARSER_DETAIL_SHARDED_SCAN_HPP_
+#define _SEQUENCE_PARSER_DETAIL_SHARDED_SCAN_HPP_
+
+#include <sequenceParser/common.hpp>
+#include <sequenceParser/BrowseOptions.hpp>
+#include <sequenceParser/BrowseResult.hpp>
+#include <sequenceParser/DirectorySource.hpp>
+#include <sequenceParser/Item.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief Scan of one directory with several threads.
+ *
+ * The directory is listed by the calling thread, then:
+ * - the filenames are tokenized by batches, on several threads,
+ * - the groups are split in shards by the hash of their FileStrings,
+ *   each shard is grouped and materialized by one thread.
+ * The number of shards doesn't depend on the number of threads, and each shard
+ * receives the filenames in the listing order: the output is the same with
+ * any number of threads.
+ */
+class ShardedScan : boost::noncopyable
+{
+public:
+	/// Number of shards of the groups.
+	static const std::size_t nbShards = 64;
+	/// Minimal number of entries tokenized by a task by default.
+	static const std::size_t defaultMinBatchSize = 4096;
+
+public:
+	/**
+	 * @brief List and group the content of the directory.
+	 * @param[in] source: where the directory is listed, it needs to outlive the scan
+	 * @param[in] nbThreads: 0 for the number of cores
+	 * @param[in] minBatchSize: minimal number of entries tokenized by a task
+	 * @param[in] options: polled while the directory is listed, NULL without any control
+	 */
+	ShardedScan(
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters,
+		const std::size_t nbThreads,
+		const std::size_t minBatchSize = defaultMinBatchSize,
+		const BrowseOptions* options = NULL );
+
+	~ShardedScan();
+
+	/**
+	 * @brief Build the files, sequences and directories, one thread per shard.
+	 * The files without number are first (in the listing order),
+	 * then the groups of each shard.
+	 */
+	void materialize( std::vector<Item>& outItems );
+	void materialize( BrowseResult& outResult );
+
+	/// @return number of batches of entries tokenized
+	std::size_t getNbBatches() const;
+
+	/// @return if the listing is complete, or has been stopped by the options (partial content)
+	EBrowseStatus getStatus() const;
+
+private:
+	template<class Output>
+	void materializeTo( Output& output );
+
+	void tokenizeBatch( const std::size_t batchIndex );
+	void groupShard( const std::size_t shardIndex );
+	void materializeShard( const std::size_t shardIndex );
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+}
+}
+
+#endif
@@ -1,9 +1,14 @@
 #include "analyze.hpp"
+#include "DigitScanner.hpp"
 
 #include "FileNumbers.hpp"
+#include "FileNumbersColumns.hpp"
 #include "FileStrings.hpp"
+#include "PaddingHistogram.hpp"
 
-#include <boost/regex.hpp>
+#include <sequenceParser/DirectorySource.hpp>
+
+#include <boost/algorithm/cxx11/is_sorted.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/foreach.hpp>
@@ -14,14 +19,26 @@
 namespace sequenceParser {
 
 using detail::FileNumbers;
+using detail::FileNumbersColumns;
+using detail::FileNumbersVector;
 using detail::FileStrings;
+using detail::findDigit;
+using detail::findNonDigit;
+using detail::PaddingHistogram;
+using detail::partitionByKey;
+using detail::reorder;
 namespace bfs = boost::filesystem;
 
 bool detectDirectoryInResearch( std::string& researchPath, std::vector<std::string>& filters, std::string& filename )
 {
-	if( bfs::exists( researchPath ) )
+	return detectDirectoryInResearch( getFilesystemDirectorySource(), researchPath, filters, filename );
+}
+
+bool detectDirectoryInResearch( DirectorySource& source, std::string& researchPath, std::vector<std::string>& filters, std::string& filename )
+{
+	if( source.exists( researchPath ) )
 	{
-		if( !bfs::is_directory( researchPath ) )
+		if( !source.isDirectory( researchPath ) )
 		{
 			// the researchPath is an existing file, we search into the parent directory with filtering these filename
 			// warning: can find a sequence based on a filename
@@ -46,7 +63,7 @@ bool detectDirectoryInResearch( std::string& researchPath, std::vector<std::stri
 			return true;
 		}
 		bfs::path parentPath( tmpPath.parent_path() );
-		if( !bfs::exists( parentPath ) )
+		if( !source.exists( parentPath ) )
 		{
 			// researchPath and it parent don't exists, could not find file/sequence/folder
 			return false;
@@ -60,48 +77,52 @@ bool detectDirectoryInResearch( std::string& researchPath, std::vector<std::stri
 }
 
 
-Sequence privateBuildSequence(
-		const Sequence& defaultSeq,
+inline void append( std::string& str, const boost::string_ref& part )
+{
+	str.append( part.data(), part.size() );
+}
+
+
+void privateBuildSequence(
+		Sequence& sequence,
 		const FileStrings& stringParts,
-		const std::vector<FileNumbers>::const_iterator& numberPartsBegin,
-		const std::vector<FileNumbers>::const_iterator& numberPartsEnd,
+		const FileNumbersVector::const_iterator& numberPartsBegin,
+		const FileNumbersVector::const_iterator& numberPartsEnd,
 		const std::size_t index,
 		const std::size_t padding,
 		const std::size_t maxPadding
 	)
 {
 	const std::size_t len = numberPartsBegin->size();
-	Sequence sequence( defaultSeq );
 
 	// fill information in the sequence...
 	for( std::size_t i = 0; i < index; ++i )
 	{
-		sequence._prefix += stringParts[i];
-		sequence._prefix += numberPartsBegin->getString( i );
+		append( sequence._prefix, stringParts[i] );
+		append( sequence._prefix, numberPartsBegin->getString( i ) );
 	}
-	sequence._prefix += stringParts[index];
+	append( sequence._prefix, stringParts[index] );
 	for( std::size_t i = index + 1; i < len; ++i )
 	{
-		sequence._suffix += stringParts[i];
-		sequence._suffix += numberPartsBegin->getString( i );
+		append( sequence._suffix, stringParts[i] );
+		append( sequence._suffix, numberPartsBegin->getString( i ) );
 	}
-	sequence._suffix += stringParts[len];
+	append( sequence._suffix, stringParts[len] );
 
-	std::vector<FileNumbers>::const_iterator numberPartsLast = numberPartsEnd;
+	FileNumbersVector::const_iterator numberPartsLast = numberPartsEnd;
 	--numberPartsLast;
 
 	// standard case, one sequence detected
 	std::vector<Time> times;
 	times.reserve(std::distance( numberPartsBegin, numberPartsEnd ));
-	for( std::vector<FileNumbers>::const_iterator it = numberPartsBegin; it != numberPartsEnd; ++it )
+	for( FileNumbersVector::const_iterator it = numberPartsBegin; it != numberPartsEnd; ++it )
 	{
 		times.push_back(it->getTime(index));
 	}
-	sequence._ranges = extractFrameRanges(times);
+	std::vector<FrameRange> ranges = extractFrameRanges(times);
+	sequence._ranges.swap( ranges );
 	sequence._fixedPadding = padding;
 	sequence._maxPadding = maxPadding;
-
-	return sequence;
 }
 
 /**
@@ -115,40 +136,27 @@ void privateBuildSequencesAccordingToPadding(
 	std::vector<Sequence>& result,
 	const Sequence& defaultSeq,
 	const FileStrings& stringParts,
-	const std::vector<FileNumbers>::iterator& numberPartsBegin,
-	const std::vector<FileNumbers>::iterator numberPartsEnd,
+	const FileNumbersVector::iterator& numberPartsBegin,
+	const FileNumbersVector::iterator numberPartsEnd,
 	const int index )
 {
-	std::set<std::size_t> paddings;
-	std::set<std::size_t> ambiguousMaxPaddings;
-	for( std::vector<FileNumbers>::const_iterator it = numberPartsBegin;
-	     it != numberPartsEnd;
-		 ++it )
-	{
-		const std::size_t padding  = it->getFixedPadding(index);
-		const std::size_t maxPadding = it->getMaxPadding(index);
-
-		paddings.insert( padding );
-
-		if( padding == 0 )
-		{
-			ambiguousMaxPaddings.insert( maxPadding );
-		}
-	}
+	const PaddingHistogram histogram( numberPartsBegin, numberPartsEnd, index );
 
-	if( paddings.size() == 1 )
+	if( histogram.getNbPaddings() == 1 )
 	{
 		// standard case: only one padding used in the sequence!
-		const std::size_t padding = *paddings.begin();
-		const std::size_t maxPadding = ( padding == 0 ? *ambiguousMaxPaddings.begin() : padding );
-		// simple sort
-		std::sort( numberPartsBegin, numberPartsEnd, FileNumbers::SortByNumber() );
-		result.push_back( privateBuildSequence( defaultSeq, stringParts, numberPartsBegin, numberPartsEnd, index, padding, maxPadding ) );
+		const std::size_t padding = histogram.getFirstPadding();
+		const std::size_t maxPadding = ( padding == 0 ? histogram.getFirstAmbiguousDigits() : padding );
+		// simple sort (nothing to do with sorted filenames of the same padding)
+		if( ! boost::algorithm::is_sorted( numberPartsBegin, numberPartsEnd, FileNumbers::SortByNumber() ) )
+			std::sort( numberPartsBegin, numberPartsEnd, FileNumbers::SortByNumber() );
+		result.push_back( defaultSeq );
+		privateBuildSequence( result.back(), stringParts, numberPartsBegin, numberPartsEnd, index, padding, maxPadding );
 		return;
 	}
 
 	bool onlyConsiderPadding = false;
-	if( paddings.find( 0 ) == paddings.end() )
+	if( ! histogram.hasPadding( 0 ) )
 	{
 		// No element without padding.
 		// All parts are prefixed by 0, only strict padding,
@@ -187,87 +195,51 @@ void privateBuildSequencesAccordingToPadding(
 		//	--------------------------------------------------------------------------------
 		//	|          YES             |   NO : sort by digits   |  NO : sort by padding   |
 		//	--------------------------------------------------------------------------------
-		onlyConsiderPadding = false;
-		BOOST_FOREACH( const std::size_t maxPadding, ambiguousMaxPaddings )
-		{
-			if( paddings.find( maxPadding ) == paddings.end() )
-			{
-				// if one digits from ambiguous digits doesn't correspond to
-				// a padding... we keep the whole sequence without padding.
-				onlyConsiderPadding = true;
-				break;
-			}
-		}
+		// if one digits from ambiguous digits doesn't correspond to
+		// a padding... we keep the whole sequence without padding.
+		onlyConsiderPadding = histogram.hasAmbiguousDigitsWithoutPadding();
 	}
 
+	// the keys are already known, so split with a counting sort
+	// and only sort by number inside each group
+	std::vector<std::size_t> groupSizes;
+
 	if( onlyConsiderPadding )
 	{
 		//std::cout << "Detector onlyConsiderPadding: " << __LINE__ << std::endl;
-		// sort by padding
-		std::sort( numberPartsBegin, numberPartsEnd, FileNumbers::SortByPadding() );
-		// split when the padding changed
-		std::vector<FileNumbers>::const_iterator first = numberPartsBegin;
-		for( std::vector<FileNumbers>::const_iterator it = boost::next(first); it != numberPartsEnd; ++it )
+		// split by padding
+		partitionByKey( numberPartsBegin, numberPartsEnd, histogram.getPaddingKeys(), histogram.getPaddingHistogram(), groupSizes );
+		FileNumbersVector::const_iterator first = numberPartsBegin;
+		BOOST_FOREACH( const std::size_t groupSize, groupSizes )
 		{
-			if( first->getFixedPadding(index) != it->getFixedPadding(index) )
-			{
-				const std::size_t p = first->getFixedPadding(index);
-				result.push_back( privateBuildSequence( defaultSeq, stringParts, first, it, index, p, first->getMaxPadding(index) ) );
-				first = it;
-			}
+			const FileNumbersVector::const_iterator last = first + groupSize;
+			const std::size_t p = first->getFixedPadding(index);
+			result.push_back( defaultSeq );
+			privateBuildSequence( result.back(), stringParts, first, last, index, p, first->getMaxPadding(index) );
+			first = last;
 		}
-		const std::size_t p = first->getFixedPadding(index);
-		result.push_back( privateBuildSequence( defaultSeq, stringParts, first, numberPartsEnd, index, p, first->getMaxPadding(index) ) );
-		return;
 	}
 	else
 	{
 		//std::cout << "Detector onlyConsiderDigits: " << __LINE__ << std::endl;
-		// sort by digits
-		std::sort( numberPartsBegin, numberPartsEnd, FileNumbers::SortByDigit() );
-		// split when the number of digits changed
-		std::vector<FileNumbers>::const_iterator first = numberPartsBegin;
-		for( std::vector<FileNumbers>::const_iterator it = boost::next(numberPartsBegin); it != numberPartsEnd; ++it )
+		// split by number of digits
+		partitionByKey( numberPartsBegin, numberPartsEnd, histogram.getDigitsKeys(), histogram.getDigitsHistogram(), groupSizes );
+		FileNumbersVector::const_iterator first = numberPartsBegin;
+		for( std::size_t i = 0; i < groupSizes.size(); ++i )
 		{
-			if( first->getMaxPadding(index) != it->getMaxPadding(index) )
-			{
-				const std::size_t p = boost::prior(it)->getFixedPadding(index);
-				const std::size_t pStart = first->getFixedPadding(index);
-				result.push_back( privateBuildSequence( defaultSeq, stringParts, first, it, index, pStart, first->getMaxPadding(index) ) );
-				first = it;
-			}
+			const FileNumbersVector::const_iterator last = first + groupSizes[i];
+			const std::size_t pStart = first->getFixedPadding(index);
+			// the last group keeps its fixed padding as max padding
+			const std::size_t maxPadding = ( i + 1 == groupSizes.size() ) ? pStart : first->getMaxPadding(index);
+			result.push_back( defaultSeq );
+			privateBuildSequence( result.back(), stringParts, first, last, index, pStart, maxPadding );
+			first = last;
 		}
-		const std::size_t p = boost::prior(numberPartsEnd)->getFixedPadding(index);
-		const std::size_t pStart = first->getFixedPadding(index);
-		result.push_back( privateBuildSequence( defaultSeq, stringParts, first, numberPartsEnd, index, pStart, first->getFixedPadding(index) ) );
-		return;
 	}
 }
 
 
-bool getVaryingNumber( std::ssize_t& index, const FileNumbers& a, const FileNumbers& b )
-{
-	BOOST_ASSERT( a.size() == b.size() );
-	bool foundOne = false;
-	for( std::size_t i = 0; i < a.size(); ++i )
-	{
-		if( a.getString(i) != b.getString(i) )
-		{
-			if( foundOne )
-			{
-				index = -1;
-				return false; // more than one element founded
-			}
-			foundOne = true;
-			index = i;
-		}
-	}
-	if( !foundOne )
-		index = -1;
-	return foundOne; // we found one varying index
-}
-
-std::vector<Sequence> buildSequences( const boost::filesystem::path& directory, const FileStrings& stringParts, std::vector<FileNumbers>& numberParts, const EDetection detectOptions )
+std::vector<Sequence> buildSequences( const boost::filesystem::path& directory, const FileStrings& stringParts, FileNumbersVector& numberParts, const EDetection detectOptions )
 {
 	Sequence defaultSeq;
 
@@ -287,19 +259,12 @@ std::vector<Sequence> buildSequences( const boost::filesystem::path& directory,
 	// detect which part is the sequence number
 	// for the moment, accept only one sequence
 	// but we can easily support multi-sequences
+	const FileNumbersColumns columns( numberParts );
 	std::vector<std::size_t> allIndex; // vector of indices (with 0 < index < len) with value changes
 	for( std::size_t i = 0; i < len; ++i )
 	{
-		const std::string t = numberParts.front().getString( i );
-
-		BOOST_FOREACH( const FileNumbers& sn, numberParts )
-		{
-			if( sn.getString( i ) != t )
-			{
-				allIndex.push_back( i );
-				break;
-			}
-		}
+		if( columns.isVarying( i ) )
+			allIndex.push_back( i );
 	}
 	
 	//std::cout << "allIndex.size(): " << allIndex.size() << std::endl;
@@ -324,11 +289,19 @@ std::vector<Sequence> buildSequences( const boost::filesystem::path& directory,
 	// 1 5 6
 	// 1 5 7
 	
-	std::sort( numberParts.begin(), numberParts.end(), FileNumbers::SortByPadding() );
+	// sort on the integer columns,
+	// then move the FileNumbers in the same order
+	const std::vector<std::size_t> sortedRows = columns.getRowsSortedByPadding();
+	{
+		std::vector<std::size_t> positions( sortedRows.size() );
+		for( std::size_t i = 0; i < sortedRows.size(); ++i )
+			positions[sortedRows[i]] = i;
+		reorder( numberParts.begin(), positions );
+	}
 
-	std::vector<FileNumbers>::iterator first = numberParts.begin();
-	std::vector<FileNumbers>::iterator it = boost::next(first);
-	std::vector<FileNumbers>::iterator itEnd = numberParts.end();
+	FileNumbersVector::iterator first = numberParts.begin();
+	FileNumbersVector::iterator it = boost::next(first);
+	FileNumbersVector::iterator itEnd = numberParts.end();
 	std::ssize_t previousIndex = -1;
 	std::ssize_t index = -1;
 	bool split = false;
@@ -338,7 +311,9 @@ std::vector<Sequence> buildSequences( const boost::filesystem::path& directory,
 		//std::cout << "________________________________________" <<  std::endl;
 		//std::cout << "first: " << *first <<  std::endl;
 		//std::cout << "it: " << *it <<  std::endl;
-		if( getVaryingNumber( index, *first, *it ) )
+		const std::size_t firstRow = sortedRows[first - numberParts.begin()];
+		const std::size_t itRow = sortedRows[it - numberParts.begin()];
+		if( columns.getVaryingNumber( index, firstRow, itRow ) )
 		{
 			if( previousIndex != -1 && // we previously have a sequence and
 			    index != previousIndex ) // the index is not the same than previous: split!
@@ -376,43 +351,52 @@ std::vector<Sequence> buildSequences( const boost::filesystem::path& directory,
 	return result;
 }
 
-std::size_t decomposeFilename( const std::string& filename, FileStrings& stringParts, FileNumbers& numberParts, const EDetection& options )
+std::size_t decomposeFilename( const boost::string_ref& filename, FileStrings& stringParts, FileNumbers& numberParts, const EDetection& options )
 {
+	// a number is a run of digits, with an optional sign just before it
+	// (same as the regex "[\+\-]?+\d{1,max}", with max digits per number)
 	static const std::size_t max = std::numeric_limits<std::size_t>::digits10;
-	std::string regex;
-	if( options & eDetectionNegative )
-	{
-		regex = "[\\+\\-]?+\\d{1," + boost::lexical_cast<std::string>( max ) + "}";
-	}
-	else
-	{
-		regex = "\\d{1," + boost::lexical_cast<std::string>( max ) + "}";
-	}
-	const boost::regex re( regex );
-	static const int subs[] = { -1, 0 }; // get before match and current match
-	boost::sregex_token_iterator m( filename.begin(), filename.end(), re, subs );
-	boost::sregex_token_iterator end;
+	const bool withSign = options & eDetectionNegative;
 
-//	std::cout << "________________________________________" << std::endl;
-//	std::cout << "filename: " << filename << std::endl;
-//	std::cout << "regex: " << regex << std::endl;
-	while( m != end )
+	const char* const end = filename.end();
+	const char* stringBegin = filename.begin(); // after the previous number
+	for( ;; )
 	{
+		const char* numberBegin = findDigit( stringBegin, end );
+		if( numberBegin == end )
+			break;
+		const char* numberEnd = findNonDigit( numberBegin, end );
+		if( std::size_t( numberEnd - numberBegin ) > max )
+			numberEnd = numberBegin + max; // the next digits are another number
+		if( withSign && numberBegin != stringBegin && FileNumbers::hasSign( boost::string_ref( numberBegin - 1, 1 ) ) )
+			--numberBegin;
+
 		// begin with string id, can be an empty string if str begins with a number
-//		std::cout << "stringPart: " << *m << std::endl;
-		stringParts.getId().push_back( *m++ );
-		if( m != end ) // if end with a string and not a number
-		{
-//			std::cout << "numberPart: " << *m << std::endl;
-			numberParts.push_back( *m++ );
-		}
+		stringParts.getId().push_back( boost::string_ref( stringBegin, numberBegin - stringBegin ) );
+		numberParts.push_back( boost::string_ref( numberBegin, numberEnd - numberBegin ) );
+		stringBegin = numberEnd;
+	}
+	if( stringBegin != end ) // if end with a string and not a number
+	{
+		stringParts.getId().push_back( boost::string_ref( stringBegin, end - stringBegin ) );
 	}
 	if( stringParts.getId().size() == numberParts.size() )
 	{
-		stringParts.getId().push_back( "" ); // we end with an empty string
+		stringParts.getId().push_back( boost::string_ref() ); // we end with an empty string
 	}
-	//std::cout << numberParts.size() << std::endl;
 	return numberParts.size();
 }
 
+std::string recomposeFilename( const FileStrings& stringParts, const FileNumbers& numberParts )
+{
+	std::string filename;
+	for( std::size_t i = 0; i < numberParts.size(); ++i )
+	{
+		append( filename, stringParts[i] );
+		append( filename, numberParts.getString( i ) );
+	}
+	append( filename, stringParts[numberParts.size()] );
+	return filename;
+}
+
 }
@@ -3,7 +3,9 @@
 
 #include <sequenceParser/common.hpp>
 #include <sequenceParser/Sequence.hpp>
+#include "FileNumbers.hpp"
 
+#include <boost/utility/string_ref.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -12,11 +14,23 @@
 
 namespace sequenceParser {
 
+class DirectorySource;
+
 namespace detail {
 class FileStrings;
-class FileNumbers;
 }
 
+/**
+ * @brief Extract step from a sorted range of FileNumbers (number at index @p i).
+ */
+std::size_t extractStep( const detail::FileNumbersVector::const_iterator& timesBegin, const detail::FileNumbersVector::const_iterator& timesEnd, const std::size_t i );
+
+/**
+ * @brief Extract the padding from a range of FileNumbers (number at index @p i).
+ * @return 0 if the numbers have several paddings
+ */
+std::size_t extractPadding( const detail::FileNumbersVector::const_iterator& timesBegin, const detail::FileNumbersVector::const_iterator& timesEnd, const std::size_t i );
+
 /**
  * Detect if the researchPath is a correct pattern ( a folder, a file or a pattern with a valid parent directory )
  *
@@ -27,12 +41,21 @@ class FileNumbers;
  */
 bool detectDirectoryInResearch( std::string& researchPath, std::vector<std::string>& filters, std::string &filename );
 
+/**
+ * @brief Same as detectDirectoryInResearch, with the directories of another source.
+ */
+bool detectDirectoryInResearch( DirectorySource& source, std::string& researchPath, std::vector<std::string>& filters, std::string &filename );
+
 
-Sequence privateBuildSequence(
-		const Sequence& defaultSeq,
+/**
+ * @brief Fill @p sequence (built in its final place, to avoid copies)
+ *        with the files of a range of FileNumbers.
+ */
+void privateBuildSequence(
+		Sequence& sequence,
 		const detail::FileStrings& stringParts,
-		const std::vector<detail::FileNumbers>::const_iterator& numberPartsBegin,
-		const std::vector<detail::FileNumbers>::const_iterator& numberPartsEnd,
+		const detail::FileNumbersVector::const_iterator& numberPartsBegin,
+		const detail::FileNumbersVector::const_iterator& numberPartsEnd,
 		const std::size_t index,
 		const std::size_t padding,
 		const std::size_t maxPadding
@@ -43,8 +66,8 @@ void privateBuildSequencesAccordingToPadding(
 	std::vector<Sequence>& result,
 	const Sequence& defaultSeq,
 	const detail::FileStrings& stringParts,
-	const std::vector<detail::FileNumbers>::iterator& numberPartsBegin,
-	const std::vector<detail::FileNumbers>::iterator numberPartsEnd,
+	const detail::FileNumbersVector::iterator& numberPartsBegin,
+	const detail::FileNumbersVector::iterator numberPartsEnd,
 	const int index );
 
 
@@ -59,7 +82,7 @@ void privateBuildSequencesAccordingToPadding(
  *          so there is no reason to create a copy.
  * @return a sequence object with all informations
  */
-std::vector<Sequence> buildSequences( const boost::filesystem::path& directory, const detail::FileStrings& stringParts, std::vector<detail::FileNumbers>& numberParts, const EDetection detectOptions );
+std::vector<Sequence> buildSequences( const boost::filesystem::path& directory, const detail::FileStrings& stringParts, detail::FileNumbersVector& numberParts, const EDetection detectOptions );
 
 /**
  * @brief Extract number and string parts from a filename.
@@ -74,9 +97,16 @@ std::vector<Sequence> buildSequences( const boost::filesystem::path& directory,
  * @param[out] stringParts vector of strings
  * @param[out] numberParts vector of integers
  * 
+ * @warning The parts reference the characters of @p filename, without copy.
  * @return number of decteted numbers
  */
-std::size_t decomposeFilename( const std::string& filename, detail::FileStrings& stringParts, detail::FileNumbers& numberParts, const EDetection& options );
+std::size_t decomposeFilename( const boost::string_ref& filename, detail::FileStrings& stringParts, detail::FileNumbers& numberParts, const EDetection& options );
+
+/**
+ * @brief Rebuild the original filename from its string and number parts.
+ * @see decomposeFilename
+ */
+std::string recomposeFilename( const detail::FileStrings& stringParts, const detail::FileNumbers& numberParts );
 
 }
 
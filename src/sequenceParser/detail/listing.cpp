@@ -0,0 +1,66 @@
+#include "listing.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+
+namespace sequenceParser {
+namespace detail {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/**
+ * @brief Stop the listing of a directory with the browse options.
+ */
+class ListingControl : public DirectoryListingControl
+{
+public:
+	explicit ListingControl( const BrowseOptions& options )
+	: options( options )
+	, status( eBrowseStatusComplete )
+	{}
+
+	bool onEntry()
+	{
+		status = options.addEntries();
+		return status == eBrowseStatusComplete;
+	}
+
+	const BrowseOptions& options;
+	EBrowseStatus status;
+};
+
+}
+
+EBrowseStatus listDirectory(
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		std::vector<DirectoryEntry>& outEntries,
+		const BrowseOptions* options )
+{
+	EBrowseStatus status = eBrowseStatusComplete;
+	bool listed;
+	if( options )
+	{
+		ListingControl control( *options );
+		listed = source.listDirectory( directory, outEntries, control );
+		status = control.status;
+	}
+	else
+	{
+		listed = source.listDirectory( directory, outEntries );
+	}
+	if( ! listed )
+	{
+		namespace errc = boost::system::errc;
+		const errc::errc_t error = ! source.exists( directory ) ? errc::no_such_file_or_directory
+			: ! source.isDirectory( directory ) ? errc::not_a_directory
+			: errc::permission_denied;
+		throw bfs::filesystem_error( "sequenceParser: can't list the directory", directory, errc::make_error_code( error ) );
+	}
+	return status;
+}
+
+}
+}
@@ -0,0 +1,31 @@
+#ifndef _SEQUENCE_PARSER_DETAIL_LISTING_HPP_
+#define _SEQUENCE_PARSER_DETAIL_LISTING_HPP_
+
+#include <sequenceParser/common.hpp>
+#include <sequenceParser/BrowseOptions.hpp>
+#include <sequenceParser/DirectorySource.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <vector>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @brief List a directory of the browse, the options are polled after each entry.
+ * @param[in] options: NULL without any control
+ * @return the status of the options: only the first entries are listed if it's not complete
+ * @throw boost::filesystem::filesystem_error if the directory can't be listed,
+ *        with the same error as a directory_iterator on the filesystem
+ */
+EBrowseStatus listDirectory(
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		std::vector<DirectoryEntry>& outEntries,
+		const BrowseOptions* options );
+
+}
+}
+
+#endif
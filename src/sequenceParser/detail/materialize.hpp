@@ -0,0 +1,198 @@
+#ifndef _SEQUENCE_PARSER_DETAIL_MATERIALIZE_HPP_
+#define _SEQUENCE_PARSER_DETAIL_MATERIALIZE_HPP_
+
+#include "analyze.hpp"
+#include "FileNumbers.hpp"
+#include "FileStrings.hpp"
+#include "SeqIdMap.hpp"
+
+#include <sequenceParser/DirectorySource.hpp>
+#include <sequenceParser/Item.hpp>
+#include <sequenceParser/Sequence.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/move/utility.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <vector>
+
+namespace sequenceParser {
+namespace detail {
+
+inline bool isConsideredAsSingleFile( const Sequence& s, const EDetection detectOptions )
+{
+	return (detectOptions & eDetectionSequenceNeedAtLeastTwoFiles) && (s.getNbFiles() == 1);
+}
+
+/**
+ * @brief Browse output as a vector of Items.
+ */
+class ItemsOutput
+{
+public:
+	ItemsOutput( std::vector<Item>& items, const boost::filesystem::path& directory )
+	: _items( items )
+	, _directory( directory )
+	{}
+
+	void addFile( const EType type, const boost::string_ref& filename )
+	{
+		_items.push_back( Item( type, _directory / boost::filesystem::path( filename.begin(), filename.end() ) ) );
+	}
+
+	void addSequence( Sequence& sequence )
+	{
+		_items.push_back( Item( boost::move( sequence ), _directory ) );
+	}
+
+private:
+	std::vector<Item>& _items;
+	const boost::filesystem::path& _directory;
+};
+
+/**
+ * @brief Browse output kept aside, to be added to another output later
+ *        (in the same order).
+ */
+class BufferedOutput
+{
+public:
+	void addFile( const EType type, const boost::string_ref& filename )
+	{
+		_entries.push_back( Entry( type, _files.size() ) );
+		_files.push_back( std::string( filename.begin(), filename.end() ) );
+	}
+
+	void addSequence( Sequence& sequence )
+	{
+		_entries.push_back( Entry( eTypeSequence, _sequences.size() ) );
+		_sequences.push_back( boost::move( sequence ) );
+	}
+
+	/// @brief Add all the entries to @p output, the sequences are moved.
+	template<class Output>
+	void moveTo( Output& output )
+	{
+		BOOST_FOREACH( const Entry& entry, _entries )
+		{
+			if( entry.first == eTypeSequence )
+				output.addSequence( _sequences[entry.second] );
+			else
+				output.addFile( entry.first, _files[entry.second] );
+		}
+		_entries.clear();
+		_files.clear();
+		_sequences.clear();
+	}
+
+private:
+	typedef std::pair<EType, std::size_t> Entry; ///< type and index in the files or sequences
+	std::vector<Entry> _entries;
+	std::vector<std::string> _files;
+	std::vector<Sequence> _sequences;
+};
+
+/**
+ * @brief Add a detected sequence to the output: as a sequence, as sequences
+ *        without holes or as a single file, depending on the detect options.
+ * @param[in] source: where the types of the entries are checked,
+ *                    NULL to build the sequence from names only
+ * @param[in] onlyRegularFiles: the listing says there is no directory in the sequence
+ */
+template<class Output>
+void materializeSequence(
+		Output& output,
+		const boost::filesystem::path& directory,
+		Sequence& s,
+		const EDetection detectOptions,
+		DirectorySource* source,
+		const bool onlyRegularFiles )
+{
+	if( ! onlyRegularFiles && source->isDirectory( directory / s.getFirstFilename() ) )
+	{
+		// It's a sequence of directories, so it's not a sequence.
+		BOOST_FOREACH( Time t, s.getFramesIterable() )
+		{
+			output.addFile( eTypeFolder, s.getFilenameAt(t) );
+		}
+	}
+	else
+	{
+		// if it's a sequence of 1 file, it could be considered as a sequence or as a single file
+		if( isConsideredAsSingleFile( s, detectOptions ) )
+		{
+			const std::string firstFilename = s.getFirstFilename();
+			output.addFile( source ? source->getType( directory / firstFilename ) : eTypeFile, firstFilename );
+		}
+		else
+		{
+			// if it's a sequence with holes, it could be split in several sequences depending on the detect options
+			if( (detectOptions & eDetectionSequenceWithoutHoles) && (s.getFrameRanges().size() > 1) )
+			{
+				BOOST_FOREACH( FrameRange f, s.getFrameRanges() )
+				{
+					Sequence sequenceWithoutHoles( s.getPrefix(), s.getFixedPadding(), s.getMaxPadding(), s.getSuffix(), f.first, f.last, f.step );
+					if( isConsideredAsSingleFile( sequenceWithoutHoles, detectOptions ) )
+					{
+						const std::string firstFilename = sequenceWithoutHoles.getFirstFilename();
+						output.addFile( source ? source->getType( directory / firstFilename ) : eTypeFile, firstFilename );
+					}
+					else
+					{
+						output.addSequence( sequenceWithoutHoles );
+					}
+				}
+			}
+			else
+			{
+				output.addSequence( s );
+			}
+		}
+	}
+}
+
+/**
+ * @brief Build the files, sequences and directories of a group of files
+ *        (same FileStrings) and add them to the output.
+ * @param[out] output: has to provide addFile( EType, string_ref ) and addSequence( Sequence& )
+ * @param[inout] group: the numbers are sorted in place
+ * @param[in] source: where the types of the entries are checked,
+ *                    NULL to build the group from names only
+ *                    (all the files are considered as regular files)
+ */
+template<class Output>
+void materializeGroup(
+		Output& output,
+		const boost::filesystem::path& directory,
+		const FileStrings& stringParts,
+		FileNumbersGroup& group,
+		const EDetection detectOptions,
+		DirectorySource* source = &getFilesystemDirectorySource() )
+{
+	// a file alone is not a sequence, use the type from the directory listing
+	// (links are resolved below, a link to a directory is a folder)
+	if( ( detectOptions & eDetectionSequenceNeedAtLeastTwoFiles ) &&
+	    group.numbers.size() == 1 &&
+	    group.firstType != eTypeLink )
+	{
+		output.addFile( group.firstType, recomposeFilename( stringParts, group.numbers.front() ) );
+		return;
+	}
+
+	// the sequences are moved into the output
+	std::vector<Sequence> ss = buildSequences( directory, stringParts, group.numbers, detectOptions );
+
+	// without any folder or link in the group, the listing says there is no directory
+	const bool onlyRegularFiles = ! source || ( group.types == eTypeFile );
+
+	BOOST_FOREACH( std::vector<Sequence>::value_type & s, ss )
+	{
+		materializeSequence( output, directory, s, detectOptions, source, onlyRegularFiles );
+	}
+}
+
+}
+}
+
+#endif
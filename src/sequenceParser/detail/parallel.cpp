@@ -0,0 +1,100 @@
+#include "parallel.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+
+namespace sequenceParser {
+namespace detail {
+
+namespace {
+
+/**
+ * @brief Tasks shared by the threads of a parallelFor.
+ */
+class TaskQueue
+{
+public:
+	TaskQueue( const std::size_t nbTasks, const boost::function<void( std::size_t )>& task )
+	: _nbTasks( nbTasks )
+	, _nextTask( 0 )
+	, _task( task )
+	{}
+
+	/// @brief Run the tasks until the end, or the first exception.
+	void run()
+	{
+		try
+		{
+			std::size_t index;
+			while( takeTask( index ) )
+				_task( index );
+		}
+		catch( ... )
+		{
+			boost::mutex::scoped_lock lock( _mutex );
+			if( ! _exception )
+				_exception = boost::current_exception();
+			_nextTask = _nbTasks; // stop the other threads
+		}
+	}
+
+	void rethrow() const
+	{
+		if( _exception )
+			boost::rethrow_exception( _exception );
+	}
+
+private:
+	bool takeTask( std::size_t& index )
+	{
+		boost::mutex::scoped_lock lock( _mutex );
+		if( _nextTask >= _nbTasks )
+			return false;
+		index = _nextTask++;
+		return true;
+	}
+
+private:
+	boost::mutex _mutex;
+	const std::size_t _nbTasks;
+	std::size_t _nextTask;
+	const boost::function<void( std::size_t )>& _task;
+	boost::exception_ptr _exception;
+};
+
+}
+
+
+std::size_t getNbThreads( const std::size_t nbThreads )
+{
+	if( nbThreads != 0 )
+		return nbThreads;
+	return std::max( 1u, boost::thread::hardware_concurrency() );
+}
+
+void parallelFor( const std::size_t nbTasks, const std::size_t nbThreads, const boost::function<void( std::size_t )>& task )
+{
+	const std::size_t nbWorkers = std::min( getNbThreads( nbThreads ), nbTasks );
+	if( nbWorkers <= 1 )
+	{
+		for( std::size_t i = 0; i < nbTasks; ++i )
+			task( i );
+		return;
+	}
+
+	TaskQueue queue( nbTasks, task );
+	boost::thread_group threads;
+	// the calling thread is one of the workers
+	for( std::size_t i = 1; i < nbWorkers; ++i )
+		threads.create_thread( boost::bind( &TaskQueue::run, &queue ) );
+	queue.run();
+	threads.join_all();
+	queue.rethrow();
+}
+
+}
+}
@@ -0,0 +1,33 @@
+#ifndef _SEQUENCE_PARSER_DETAIL_PARALLEL_HPP_
+#define _SEQUENCE_PARSER_DETAIL_PARALLEL_HPP_
+
+#include <boost/function.hpp>
+
+#include <cstddef>
+
+namespace sequenceParser {
+namespace detail {
+
+/**
+ * @param[in] nbThreads: requested number of threads, 0 for the number of cores
+ * @return the number of threads to use (at least 1)
+ */
+std::size_t getNbThreads( const std::size_t nbThreads );
+
+/**
+ * @brief Run the tasks 0 to nbTasks-1 on several threads.
+ *
+ * Each thread takes the next task until there is no more task,
+ * so the tasks are started in order but could end in any order.
+ * With one thread, the tasks run in the calling thread.
+ * An exception from a task is rethrown in the calling thread,
+ * once all the threads are stopped.
+ *
+ * @param[in] nbThreads: 0 for the number of cores
+ */
+void parallelFor( const std::size_t nbTasks, const std::size_t nbThreads, const boost::function<void( std::size_t )>& task );
+
+}
+}
+
+#endif
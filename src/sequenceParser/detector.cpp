@@ -1,7 +1,731 @@
 #include "detector.hpp"
+#include "SequenceBuilder.hpp"
+
+#include "detail/analyze.hpp"
+#include "detail/Arena.hpp"
+#include "detail/DigitScanner.hpp"
+#include "detail/FileNumbers.hpp"
+#include "detail/FileStrings.hpp"
+#include "detail/SeqIdMap.hpp"
+#include "detail/materialize.hpp"
+
+#include <boost/foreach.hpp>
+#include <boost/move/utility.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
 
 
 namespace sequenceParser {
 
+using detail::FileNumbers;
+using detail::FileStrings;
+using detail::SeqIdMap;
+
+namespace {
+
+/**
+ * @brief Detection output as sequences and names.
+ */
+class SequencesOutput
+{
+public:
+	SequencesOutput( std::vector<Sequence>& sequences, std::vector<std::string>& names )
+	: _sequences( sequences )
+	, _names( names )
+	{}
+
+	void addFile( const EType, const boost::string_ref& filename )
+	{
+		_names.push_back( std::string( filename.begin(), filename.end() ) );
+	}
+
+	void addSequence( Sequence& sequence )
+	{
+		_sequences.push_back( boost::move( sequence ) );
+	}
+
+private:
+	std::vector<Sequence>& _sequences;
+	std::vector<std::string>& _names;
+};
+
+bool isUnsignedNumber( const boost::string_ref& number )
+{
+	return number[0] >= '0' && number[0] <= '9';
+}
+
+/**
+ * @brief Names of a sorted input which build a single sequence:
+ *        only one number changes, always unsigned and with the same padding.
+ *
+ * Only the numbers of the first name and the frames are kept, the ranges
+ * are built as the names arrive.
+ */
+struct FramesGroup
+{
+	explicit FramesGroup( detail::Arena* arena )
+	: firstNumbers( arena )
+	, index( -1 )
+	, padding( 0 )
+	, minDigits( 0 )
+	{}
+
+	/// @return false if the name doesn't continue the sequence (the group is not modified)
+	bool add( const FileNumbers& numbers )
+	{
+		// the only number which differs from the first name
+		std::ssize_t changed = -1;
+		for( std::size_t i = 0; i < numbers.size(); ++i )
+		{
+			if( numbers.getString( i ) == firstNumbers.getString( i ) )
+				continue;
+			if( changed != -1 )
+				return false;
+			changed = i;
+		}
+		if( changed == -1 || ( index != -1 && changed != index ) ||
+		    ! isUnsignedNumber( numbers.getString( changed ) ) ||
+		    ! isUnsignedNumber( firstNumbers.getString( changed ) ) ||
+		    numbers.getFixedPadding( changed ) != firstNumbers.getFixedPadding( changed ) ||
+		    frames.contains( numbers.getTime( changed ) ) )
+			return false;
+
+		if( index == -1 )
+		{
+			index = changed;
+			padding = firstNumbers.getFixedPadding( index );
+			minDigits = firstNumbers.getMaxPadding( index );
+			frames.add( firstNumbers.getTime( index ) );
+		}
+		frames.add( numbers.getTime( index ) );
+		minDigits = std::min( minDigits, numbers.getMaxPadding( index ) );
+		return true;
+	}
+
+	/// @return the name of a frame (with index != -1)
+	std::string getFilename( const FileStrings& stringParts, const Time time ) const
+	{
+		std::string number = boost::lexical_cast<std::string>( time );
+		if( number.size() < padding )
+			number.insert( 0, padding - number.size(), '0' );
+
+		std::string filename;
+		for( std::size_t i = 0; i < firstNumbers.size(); ++i )
+		{
+			filename.append( stringParts[i].begin(), stringParts[i].end() );
+			if( std::ssize_t( i ) == index )
+				filename += number;
+			else
+				filename.append( firstNumbers.getString( i ).begin(), firstNumbers.getString( i ).end() );
+		}
+		filename.append( stringParts[firstNumbers.size()].begin(), stringParts[firstNumbers.size()].end() );
+		return filename;
+	}
+
+	/// @brief Build the sequence of the names, like buildSequences (with index != -1).
+	Sequence getSequence( const FileStrings& stringParts )
+	{
+		std::string prefix;
+		std::string suffix;
+		for( std::size_t i = 0; i < firstNumbers.size(); ++i )
+		{
+			std::string& part = ( std::ssize_t( i ) < index ) ? prefix : suffix;
+			part.append( stringParts[i].begin(), stringParts[i].end() );
+			if( std::ssize_t( i ) == index )
+				continue;
+			part.append( firstNumbers.getString( i ).begin(), firstNumbers.getString( i ).end() );
+		}
+		// the string before the number is the end of the prefix
+		prefix.append( stringParts[index].begin(), stringParts[index].end() );
+		suffix.erase( 0, stringParts[index].size() );
+		suffix.append( stringParts[firstNumbers.size()].begin(), stringParts[firstNumbers.size()].end() );
+
+		// without padding, the max padding is the smallest number of digits
+		Sequence sequence( prefix, padding, padding == 0 ? minDigits : padding, suffix, 0, 0 );
+		sequence.getFrameRanges() = frames.finalize();
+		return sequence;
+	}
+
+	FileNumbers firstNumbers; ///< the characters of the first name are in the arena
+	std::ssize_t index; ///< the number which changes, -1 with a single name
+	std::size_t padding;
+	std::size_t minDigits;
+	SequenceBuilder frames;
+};
+
+typedef boost::unordered_map<
+		FileStrings, FramesGroup, detail::SeqIdHash, std::equal_to<FileStrings>,
+		detail::ArenaAllocator<std::pair<const FileStrings, FramesGroup> >
+	> FramesGroups;
+
+}
+
+struct SequenceDetector::Data
+{
+	explicit Data( const EDetection detectOptions )
+	: detectOptions( detectOptions )
+	, groups( ( detail::ArenaAllocator<SeqIdMap::value_type>( &arena ) ) )
+	, framesGroups( ( detail::ArenaAllocator<FramesGroups::value_type>( &arena ) ) )
+	, names( detail::ArenaAllocator<boost::string_ref>( &arena ) )
+	, tmpStringParts( &arena )
+	, tmpNumberParts( &arena )
+	, size( 0 )
+	, sorted( true )
+	, lastGroup( NULL )
+	, lastFramesGroup( NULL )
+	{}
+
+	/// @brief Add a name to the names without number or to the groups of names.
+	void addName( const boost::string_ref& inputName );
+
+	/// @brief Move the frames of a group to the groups of names.
+	void spill( FramesGroups::iterator it );
+	void spillAll();
+
+	// all the names and their parts live in this arena
+	detail::Arena arena;
+
+	EDetection detectOptions;
+	SeqIdMap groups; ///< names with numbers, grouped by FileStrings
+	FramesGroups framesGroups; ///< while the input is sorted, names building a single sequence
+	std::vector<boost::string_ref, detail::ArenaAllocator<boost::string_ref> > names; ///< names without number, in the order of addition
+
+	FileStrings tmpStringParts;
+	FileNumbers tmpNumberParts;
+	std::size_t size;
+
+	bool sorted; ///< all the names are added in lexicographic order
+	std::string lastName;
+	/// group of the last name with numbers (the nodes of the maps are never moved)
+	SeqIdMap::value_type* lastGroup;
+	FramesGroups::value_type* lastFramesGroup;
+};
+
+void SequenceDetector::Data::addName( const boost::string_ref& inputName )
+{
+	// the parts reference the name, so it needs to stay in the arena
+	const boost::string_ref name = arena.copy( inputName );
+	FileStrings& stringParts = tmpStringParts;
+	FileNumbers& numberParts = tmpNumberParts;
+	stringParts.clear();
+	numberParts.clear();
+	if( ! decomposeFilename( name, stringParts, numberParts, detectOptions ) )
+	{
+		names.push_back( name );
+		return;
+	}
+
+	// sorted names of a sequence are consecutive, so it's usually the group of the last name
+	if( lastGroup != NULL && lastGroup->first == stringParts )
+	{
+		lastGroup->second.numbers.push_back( numberParts );
+		return;
+	}
+
+	SeqIdMap::iterator it( groups.find( stringParts ) );
+	if( it != groups.end() )
+	{
+		it->second.numbers.push_back( numberParts );
+	}
+	else
+	{
+		// without stat, all the names are files
+		detail::FileNumbersGroup group( &arena );
+		group.numbers.push_back( numberParts );
+		group.firstType = eTypeFile;
+		group.types = eTypeFile;
+		it = groups.insert( SeqIdMap::value_type( stringParts, group ) ).first;
+	}
+	lastGroup = &*it;
+}
+
+void SequenceDetector::Data::spill( FramesGroups::iterator it )
+{
+	FramesGroup& group = it->second;
+	if( group.index == -1 )
+	{
+		addName( recomposeFilename( it->first, group.firstNumbers ) );
+	}
+	else
+	{
+		// the names are rebuilt from the frames, the keys of the maps use the arena
+		const FileStrings stringParts( it->first, &arena );
+		BOOST_FOREACH( const FrameRange& range, group.frames.finalize() )
+		{
+			for( Time t = range.first; t <= range.last; t += range.step )
+			{
+				addName( group.getFilename( stringParts, t ) );
+			}
+		}
+	}
+	if( lastFramesGroup == &*it )
+		lastFramesGroup = NULL;
+	framesGroups.erase( it );
+}
+
+void SequenceDetector::Data::spillAll()
+{
+	while( ! framesGroups.empty() )
+		spill( framesGroups.begin() );
+}
+
+
+SequenceDetector::SequenceDetector( const EDetection detectOptions )
+: _data( new Data( detectOptions ) )
+{}
+
+SequenceDetector::~SequenceDetector()
+{}
+
+EDetection SequenceDetector::getDetectionOptions() const
+{
+	return _data->detectOptions;
+}
+
+void SequenceDetector::add( const std::string& name )
+{
+	add( boost::string_ref( name ) );
+}
+
+void SequenceDetector::add( const char* name )
+{
+	add( boost::string_ref( name ) );
+}
+
+void SequenceDetector::add( const boost::string_ref& inputName )
+{
+	if( inputName.empty() )
+		return;
+	// hidden files
+	if( ( _data->detectOptions & eDetectionIgnoreDotFile ) && inputName[0] == '.' )
+		return;
+
+	++_data->size;
+	if( _data->sorted && inputName < boost::string_ref( _data->lastName ) )
+	{
+		// the groups are only built as names arrive with a sorted input
+		_data->sorted = false;
+		_data->spillAll();
+	}
+	_data->lastName.assign( inputName.begin(), inputName.end() );
+
+	if( ! _data->sorted )
+	{
+		_data->addName( inputName );
+		return;
+	}
+
+	// the parts reference the input name until the name is kept
+	FileStrings& stringParts = _data->tmpStringParts;
+	FileNumbers& numberParts = _data->tmpNumberParts;
+	stringParts.clear();
+	numberParts.clear();
+	if( ! decomposeFilename( inputName, stringParts, numberParts, _data->detectOptions ) )
+	{
+		_data->names.push_back( _data->arena.copy( inputName ) );
+		return;
+	}
+
+	// sorted names of a sequence are consecutive, so it's usually the group of the last name
+	if( _data->lastFramesGroup != NULL && _data->lastFramesGroup->first == stringParts &&
+	    _data->lastFramesGroup->second.add( numberParts ) )
+		return;
+
+	FramesGroups::iterator it = _data->framesGroups.find( stringParts );
+	if( it != _data->framesGroups.end() )
+	{
+		if( &*it != _data->lastFramesGroup && it->second.add( numberParts ) )
+		{
+			_data->lastFramesGroup = &*it;
+			return;
+		}
+		// not a single sequence: group the names like an unsorted input
+		_data->spill( it );
+	}
+	else if( _data->groups.find( stringParts ) == _data->groups.end() )
+	{
+		const boost::string_ref name = _data->arena.copy( inputName );
+		stringParts.clear();
+		numberParts.clear();
+		decomposeFilename( name, stringParts, numberParts, _data->detectOptions );
+		FramesGroup group( &_data->arena );
+		group.firstNumbers = numberParts;
+		it = _data->framesGroups.insert( FramesGroups::value_type( stringParts, group ) ).first;
+		_data->lastFramesGroup = &*it;
+		return;
+	}
+	_data->addName( inputName );
+}
+
+void SequenceDetector::addBuffer( const char* buffer, const std::size_t size, const char separator )
+{
+	const char* const end = buffer + size;
+	const char* begin = buffer;
+	while( begin < end )
+	{
+		const char* nameEnd = std::find( begin, end, separator );
+		add( boost::string_ref( begin, nameEnd - begin ) );
+		begin = nameEnd + 1;
+	}
+}
+
+void SequenceDetector::add( const std::vector<std::string>& names )
+{
+	BOOST_FOREACH( const std::string& name, names )
+	{
+		add( boost::string_ref( name ) );
+	}
+}
+
+std::size_t SequenceDetector::size() const
+{
+	return _data->size;
+}
+
+bool SequenceDetector::isSortedInput() const
+{
+	return _data->sorted;
+}
+
+std::vector<Sequence> SequenceDetector::detect( std::vector<std::string>& outNonSequence )
+{
+	std::vector<Sequence> sequences;
+	SequencesOutput output( sequences, outNonSequence );
+
+	BOOST_FOREACH( const boost::string_ref& name, _data->names )
+	{
+		output.addFile( eTypeFile, name );
+	}
+	const boost::filesystem::path directory;
+	// names only: the types of the entries are not checked on the filesystem
+	DirectorySource* const noSource = NULL;
+	BOOST_FOREACH( SeqIdMap::value_type& group, _data->groups )
+	{
+		detail::materializeGroup( output, directory, group.first, group.second, _data->detectOptions, noSource );
+	}
+	BOOST_FOREACH( FramesGroups::value_type& group, _data->framesGroups )
+	{
+		if( group.second.index == -1 )
+		{
+			detail::FileNumbersGroup single( &_data->arena );
+			single.numbers.push_back( group.second.firstNumbers );
+			single.firstType = eTypeFile;
+			single.types = eTypeFile;
+			detail::materializeGroup( output, directory, group.first, single, _data->detectOptions, noSource );
+		}
+		else
+		{
+			Sequence sequence = group.second.getSequence( group.first );
+			detail::materializeSequence( output, directory, sequence, _data->detectOptions, noSource, true );
+		}
+	}
+	return sequences;
+}
+
+void SequenceDetector::clear()
+{
+	_data.reset( new Data( _data->detectOptions ) );
+}
+
+
+std::vector<Sequence> detectSequences(
+		std::vector<std::string>& outNonSequence,
+		const std::vector<std::string>& names,
+		const EDetection detectOptions )
+{
+	SequenceDetector detector( detectOptions );
+	detector.add( names );
+	return detector.detect( outNonSequence );
+}
+
+std::vector<Sequence> detectSequences(
+		std::vector<std::string>& outNonSequence,
+		const std::vector<boost::string_ref>& names,
+		const EDetection detectOptions )
+{
+	SequenceDetector detector( detectOptions );
+	BOOST_FOREACH( const boost::string_ref& name, names )
+	{
+		detector.add( name );
+	}
+	return detector.detect( outNonSequence );
+}
+
+std::vector<Sequence> detectSequences(
+		std::vector<std::string>& outNonSequence,
+		const char* buffer,
+		const std::size_t size,
+		const char separator,
+		const EDetection detectOptions )
+{
+	SequenceDetector detector( detectOptions );
+	detector.addBuffer( buffer, size, separator );
+	return detector.detect( outNonSequence );
+}
+
+
+namespace {
+
+/// @brief Directory with the names found in the manifest.
+struct PendingDirectory
+{
+	std::string path;
+	std::string names; ///< separated by '\0'
+};
+
+/// @return if @p directory is @p path or one of its parents
+bool isParentOrSame( const std::string& directory, const boost::string_ref& path )
+{
+	if( ! path.starts_with( directory ) )
+		return false;
+	if( directory.empty() )
+		return path.empty() || path[0] != '/'; // relative
+	return path.size() == directory.size() ||
+	       path[directory.size()] == '/' ||
+	       directory[directory.size() - 1] == '/';
+}
+
+}
+
+struct ManifestDetector::Data
+{
+	Data( const Callback& callback, const EDetection detectOptions, const bool sorted )
+	: callback( callback )
+	, detectOptions( detectOptions )
+	, sorted( sorted )
+	, nbDirectories( 0 )
+	{}
+
+	void sendDirectory( PendingDirectory& directory )
+	{
+		SequenceDetector detector( detectOptions );
+		detector.addBuffer( directory.names.data(), directory.names.size(), '\0' );
+		std::vector<std::string> nonSequences;
+		std::vector<Sequence> sequences = detector.detect( nonSequences );
+		++nbDirectories;
+		if( sorted )
+			sentDirectories.insert( directory.path );
+		callback( directory.path, sequences, nonSequences );
+	}
+
+	/// @brief Group the names of all the directories until flush, for the next paths.
+	void setUnsorted()
+	{
+		BOOST_FOREACH( PendingDirectory& directory, stack )
+		{
+			directories[directory.path].swap( directory.names );
+		}
+		stack.clear();
+		sentDirectories.clear();
+		sorted = false;
+	}
+
+	Callback callback;
+	EDetection detectOptions;
+	bool sorted;
+	std::size_t nbDirectories;
+
+	/// sorted: the current directory and its parents (the current directory is the last one)
+	std::vector<PendingDirectory> stack;
+	/// sorted: the directories already sent, to detect an unsorted manifest
+	std::set<std::string> sentDirectories;
+	/// not sorted: all the directories
+	std::map<std::string, std::string> directories;
+};
+
+
+ManifestDetector::ManifestDetector( const Callback& callback, const EDetection detectOptions, const bool sorted )
+: _data( new Data( callback, detectOptions, sorted ) )
+{}
+
+ManifestDetector::~ManifestDetector()
+{}
+
+void ManifestDetector::add( const boost::string_ref& path )
+{
+	const std::size_t separator = path.rfind( '/' );
+	boost::string_ref directory;
+	boost::string_ref name = path;
+	if( separator != boost::string_ref::npos )
+	{
+		// keep the '/' of the root directory
+		directory = path.substr( 0, separator == 0 ? 1 : separator );
+		name = path.substr( separator + 1 );
+	}
+	if( name.empty() )
+		return;
+
+	std::string* names = NULL;
+	if( _data->sorted )
+	{
+		std::vector<PendingDirectory>& stack = _data->stack;
+		if( stack.empty() || directory != stack.back().path )
+		{
+			// the directories which don't contain the path are complete
+			while( ! stack.empty() && ! isParentOrSame( stack.back().path, directory ) )
+			{
+				_data->sendDirectory( stack.back() );
+				stack.pop_back();
+			}
+			if( stack.empty() || directory != stack.back().path )
+			{
+				const std::string directoryPath( directory.begin(), directory.end() );
+				if( _data->sentDirectories.count( directoryPath ) )
+				{
+					// the manifest is not sorted, the directory has been sent without all its names
+					_data->setUnsorted();
+				}
+				else
+				{
+					stack.push_back( PendingDirectory() );
+					stack.back().path = directoryPath;
+				}
+			}
+		}
+		if( _data->sorted )
+			names = &stack.back().names;
+	}
+	if( ! _data->sorted )
+	{
+		names = &_data->directories[std::string( directory.begin(), directory.end() )];
+	}
+	names->append( name.begin(), name.end() );
+	*names += '\0';
+}
+
+bool ManifestDetector::read( std::istream& stream, const char separator )
+{
+	std::string line;
+	while( std::getline( stream, line, separator ) )
+	{
+		add( line );
+	}
+	return stream.eof();
+}
+
+void ManifestDetector::flush()
+{
+	while( ! _data->stack.empty() )
+	{
+		_data->sendDirectory( _data->stack.back() );
+		_data->stack.pop_back();
+	}
+	typedef std::map<std::string, std::string>::value_type DirectoryValue;
+	BOOST_FOREACH( DirectoryValue& directory, _data->directories )
+	{
+		PendingDirectory pending;
+		pending.path = directory.first;
+		pending.names.swap( directory.second );
+		_data->sendDirectory( pending );
+	}
+	_data->directories.clear();
+}
+
+std::size_t ManifestDetector::getNbDirectories() const
+{
+	return _data->nbDirectories;
+}
+
+std::size_t ManifestDetector::getNbPendingDirectories() const
+{
+	return _data->stack.size() + _data->directories.size();
+}
+
+bool ManifestDetector::isSorted() const
+{
+	return _data->sorted;
+}
+
+
+namespace {
+
+/// @brief Add the content of each directory to the items.
+struct ItemsCallback
+{
+	explicit ItemsCallback( std::vector<Item>& items )
+	: items( items )
+	{}
+
+	void operator()( const std::string& directory, std::vector<Sequence>& sequences, std::vector<std::string>& nonSequences ) const
+	{
+		const boost::filesystem::path directoryPath( directory );
+		BOOST_FOREACH( const std::string& name, nonSequences )
+		{
+			items.push_back( Item( eTypeFile, directoryPath / name ) );
+		}
+		BOOST_FOREACH( Sequence& sequence, sequences )
+		{
+			items.push_back( Item( boost::move( sequence ), directoryPath ) );
+		}
+	}
+
+	std::vector<Item>& items;
+};
+
+}
+
+bool detectSequencesInManifest(
+		std::vector<Item>& outItems,
+		const std::string& manifestFilename,
+		const EDetection detectOptions,
+		const char separator,
+		const bool sorted )
+{
+	std::ifstream stream( manifestFilename.c_str(), std::ios::in | std::ios::binary );
+	if( ! stream )
+		return false;
+	const std::size_t nbItems = outItems.size();
+	ManifestDetector detector( ItemsCallback( outItems ), detectOptions, sorted );
+	const bool complete = detector.read( stream, separator );
+	detector.flush();
+	if( sorted && ! detector.isSorted() )
+	{
+		// some directories have been sent before the end of their names
+		outItems.erase( outItems.begin() + nbItems, outItems.end() );
+		return detectSequencesInManifest( outItems, manifestFilename, detectOptions, separator, false );
+	}
+	return complete;
+}
+
+
+
+std::vector<Time> splitFilename(
+		std::vector<std::string>& outStrings,
+		std::vector<std::string>& outNumbers,
+		const std::string& filename,
+		const EDetection detectOptions )
+{
+	detail::Arena arena;
+	FileStrings stringParts( &arena );
+	FileNumbers numberParts( &arena );
+	decomposeFilename( filename, stringParts, numberParts, detectOptions );
+
+	outStrings.clear();
+	for( std::size_t i = 0; i < stringParts.getId().size(); ++i )
+	{
+		outStrings.push_back( std::string( stringParts[i].begin(), stringParts[i].end() ) );
+	}
+	outNumbers.clear();
+	std::vector<Time> times;
+	for( std::size_t i = 0; i < numberParts.size(); ++i )
+	{
+		outNumbers.push_back( std::string( numberParts.getString( i ).begin(), numberParts.getString( i ).end() ) );
+		times.push_back( numberParts.getTime( i ) );
+	}
+	return times;
+}
+
+bool setDigitScanner( const std::string& name )
+{
+	return detail::setDigitScanner( name );
+}
+
+std::string getDigitScanner()
+{
+	return detail::getDigitScannerName();
+}
 
 }
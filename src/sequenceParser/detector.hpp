@@ -2,17 +2,236 @@
 #define _SEQUENCE_PARSER_DETECTOR_HPP_
 
 #include "common.hpp"
+#include "Item.hpp"
 #include "Sequence.hpp"
 
+#include <boost/scoped_ptr.hpp>
+#ifndef SWIG
+#include <boost/function.hpp>
+#include <boost/utility/string_ref.hpp>
+#endif
+
+#include <iosfwd>
+#include <vector>
+
 
 namespace sequenceParser {
 
-// TODO: detect Sequences from strings
-//
-//std::vector<Sequence> detectSequences(
-//	std::vector<std::string>& outNonSequence,
-//	const std::vector<std::string>& names,
-//	const EDetection detectOptions = eDetectionDefault );
+/**
+ * @brief Detect sequences from names, without any access to the filesystem.
+ *
+ * The names are added one by one (the characters are copied), then the
+ * detection groups them like browse does with the content of a directory.
+ * As there is no stat, all the names are considered as files
+ * (a sequence of directories is a sequence).
+ *
+ * The names are used as a whole, the directory separators have no meaning:
+ * use filenames of the same directory.
+ */
+class SequenceDetector
+{
+public:
+	typedef SequenceDetector This;
+
+public:
+	/**
+	 * @param[in] detectOptions: some options to choose how to consider sequences
+	 *                           (the hidden files are ignored with eDetectionIgnoreDotFile).
+	 */
+	explicit SequenceDetector( const EDetection detectOptions = eDetectionDefault );
+	~SequenceDetector();
+
+private:
+	SequenceDetector( const SequenceDetector& );
+	SequenceDetector& operator=( const SequenceDetector& );
+
+public:
+	EDetection getDetectionOptions() const;
+
+	void add( const std::string& name );
+#ifndef SWIG
+	void add( const char* name );
+	void add( const boost::string_ref& name );
+
+	/// @brief Add all the names of a buffer, separated by @p separator (empty names are skipped).
+	void addBuffer( const char* buffer, const std::size_t size, const char separator = '\n' );
+#endif
+
+	void add( const std::vector<std::string>& names );
+
+	/// @return number of names added (without the ignored ones)
+	std::size_t size() const;
+
+	/**
+	 * @return if the names have been added in lexicographic order (like a sorted listing).
+	 * @note With sorted names, the frames of a group where only one number changes
+	 *       (same padding) are added to a SequenceBuilder as the names arrive,
+	 *       only the first name of the group is kept.
+	 *       The other groups, and all of them from the first unsorted name,
+	 *       are detected with the sorts. The result is the same in both cases.
+	 */
+	bool isSortedInput() const;
+
+	/**
+	 * @brief Build the sequences of all the names added.
+	 * @param[out] outNonSequence: the names which are not in a sequence (appended)
+	 * @return the sequences, without directory
+	 */
+	std::vector<Sequence> detect( std::vector<std::string>& outNonSequence );
+
+	/// @brief Remove all the names.
+	void clear();
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+
+
+/**
+ * @brief Detect sequences from a list of names, without any access to the filesystem.
+ * @param[out] outNonSequence: the names which are not in a sequence (appended)
+ * @param[in] names: filenames of the same directory
+ * @param[in] detectOptions: some options to choose how to consider sequences.
+ * @return the sequences, without directory
+ * @see SequenceDetector
+ */
+std::vector<Sequence> detectSequences(
+	std::vector<std::string>& outNonSequence,
+	const std::vector<std::string>& names,
+	const EDetection detectOptions = eDetectionDefault );
+
+#ifndef SWIG
+std::vector<Sequence> detectSequences(
+	std::vector<std::string>& outNonSequence,
+	const std::vector<boost::string_ref>& names,
+	const EDetection detectOptions = eDetectionDefault );
+
+/**
+ * @brief Same as detectSequences, from a buffer of names separated by @p separator.
+ */
+std::vector<Sequence> detectSequences(
+	std::vector<std::string>& outNonSequence,
+	const char* buffer,
+	const std::size_t size,
+	const char separator = '\n',
+	const EDetection detectOptions = eDetectionDefault );
+#endif
+
+#ifndef SWIG
+/**
+ * @brief Detect sequences from a manifest of paths (like the output of find),
+ *        directory by directory, without any access to the filesystem.
+ *
+ * The paths are split on the last '/', the names are grouped by directory,
+ * and the detection of a directory is sent to the callback once all its
+ * names are known.
+ *
+ * If the manifest is sorted (or in the order of find: each directory
+ * followed by its content), a directory is complete as soon as a path
+ * outside of it arrives, so only the names of the current directory and
+ * its parents are kept in memory.
+ * Otherwise, all the names are kept until flush.
+ * If a directory already sent comes back in a manifest said sorted,
+ * the names of all the next paths are kept until flush (see isSorted).
+ *
+ * A directory which is also in the manifest (like "a/b" before "a/b/c")
+ * is a name of its parent directory, like a file.
+ */
+class ManifestDetector
+{
+public:
+	typedef ManifestDetector This;
+	/// Called with the sequences and the other names of a complete directory (they could be moved).
+	typedef boost::function<void( const std::string& directory, std::vector<Sequence>& sequences, std::vector<std::string>& nonSequences )> Callback;
+
+public:
+	/**
+	 * @param[in] callback: called once per directory
+	 * @param[in] detectOptions: some options to choose how to consider sequences.
+	 * @param[in] sorted: the paths of a directory are never after a path out of the directory
+	 */
+	ManifestDetector( const Callback& callback, const EDetection detectOptions = eDetectionDefault, const bool sorted = true );
+	~ManifestDetector();
+
+private:
+	ManifestDetector( const ManifestDetector& );
+	ManifestDetector& operator=( const ManifestDetector& );
+
+public:
+	void add( const boost::string_ref& path );
+
+	/**
+	 * @brief Add all the paths of a stream, until its end.
+	 * @param[in] separator: '\n', or '\0' for "find -print0"
+	 * @return false if the stream has failed before its end
+	 */
+	bool read( std::istream& stream, const char separator = '\n' );
+
+	/// @brief Send all the remaining directories to the callback (at the end of the manifest).
+	void flush();
+
+	/// @return number of directories sent to the callback
+	std::size_t getNbDirectories() const;
+
+	/// @return number of directories with names kept in memory
+	std::size_t getNbPendingDirectories() const;
+
+	/**
+	 * @return false if the manifest is not sorted, or if a directory has come back
+	 *         in a manifest said sorted: the directories sent before can be
+	 *         incomplete and sent again with the other names.
+	 */
+	bool isSorted() const;
+
+private:
+	struct Data;
+	boost::scoped_ptr<Data> _data;
+};
+#endif
+
+/**
+ * @brief Detect the sequences of all the directories of a manifest file (see ManifestDetector).
+ * @param[out] outItems: the files and sequences of all the directories (appended),
+ *                       the type of the files is not checked
+ * @param[in] manifestFilename: file with one path per line (or separated by @p separator)
+ * @param[in] detectOptions: some options to choose how to consider sequences.
+ * @param[in] separator: '\n', or '\0' for "find -print0"
+ * @param[in] sorted: the manifest is sorted (see ManifestDetector),
+ *                    if a directory comes back the file is read again as unsorted
+ * @return false if the file can't be read
+ */
+bool detectSequencesInManifest(
+	std::vector<Item>& outItems,
+	const std::string& manifestFilename,
+	const EDetection detectOptions = eDetectionDefault,
+	const char separator = '\n',
+	const bool sorted = true );
+
+
+/**
+ * @brief Split a filename in strings and numbers, like the detection does.
+ * @param[out] outStrings: the strings between the numbers (previous content is removed)
+ * @param[out] outNumbers: the numbers as written in the filename (previous content is removed),
+ *                         the numbers out of the range of Time are skipped
+ * @return the values of the numbers
+ */
+std::vector<Time> splitFilename(
+	std::vector<std::string>& outStrings,
+	std::vector<std::string>& outNumbers,
+	const std::string& filename,
+	const EDetection detectOptions = eDetectionDefault );
+
+/**
+ * @brief Choose the instructions used to find the numbers in the filenames:
+ *        "avx2", "sse2" or "scalar" (the fastest supported ones by default).
+ * @warning Not thread safe, it's meant for the tests and the benchmarks.
+ * @return false if the processor or the build doesn't support them
+ */
+bool setDigitScanner( const std::string& name );
+
+/// @return name of the instructions used to find the numbers in the filenames
+std::string getDigitScanner();
 
 }
 
@@ -8,13 +8,12 @@
 #include "sequenceParser/detector.hpp"
 %}
 
-/*
-%template(FileObjectVector) ::boost::ptr_vector<sequenceParser::FileObject>;
-%template(FileVector) ::boost::ptr_vector<sequenceParser::File>;
-%template(FolderVector) ::boost::ptr_vector<sequenceParser::Folder>;
-%template(SequenceVector) ::boost::ptr_vector<sequenceParser::Sequence>;
-*/
+namespace std {
+%template(SequenceVector) vector< sequenceParser::Sequence >;
+}
 
-%include "detector.hpp"
+%ignore sequenceParser::SequenceDetector::SequenceDetector( const SequenceDetector& );
+%ignore sequenceParser::SequenceDetector::operator=;
 
+%include "detector.hpp"
 
@@ -1,27 +1,386 @@
 #include "filesystem.hpp"
+#include "DirectoryScan.hpp"
+#include "DirectorySource.hpp"
+#include "system.hpp"
 
 #include "utils.hpp"
 
 #include "detail/analyze.hpp"
+#include "detail/Arena.hpp"
+#include "detail/DigitScanner.hpp"
+#include "detail/ExternalSort.hpp"
 #include "detail/FileNumbers.hpp"
 #include "detail/FileStrings.hpp"
+#include "detail/SeqIdMap.hpp"
+#include "detail/ShardedScan.hpp"
+#include "detail/listing.hpp"
+#include "detail/materialize.hpp"
+#include "detail/parallel.hpp"
 
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/regex.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
 
+#include <algorithm>
+#include <map>
 #include <set>
 
+#ifdef __UNIX__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 namespace sequenceParser {
 
-using detail::FileNumbers;
-using detail::FileStrings;
-using detail::SeqIdHash;
 namespace bfs = boost::filesystem;
 
+namespace {
+
+/**
+ * @brief Key of the group of a file, to sort the files by group:
+ *        the strings joined with '/', which can't be inside a filename.
+ */
+void getGroupKey( const detail::FileStrings& stringParts, std::string& key )
+{
+	key.clear();
+	for( std::size_t i = 0; i < stringParts.getId().size(); ++i )
+	{
+		if( i != 0 )
+			key += '/';
+		key.append( stringParts[i].begin(), stringParts[i].end() );
+	}
+}
+
+/// @brief The numbers of a file joined with '/', the file is rebuilt with its key.
+void getGroupNumbers( const detail::FileNumbers& numberParts, std::string& numbers )
+{
+	numbers.clear();
+	for( std::size_t i = 0; i < numberParts.size(); ++i )
+	{
+		if( i != 0 )
+			numbers += '/';
+		numbers.append( numberParts.getString( i ).begin(), numberParts.getString( i ).end() );
+	}
+}
+
+/// @brief Rebuild a filename from its key and its numbers, alternating the strings and the numbers.
+void recomposeFromKey( const boost::string_ref& key, const boost::string_ref& numbers, std::string& filename )
+{
+	filename.clear();
+	boost::string_ref::const_iterator itKey = key.begin();
+	boost::string_ref::const_iterator itNumbers = numbers.begin();
+	for( ;; )
+	{
+		const boost::string_ref::const_iterator keyEnd = std::find( itKey, key.end(), '/' );
+		filename.append( itKey, keyEnd );
+		if( keyEnd == key.end() )
+			break;
+		const boost::string_ref::const_iterator numbersEnd = std::find( itNumbers, numbers.end(), '/' );
+		filename.append( itNumbers, numbersEnd );
+		itKey = keyEnd + 1;
+		itNumbers = ( numbersEnd == numbers.end() ) ? numbersEnd : numbersEnd + 1;
+	}
+}
+
+/**
+ * @brief Files of a group read from the sorted entries,
+ *        all the memory lives in the arena of the group.
+ */
+struct ExternalGroup
+{
+	explicit ExternalGroup( detail::Arena* arena )
+	: stringParts( arena )
+	, tmpStringParts( arena )
+	, tmpNumberParts( arena )
+	, group( arena )
+	{}
+
+	detail::FileStrings stringParts;
+	detail::FileStrings tmpStringParts;
+	detail::FileNumbers tmpNumberParts;
+	detail::FileNumbersGroup group;
+};
+
+/// @brief Set the frame ranges of a sequence from the times of its files.
+void setSequenceTimes( Sequence& sequence, std::vector<Time>& times )
+{
+	if( times.size() < 2 )
+	{
+		if( times.size() == 1 )
+			sequence.getFrameRanges().push_back( FrameRange( times.front() ) );
+		return;
+	}
+	std::sort( times.begin(), times.end() );
+	// with a variable padding, "1" and "01" are the same time
+	times.erase( std::unique( times.begin(), times.end() ), times.end() );
+	sequence.getFrameRanges() = extractFrameRanges( times );
+}
+
+/**
+ * @brief Patterns of browseSequences inside the same directory.
+ */
+struct PatternsDirectory
+{
+	bfs::path directory;
+	std::vector<std::size_t> patterns; ///< indices of the patterns (and of their sequences)
+};
+
+/**
+ * @brief List a directory once, and add the files to all the sequences of its patterns.
+ *
+ * The patterns are found from the start of the filename (their prefix),
+ * for each size of prefix used in the directory.
+ */
+void browseSequencesInDirectory(
+		DirectorySource& source,
+		const std::vector<PatternsDirectory>& directories,
+		std::vector<Sequence>& sequences,
+		const std::size_t directoryIndex )
+{
+	const PatternsDirectory& directory = directories[directoryIndex];
+
+	typedef boost::unordered_map<std::string, std::vector<std::size_t> > PatternsByPrefix;
+	PatternsByPrefix patternsByPrefix; ///< positions in the patterns of the directory
+	std::set<std::size_t> prefixSizes;
+	for( std::size_t i = 0; i < directory.patterns.size(); ++i )
+	{
+		const std::string& prefix = sequences[directory.patterns[i]].getPrefix();
+		patternsByPrefix[prefix].push_back( i );
+		prefixSizes.insert( prefix.size() );
+	}
+
+	std::vector<DirectoryEntry> entries;
+	if( ! source.listDirectory( directory.directory, entries ) )
+		return; // empty sequences
+
+	std::vector<std::vector<Time> > times( directory.patterns.size() );
+	std::string prefix;
+	BOOST_FOREACH( const DirectoryEntry& entry, entries )
+	{
+		const std::string& filename = entry.filename;
+		BOOST_FOREACH( const std::size_t prefixSize, prefixSizes )
+		{
+			if( prefixSize >= filename.size() )
+				break;
+			prefix.assign( filename, 0, prefixSize );
+			const PatternsByPrefix::const_iterator it = patternsByPrefix.find( prefix );
+			if( it == patternsByPrefix.end() )
+				continue;
+
+			BOOST_FOREACH( const std::size_t i, it->second )
+			{
+				// like Sequence::isIn
+				const std::string& suffix = sequences[directory.patterns[i]].getSuffix();
+				if( filename.size() <= prefixSize + suffix.size() ||
+				    filename.compare( filename.size() - suffix.size(), suffix.size(), suffix ) != 0 )
+					continue;
+				Time time;
+				if( detail::parseTime( boost::string_ref( filename.data() + prefixSize, filename.size() - prefixSize - suffix.size() ), time ) )
+					times[i].push_back( time );
+			}
+		}
+	}
+
+	for( std::size_t i = 0; i < directory.patterns.size(); ++i )
+	{
+		setSequenceTimes( sequences[directory.patterns[i]], times[i] );
+	}
+}
+
+/**
+ * @brief Filename of a frame, like Sequence::getFilenameAt without any stream.
+ * @param[out] filename: its memory is reused
+ */
+void getFrameFilename( const Sequence& sequence, const Time time, std::string& filename )
+{
+	char digits[24];
+	std::size_t nbDigits = 0;
+	boost::uint64_t value = ( time < 0 ) ? boost::uint64_t( -( time + 1 ) ) + 1 : boost::uint64_t( time );
+	do
+	{
+		digits[nbDigits++] = char( '0' + value % 10 );
+		value /= 10;
+	}
+	while( value != 0 );
+
+	filename = sequence.getPrefix();
+	if( time < 0 )
+		filename += '-'; // "prefix.-0001.jpg"
+	if( sequence.getFixedPadding() > nbDigits )
+		filename.append( sequence.getFixedPadding() - nbDigits, '0' );
+	while( nbDigits != 0 )
+		filename += digits[--nbDigits];
+	filename += sequence.getSuffix();
+}
+
+/**
+ * @brief Choose between probing each frame and listing the directory.
+ *
+ * A probe is the lookup of a name (a round trip on a network filesystem),
+ * while a listing gets a lot of entries at once: a listed entry costs about
+ * a tenth of a probe. But the probes run on several threads.
+ */
+bool shouldProbe( const std::size_t nbFrames, const std::size_t estimatedNbEntries, const std::size_t nbThreads )
+{
+	static const std::size_t probeCostInEntries = 10;
+	return nbFrames * probeCostInEntries <= estimatedNbEntries * nbThreads;
+}
+
+#ifdef __UNIX__
+/**
+ * @brief Number of entries of a directory, estimated without listing it.
+ *
+ * On most filesystems, the size of a directory grows with its entries
+ * (a few bytes of header and the name), and its number of links with its
+ * sub-directories.
+ */
+std::size_t estimateNbEntries( const struct stat& directoryStat, const std::size_t filenameSize )
+{
+	const std::size_t entrySize = ( 8 + filenameSize + 3 ) / 4 * 4; // like ext4
+	const std::size_t nbEntriesFromSize = std::size_t( directoryStat.st_size ) / entrySize;
+	const std::size_t nbSubDirectories = ( directoryStat.st_nlink > 2 ) ? std::size_t( directoryStat.st_nlink - 2 ) : 0;
+	return std::max( nbEntriesFromSize, nbSubDirectories );
+}
+#endif
+
+/**
+ * @brief Probe the files of a chunk of frames by their names.
+ * @param[out] outPresent: set for the frames which exist
+ */
+void probeFrames(
+		const Sequence& sequence,
+		const std::vector<Time>& frames,
+		const std::size_t chunkSize,
+#ifdef __UNIX__
+		const int directoryFd,
+#else
+		const bfs::path& directory,
+#endif
+		std::vector<char>& outPresent,
+		const std::size_t chunk )
+{
+	std::string filename;
+	const std::size_t end = std::min( frames.size(), ( chunk + 1 ) * chunkSize );
+	for( std::size_t i = chunk * chunkSize; i < end; ++i )
+	{
+		getFrameFilename( sequence, frames[i], filename );
+#ifdef __UNIX__
+		outPresent[i] = ( faccessat( directoryFd, filename.c_str(), F_OK, 0 ) == 0 );
+#else
+		boost::system::error_code error;
+		outPresent[i] = bfs::exists( directory / filename, error );
+#endif
+	}
+}
+
+/**
+ * @brief Find the frames in the listing of the directory.
+ * @return false if the directory can't be listed
+ */
+bool listFrames(
+		const Sequence& sequence,
+		const std::vector<Time>& frames,
+		const bfs::path& directory,
+		std::vector<char>& outPresent )
+{
+	DirectorySource& source = getFilesystemDirectorySource();
+	std::vector<DirectoryEntry> entries;
+	if( ! source.listDirectory( directory, entries ) )
+		return false;
+
+	boost::unordered_map<std::string, std::size_t> frameIndices;
+	std::string filename;
+	for( std::size_t i = 0; i < frames.size(); ++i )
+	{
+		getFrameFilename( sequence, frames[i], filename );
+		frameIndices[filename] = i;
+	}
+
+	BOOST_FOREACH( const DirectoryEntry& entry, entries )
+	{
+		const boost::unordered_map<std::string, std::size_t>::const_iterator it = frameIndices.find( entry.filename );
+		if( it == frameIndices.end() )
+			continue;
+		// like the probes, a link needs a target
+		outPresent[it->second] = ( entry.type != eTypeLink ) || source.exists( directory / entry.filename );
+	}
+	return true;
+}
+
+/// @return if a component of a glob pattern has no wildcard (it's a name)
+bool isLiteralGlobComponent( const std::string& component )
+{
+	return component.find_first_of( "*?#@%[" ) == std::string::npos;
+}
+
+/**
+ * @brief List a directory, and keep its sub-directories which match a component of a glob pattern.
+ * @param[out] outDirectories: for each directory, the sub-directories which match (sorted)
+ */
+void globDirectory(
+		DirectorySource& source,
+		const std::vector<bfs::path>& directories,
+		const boost::regex& component,
+		const bool ignoreDotDirectories,
+		std::vector<std::vector<bfs::path> >& outDirectories,
+		const std::size_t directoryIndex )
+{
+	const bfs::path& directory = directories[directoryIndex];
+	std::vector<DirectoryEntry> entries;
+	if( ! source.listDirectory( directory, entries ) )
+		return;
+
+	std::vector<std::string> names;
+	BOOST_FOREACH( const DirectoryEntry& entry, entries )
+	{
+		if( entry.filename.empty() || ( ignoreDotDirectories && entry.filename[0] == '.' ) )
+			continue;
+		if( entry.type != eTypeFolder && entry.type != eTypeLink )
+			continue;
+		if( ! boost::regex_match( entry.filename, component ) )
+			continue;
+		// only the links need another call, the listing gives the type of the others
+		if( entry.type == eTypeLink && ! source.isDirectory( directory / entry.filename ) )
+			continue;
+		names.push_back( entry.filename );
+	}
+	std::sort( names.begin(), names.end() );
+
+	std::vector<bfs::path>& subDirectories = outDirectories[directoryIndex];
+	BOOST_FOREACH( const std::string& name, names )
+	{
+		subDirectories.push_back( directory / name );
+	}
+}
+
+/// @brief Browse a directory matched by a glob pattern, with the last component of the pattern as a filter.
+void browseGlobDirectory(
+		DirectorySource& source,
+		const std::vector<bfs::path>& directories,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters,
+		std::vector<std::vector<Item> >& outItems,
+		const std::size_t directoryIndex )
+{
+	try
+	{
+		outItems[directoryIndex] = browse( source, directories[directoryIndex], detectOptions, filters );
+	}
+	catch( const bfs::filesystem_error& )
+	{
+		// the literal components are not listed, the directory may not exist
+	}
+}
+
+}
+
 
 boost::filesystem::path getDirectoryFromPath( const boost::filesystem::path& p )
 {
@@ -36,6 +395,11 @@ boost::filesystem::path getDirectoryFromPath( const boost::filesystem::path& p )
 
 
 bool browseSequence( Sequence& outSequence, const std::string& pattern, const EPattern accept )
+{
+	return browseSequence( outSequence, getFilesystemDirectorySource(), pattern, accept );
+}
+
+bool browseSequence( Sequence& outSequence, DirectorySource& source, const std::string& pattern, const EPattern accept )
 {
 	outSequence.clear();
 	boost::filesystem::path directory = getDirectoryFromPath( pattern );
@@ -43,154 +407,568 @@ bool browseSequence( Sequence& outSequence, const std::string& pattern, const EP
 	if( !outSequence.initFromPattern( boost::filesystem::path( pattern ).filename().string(), accept ) )
 		return false; // not recognized as a pattern, maybe a still file
 
-	if( !boost::filesystem::exists( directory ) )
+	std::vector<DirectoryEntry> entries;
+	if( !source.listDirectory( directory, entries ) )
 		return false; // an empty sequence
 
 	std::vector<std::string> allTimesStr;
 	std::vector<Time> allTimes;
-	bfs::directory_iterator itEnd;
 
-	for( bfs::directory_iterator iter( directory ); iter != itEnd; ++iter )
+	BOOST_FOREACH( const DirectoryEntry& entry, entries )
 	{
-		// we don't make this check, which can take long time on big sequences (>1000 files)
-		// depending on your filesystem, we may need to do a stat() for each file
-		// if( bfs::is_directory( iter->status() ) )
-		// continue; // skip directories
+		// we don't check the type of the targets of the links, which can take long time
+		// on big sequences (>1000 files) depending on your filesystem
 		Time time;
 		std::string timeStr;
 
 		// if the file is inside the sequence
-		if( outSequence.isIn( iter->path().filename().string(), time, timeStr ) )
+		if( outSequence.isIn( entry.filename, time, timeStr ) )
 		{
 			// create a big vector of all times in our sequence
 			allTimesStr.push_back( timeStr );
 			allTimes.push_back( time );
 		}
 	}
-	if( allTimes.size() < 2 )
+	setSequenceTimes( outSequence, allTimes );
+	return true;
+}
+
+std::vector<Sequence> browseSequences( const std::vector<std::string>& patterns, const EPattern accept, const std::size_t nbThreads )
+{
+	return browseSequences( getFilesystemDirectorySource(), patterns, accept, nbThreads );
+}
+
+std::vector<Sequence> browseSequences( DirectorySource& source, const std::vector<std::string>& patterns, const EPattern accept, const std::size_t nbThreads )
+{
+	std::vector<Sequence> sequences( patterns.size() );
+
+	// group the patterns by directory
+	std::vector<PatternsDirectory> directories;
+	std::map<std::string, std::size_t> directoryIndices;
+	for( std::size_t i = 0; i < patterns.size(); ++i )
 	{
-		if( allTimes.size() == 1 )
+		if( ! sequences[i].initFromPattern( bfs::path( patterns[i] ).filename().string(), accept ) )
 		{
-			outSequence._ranges.push_back(FrameRange(allTimes.front()));
+			sequences[i].clear();
+			continue; // not recognized as a pattern
 		}
-		//std::cout << "empty => " <<  _firstTime << " > " << _lastTime << " : " << _nbFiles << std::endl;
-		return true; // an empty sequence
+		const bfs::path directory = getDirectoryFromPath( patterns[i] );
+		const std::pair<std::map<std::string, std::size_t>::iterator, bool> inserted =
+			directoryIndices.insert( std::make_pair( directory.string(), directories.size() ) );
+		if( inserted.second )
+		{
+			directories.push_back( PatternsDirectory() );
+			directories.back().directory = directory;
+		}
+		directories[inserted.first->second].patterns.push_back( i );
+	}
+
+	// each task only changes the sequences of its directory
+	detail::parallelFor( directories.size(), nbThreads,
+		boost::bind( &browseSequencesInDirectory, boost::ref( source ), boost::cref( directories ), boost::ref( sequences ), _1 ) );
+	return sequences;
+}
+
+std::vector<Item> browseGlob( const std::string& pattern, const EDetection detectOptions, const std::size_t nbThreads )
+{
+	return browseGlob( getFilesystemDirectorySource(), pattern, detectOptions, nbThreads );
+}
+
+std::vector<Item> browseGlob( DirectorySource& source, const std::string& pattern, const EDetection detectOptions, const std::size_t nbThreads )
+{
+	bfs::path patternPath( pattern );
+	if( ! patternPath.has_root_directory() )
+		patternPath = bfs::current_path() / patternPath;
+
+	// the last component is a filter of the files, the others select the directories
+	std::vector<std::string> filters;
+	const std::string lastComponent = patternPath.filename().string();
+	if( ! lastComponent.empty() && lastComponent != "." )
+		filters.push_back( lastComponent );
+
+	std::vector<bfs::path> directories( 1, patternPath.root_path() );
+	const bfs::path directoriesPattern = patternPath.parent_path().relative_path();
+	BOOST_FOREACH( const bfs::path& componentPath, directoriesPattern )
+	{
+		const std::string component = componentPath.string();
+		if( isLiteralGlobComponent( component ) )
+		{
+			// no need to list the directories to know the name
+			BOOST_FOREACH( bfs::path& directory, directories )
+			{
+				directory /= component;
+			}
+			continue;
+		}
+
+		// the digits of the directories are not wildcards, even when they are for the files
+		const boost::regex componentRegex = convertFilterToRegex( component, detectOptions & ~eDetectionSequenceFromFilename );
+		const bool ignoreDotDirectories = ( detectOptions & eDetectionIgnoreDotFile ) && component[0] != '.';
+		std::vector<std::vector<bfs::path> > subDirectories( directories.size() );
+		detail::parallelFor( directories.size(), nbThreads,
+			boost::bind( &globDirectory, boost::ref( source ), boost::cref( directories ), boost::cref( componentRegex ), ignoreDotDirectories, boost::ref( subDirectories ), _1 ) );
+
+		directories.clear();
+		BOOST_FOREACH( const std::vector<bfs::path>& matched, subDirectories )
+		{
+			directories.insert( directories.end(), matched.begin(), matched.end() );
+		}
+		if( directories.empty() )
+			return std::vector<Item>();
 	}
-	std::sort( allTimes.begin(), allTimes.end() );
-	outSequence._ranges = extractFrameRanges( allTimes );
-	return true; // a real file sequence
+
+	std::vector<std::vector<Item> > directoriesItems( directories.size() );
+	detail::parallelFor( directories.size(), nbThreads,
+		boost::bind( &browseGlobDirectory, boost::ref( source ), boost::cref( directories ), detectOptions, boost::cref( filters ), boost::ref( directoriesItems ), _1 ) );
+
+	std::vector<Item> items;
+	BOOST_FOREACH( const std::vector<Item>& directoryItems, directoriesItems )
+	{
+		items.insert( items.end(), directoryItems.begin(), directoryItems.end() );
+	}
+	return items;
 }
 
-bool isConsideredAsSingleFile( const Sequence& s, const EDetection detectOptions )
+std::vector<FrameRange> verifySequence(
+		const Sequence& sequence,
+		const boost::filesystem::path& directory,
+		const EVerification method,
+		const std::size_t nbThreads )
 {
-	return (detectOptions & eDetectionSequenceNeedAtLeastTwoFiles) && (s.getNbFiles() == 1);
+	std::vector<Time> frames;
+	BOOST_FOREACH( const Time time, sequence.getFramesIterable() )
+	{
+		frames.push_back( time );
+	}
+	std::vector<char> present( frames.size(), false );
+	const std::size_t nbProbeThreads = detail::getNbThreads( nbThreads );
+
+	std::string filename;
+	getFrameFilename( sequence, frames.empty() ? 0 : frames.back(), filename );
+
+#ifdef __UNIX__
+	const int directoryFd = open( directory.c_str(), O_RDONLY | O_DIRECTORY );
+	struct stat directoryStat;
+	bool probe = false;
+	if( directoryFd >= 0 && fstat( directoryFd, &directoryStat ) == 0 )
+	{
+		probe = ( method == eVerificationProbe ) ||
+		        ( method == eVerificationAuto && shouldProbe( frames.size(), estimateNbEntries( directoryStat, filename.size() ), nbProbeThreads ) );
+	}
+#else
+	// without any estimation of the size of the directory
+	const bool probe = ( method != eVerificationListing );
+#endif
+
+	if( probe )
+	{
+		// a few chunks by thread, the probes don't take the same time
+		const std::size_t chunkSize = std::max( std::size_t( 16 ), frames.size() / ( nbProbeThreads * 4 ) + 1 );
+		const std::size_t nbChunks = ( frames.size() + chunkSize - 1 ) / chunkSize;
+		detail::parallelFor( nbChunks, nbProbeThreads,
+			boost::bind( &probeFrames, boost::cref( sequence ), boost::cref( frames ), chunkSize,
+#ifdef __UNIX__
+				directoryFd,
+#else
+				boost::cref( directory ),
+#endif
+				boost::ref( present ), _1 ) );
+	}
+	else
+	{
+		listFrames( sequence, frames, directory, present );
+	}
+
+#ifdef __UNIX__
+	if( directoryFd >= 0 )
+		close( directoryFd );
+#endif
+
+	std::vector<Time> missingFrames;
+	for( std::size_t i = 0; i < frames.size(); ++i )
+	{
+		if( ! present[i] )
+			missingFrames.push_back( frames[i] );
+	}
+	std::sort( missingFrames.begin(), missingFrames.end() );
+	return extractFrameRanges( missingFrames );
 }
 
 std::vector<Item> browse(
-		const boost::filesystem::path& dir,
+		const boost::filesystem::path& directory,
 		const EDetection detectOptions,
 		const std::vector<std::string>& filters )
 {
-	std::vector<Item> output;
-	std::string tmpDir( dir.string() );
-	std::vector<std::string> tmpFilters( filters );
-	std::string filename;
+	DirectoryScan scan( directory, detectOptions, filters );
+	return scan.materialize( detectOptions );
+}
 
-	if( ! detectDirectoryInResearch( tmpDir, tmpFilters, filename ) )
-		return output;
+void browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	DirectoryScan scan( directory, detectOptions, filters );
+	scan.materialize( outResult, detectOptions );
+}
 
-	const std::vector<boost::regex> reFilters = convertFilterToRegex( tmpFilters, detectOptions );
+EBrowseStatus browse(
+		std::vector<Item>& outItems,
+		const boost::filesystem::path& directory,
+		const BrowseOptions& options,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	DirectoryScan scan;
+	scan.setBrowseOptions( options );
+	scan.scan( directory, detectOptions, filters );
+	outItems = scan.materialize( detectOptions );
+	return scan.getStatus();
+}
 
-	// variables for sequence detection
-	typedef boost::unordered_map<FileStrings, std::vector<FileNumbers>, SeqIdHash> SeqIdMap;
-	bfs::path directory( dir );
-	SeqIdMap sequences;
-	FileStrings tmpStringParts; // an object uniquely identify a sequence
-	FileNumbers tmpNumberParts; // the vector of numbers inside one filename
+EBrowseStatus browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const BrowseOptions& options,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	DirectoryScan scan;
+	scan.setBrowseOptions( options );
+	scan.scan( directory, detectOptions, filters );
+	scan.materialize( outResult, detectOptions );
+	return scan.getStatus();
+}
 
-	// for all files in the directory
-	bfs::directory_iterator itEnd;
-	for( bfs::directory_iterator iter( directory ); iter != itEnd; ++iter )
+EBrowseStatus browseRecursive(
+		std::vector<Item>& outItems,
+		const boost::filesystem::path& directory,
+		const BrowseOptions& options,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	outItems.clear();
+
+	// depth first: the sub-directories are browsed in the order of their names
+	std::vector<bfs::path> directories( 1, directory );
+	DirectoryScan scan;
+	scan.setBrowseOptions( options );
+	while( ! directories.empty() )
 	{
-		// clear previous infos
-		tmpStringParts.clear();
-		tmpNumberParts.clear(); // (clear but don't realloc the vector inside)
+		const bfs::path current = directories.back();
+		directories.pop_back();
 
-		if( ! filepathRespectsAllFilters( iter->path(), reFilters, filename, detectOptions ) )
-			continue;
-		
-		// if at least one number detected
-		if( decomposeFilename( iter->path().filename().string(), tmpStringParts, tmpNumberParts, detectOptions ) )
+		try
 		{
-			const SeqIdMap::iterator it( sequences.find( tmpStringParts ) );
-			if( it != sequences.end() ) // is already in map
-			{
-				// append the vector of numbers
-				sequences.at( tmpStringParts ).push_back( tmpNumberParts );
-			}
-			else
-			{
-				// create an entry in the map
-				std::vector<FileNumbers> li;
-				li.push_back( tmpNumberParts );
-				sequences.insert( SeqIdMap::value_type( tmpStringParts, li ) );
-			}
+			scan.scan( current, detectOptions, filters );
 		}
-		else
+		catch( const bfs::filesystem_error& )
+		{
+			// only the sub-directories are skipped when they can't be read
+			if( current == directory )
+				throw;
+			continue;
+		}
+		const std::vector<Item> items = scan.materialize( detectOptions );
+		outItems.insert( outItems.end(), items.begin(), items.end() );
+		if( scan.getStatus() != eBrowseStatusComplete )
+			return scan.getStatus();
+
+		// from the listing of the scan: with filters, the sub-directories may not be in the items,
+		// and a numbered link to a directory is a folder in the items (it could loop)
+		std::vector<bfs::path> subDirectories;
+		BOOST_FOREACH( const std::string& subDirectory, scan.getSubDirectories() )
 		{
-			output.push_back( Item( getTypeFromPath( iter->path() ), iter->path() ) );
+			subDirectories.push_back( current / subDirectory );
 		}
+		directories.insert( directories.end(), subDirectories.rbegin(), subDirectories.rend() );
+	}
+	return eBrowseStatusComplete;
+}
+
+std::vector<Item> browse(
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	DirectoryScan scan;
+	scan.setDirectorySource( source );
+	scan.scan( directory, detectOptions, filters );
+	return scan.materialize( detectOptions );
+}
+
+void browse(
+		BrowseResult& outResult,
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	DirectoryScan scan;
+	scan.setDirectorySource( source );
+	scan.scan( directory, detectOptions, filters );
+	scan.materialize( outResult, detectOptions );
+}
+
+
+std::vector<Item> browseParallel(
+		const boost::filesystem::path& directory,
+		const std::size_t nbThreads,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	ParallelBrowser browser( nbThreads );
+	return browser.browse( directory, detectOptions, filters );
+}
+
+void browseParallel(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const std::size_t nbThreads,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	ParallelBrowser browser( nbThreads );
+	browser.browse( outResult, directory, detectOptions, filters );
+}
+
+ParallelBrowser::ParallelBrowser( const std::size_t nbThreads )
+: _nbThreads( nbThreads )
+, _minBatchSize( detail::ShardedScan::defaultMinBatchSize )
+, _source( &getFilesystemDirectorySource() )
+, _options( NULL )
+, _nbBatches( 0 )
+, _status( eBrowseStatusComplete )
+{}
+
+void ParallelBrowser::setMinBatchSize( const std::size_t minBatchSize )
+{
+	_minBatchSize = minBatchSize;
+}
+
+void ParallelBrowser::setDirectorySource( DirectorySource& source )
+{
+	_source = &source;
+}
+
+void ParallelBrowser::setBrowseOptions( const BrowseOptions& options )
+{
+	_options = &options;
+}
+
+std::vector<Item> ParallelBrowser::browse(
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	std::vector<Item> items;
+	detail::ShardedScan scan( *_source, directory, detectOptions, filters, _nbThreads, _minBatchSize, _options );
+	_nbBatches = scan.getNbBatches();
+	_status = scan.getStatus();
+	scan.materialize( items );
+	return items;
+}
+
+void ParallelBrowser::browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	detail::ShardedScan scan( *_source, directory, detectOptions, filters, _nbThreads, _minBatchSize, _options );
+	_nbBatches = scan.getNbBatches();
+	_status = scan.getStatus();
+	scan.materialize( outResult );
+}
+
+std::size_t ParallelBrowser::getNbBatches() const
+{
+	return _nbBatches;
+}
+
+EBrowseStatus ParallelBrowser::getStatus() const
+{
+	return _status;
+}
+
+MemoryBudgetBrowser::MemoryBudgetBrowser( const std::size_t memoryBudget, const boost::filesystem::path& tmpDirectory )
+: _memoryBudget( memoryBudget )
+, _tmpDirectory( tmpDirectory )
+, _minMemoryBudget( detail::ExternalSort::defaultMinMemoryBudget )
+, _maxMergedRuns( detail::ExternalSort::defaultMaxMergedRuns )
+, _source( &getFilesystemDirectorySource() )
+, _options( NULL )
+, _nbRuns( 0 )
+, _nbMergedRuns( 0 )
+, _status( eBrowseStatusComplete )
+{}
+
+void MemoryBudgetBrowser::setMinMemoryBudget( const std::size_t minMemoryBudget )
+{
+	_minMemoryBudget = minMemoryBudget;
+}
+
+void MemoryBudgetBrowser::setMaxMergedRuns( const std::size_t maxMergedRuns )
+{
+	_maxMergedRuns = maxMergedRuns;
+}
+
+void MemoryBudgetBrowser::setDirectorySource( DirectorySource& source )
+{
+	_source = &source;
+}
+
+void MemoryBudgetBrowser::setBrowseOptions( const BrowseOptions& options )
+{
+	_options = &options;
+}
+
+bool MemoryBudgetBrowser::browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters )
+{
+	outResult = BrowseResult( directory );
+	_nbRuns = 0;
+	_nbMergedRuns = 0;
+	_status = eBrowseStatusComplete;
+
+	if( _options )
+	{
+		_status = _options->getStatus();
+		if( _status != eBrowseStatusComplete )
+			return true; // don't even list the directory
 	}
 
-	// add sequences in the output vector
-	BOOST_FOREACH( SeqIdMap::value_type & p, sequences )
+	std::string tmpDir( directory.string() );
+	std::vector<std::string> tmpFilters( filters );
+	std::string filename;
+
+	if( ! detectDirectoryInResearch( *_source, tmpDir, tmpFilters, filename ) )
+		return true;
+
+	const std::vector<boost::regex> reFilters = convertFilterToRegex( tmpFilters, detectOptions );
+
+	bfs::path runsDirectory( _tmpDirectory );
+	if( runsDirectory.empty() )
+	{
+		boost::system::error_code errorCode;
+		runsDirectory = bfs::temp_directory_path( errorCode );
+		if( errorCode )
+			return false;
+	}
+
+	// the entries with numbers are sorted by group, the other ones are added directly
+	detail::ExternalSort sortedEntries( _memoryBudget, runsDirectory, _minMemoryBudget, _maxMergedRuns );
 	{
-		const std::vector<Sequence> ss = buildSequences( directory, p.first, p.second, detectOptions );
+		detail::FileStrings tmpStringParts;
+		detail::FileNumbers tmpNumberParts;
+		std::string key;
+		std::string numbers;
 
-		BOOST_FOREACH( const std::vector<Sequence>::value_type & s, ss )
+		// the entries listed until a stop are grouped
+		std::vector<DirectoryEntry> listing;
+		_status = detail::listDirectory( *_source, directory, listing, _options );
+		BOOST_FOREACH( const DirectoryEntry& entry, listing )
 		{
-			if( bfs::is_directory( directory / s.getFirstFilename() ) )
+			tmpStringParts.clear();
+			tmpNumberParts.clear();
+
+			if( ! filepathRespectsAllFilters( directory / entry.filename, reFilters, filename, detectOptions ) )
+				continue;
+
+			if( decomposeFilename( entry.filename, tmpStringParts, tmpNumberParts, detectOptions ) )
 			{
-				// It's a sequence of directories, so it's not a sequence.
-				BOOST_FOREACH( Time t, s.getFramesIterable() )
+				getGroupKey( tmpStringParts, key );
+				getGroupNumbers( tmpNumberParts, numbers );
+				if( ! sortedEntries.add( key, numbers, entry.type ) )
 				{
-					output.push_back( Item( eTypeFolder, directory / s.getFilenameAt(t) ) );
+					_nbRuns = sortedEntries.getNbRuns();
+					return false;
 				}
 			}
 			else
 			{
-				// if it's a sequence of 1 file, it could be considered as a sequence or as a single file
-				if( isConsideredAsSingleFile( s, detectOptions ) )
-				{
-					output.push_back( Item( getTypeFromPath( directory / s.getFirstFilename() ), directory / s.getFirstFilename() ) );
-				}
-				else
-				{
-					// if it's a sequence with holes, it could be split in several sequences depending on the detect options
-					if( (detectOptions & eDetectionSequenceWithoutHoles) && (s.getFrameRanges().size() > 1) )
-					{
-						BOOST_FOREACH( FrameRange f, s.getFrameRanges() )
-						{
-							const Sequence sequenceWithoutHoles( s.getPrefix(), s.getFixedPadding(), s.getMaxPadding(), s.getSuffix(), f.first, f.last, f.step );
-							if( isConsideredAsSingleFile( sequenceWithoutHoles, detectOptions ) )
-							{
-								output.push_back( Item( getTypeFromPath( directory / sequenceWithoutHoles.getFirstFilename() ), directory / sequenceWithoutHoles.getFirstFilename() ) );
-							}
-							else
-							{
-								output.push_back( Item( Sequence( directory, sequenceWithoutHoles ), directory ) );
-							}
-						}
-					}
-					else
-					{
-						output.push_back( Item( Sequence( directory, s ), directory ) );
-					}
-				}
+				outResult.addFile( entry.type, entry.filename );
 			}
 		}
 	}
-	return output;
+	if( _options && _status == eBrowseStatusComplete )
+		_options->addDirectory();
+	const bool finished = sortedEntries.finish();
+	_nbRuns = sortedEntries.getNbRuns();
+	_nbMergedRuns = sortedEntries.getNbMergedRuns();
+	if( ! finished )
+		return false;
+
+	// build the groups one at a time, like DirectoryScan
+	detail::Arena arena;
+	boost::scoped_ptr<ExternalGroup> current;
+	std::string currentKey;
+	std::string entryName;
+	detail::ExternalSort::Record record;
+	while( sortedEntries.next( record ) )
+	{
+		if( current && record.key != currentKey )
+		{
+			detail::materializeGroup( outResult, directory, current->stringParts, current->group, detectOptions, _source );
+			current.reset();
+			arena.release();
+		}
+
+		// the parts reference the filename, so it needs to stay in the arena
+		recomposeFromKey( record.key, record.numbers, entryName );
+		const boost::string_ref entryFilename = arena.copy( entryName );
+		if( ! current )
+		{
+			current.reset( new ExternalGroup( &arena ) );
+			currentKey.assign( record.key.begin(), record.key.end() );
+			decomposeFilename( entryFilename, current->stringParts, current->tmpNumberParts, detectOptions );
+			current->group.firstType = record.type;
+		}
+		else
+		{
+			current->tmpStringParts.clear();
+			current->tmpNumberParts.clear();
+			decomposeFilename( entryFilename, current->tmpStringParts, current->tmpNumberParts, detectOptions );
+		}
+		current->group.numbers.push_back( current->tmpNumberParts );
+		current->group.types |= record.type;
+	}
+	if( current )
+		detail::materializeGroup( outResult, directory, current->stringParts, current->group, detectOptions, _source );
+	return true;
+}
+
+std::size_t MemoryBudgetBrowser::getNbRuns() const
+{
+	return _nbRuns;
+}
+
+std::size_t MemoryBudgetBrowser::getNbMergedRuns() const
+{
+	return _nbMergedRuns;
+}
+
+EBrowseStatus MemoryBudgetBrowser::getStatus() const
+{
+	return _status;
+}
+
+
+bool browseWithMemoryBudget(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const std::size_t memoryBudget,
+		const EDetection detectOptions,
+		const std::vector<std::string>& filters,
+		const boost::filesystem::path& tmpDirectory )
+{
+	MemoryBudgetBrowser browser( memoryBudget, tmpDirectory );
+	return browser.browse( outResult, directory, detectOptions, filters );
 }
 
 
@@ -2,6 +2,9 @@
 #define _SEQUENCE_PARSER_FILESYSTEM_HPP_
 
 #include "common.hpp"
+#include "BrowseOptions.hpp"
+#include "BrowseResult.hpp"
+#include "DirectorySource.hpp"
 #include "Item.hpp"
 #include "Sequence.hpp"
 
@@ -21,8 +24,84 @@ namespace sequenceParser {
  */
 bool browseSequence( Sequence& outSequence, const std::string& pattern, const EPattern accept = ePatternDefault );
 
+/**
+ * @brief Same as browseSequence, on the directories of another source than the filesystem.
+ * @see browseSequence
+ */
+bool browseSequence( Sequence& outSequence, DirectorySource& source, const std::string& pattern, const EPattern accept = ePatternDefault );
+
+/**
+ * @brief Same as browseSequence for a lot of patterns at once.
+ *
+ * The patterns are grouped by directory: each directory is listed once,
+ * for all its patterns, and the directories are browsed on several threads.
+ *
+ * @param[in] patterns: absolute paths of the sequences, like browseSequence
+ * @param[in] nbThreads: number of threads, 0 to use all the cores.
+ * @return a sequence for each pattern (in the same order),
+ *         without any file if the pattern is not recognized or the directory doesn't exist
+ */
+std::vector<Sequence> browseSequences( const std::vector<std::string>& patterns, const EPattern accept = ePatternDefault, const std::size_t nbThreads = 0 );
+
+/**
+ * @brief Same as browseSequences, on the directories of another source than the filesystem.
+ * @see browseSequences
+ */
+std::vector<Sequence> browseSequences( DirectorySource& source, const std::vector<std::string>& patterns, const EPattern accept = ePatternDefault, const std::size_t nbThreads = 0 );
+
+/**
+ * @brief Browse the directories which match a glob pattern, with the notion of Sequences.
+ *
+ * Like "/shows/x/sh0??/comp/v###/comp.####.exr": the directories use the wildcards
+ * of the filters ("*", "?", "#", "@"), only the directories which could match are
+ * listed (the components without wildcard are not listed at all).
+ * The last component is used as the filter of browse in each matching directory.
+ * The directories of each level are listed on several threads.
+ *
+ * @param[in] pattern: relative to the current directory if not absolute
+ * @param[in] nbThreads: number of threads, 0 to use all the cores.
+ * @return the items of all the matching directories (sorted by directory)
+ */
+std::vector<Item> browseGlob( const std::string& pattern, const EDetection detectOptions = eDetectionDefault, const std::size_t nbThreads = 0 );
+
+/**
+ * @brief Same as browseGlob, on the directories of another source than the filesystem.
+ * @see browseGlob
+ */
+std::vector<Item> browseGlob( DirectorySource& source, const std::string& pattern, const EDetection detectOptions = eDetectionDefault, const std::size_t nbThreads = 0 );
+
+
+/**
+ * @brief How verifySequence checks the files.
+ */
+enum EVerification
+{
+	eVerificationAuto = 0, ///< choose from the number of frames and the size of the directory
+	eVerificationProbe = 1, ///< check each file by its name
+	eVerificationListing = 2 ///< list the directory
+};
 
 #ifndef SWIG
+/**
+ * @brief Check that all the frames of a sequence are in a directory,
+ *        without browsing the directory.
+ *
+ * When the expected frames are known (like the range of a render job),
+ * each file could be checked by its name (a lookup, on several threads),
+ * which costs a lot less than listing a huge directory. But listing is better
+ * for a lot of frames in a small directory: the size of the directory gives
+ * an estimation of its number of entries, to choose between the two.
+ *
+ * @param[in] sequence: the expected frames
+ * @param[in] nbThreads: number of threads for the probes, 0 to use all the cores.
+ * @return the frames which are missing (all of them if the directory can't be read)
+ */
+std::vector<FrameRange> verifySequence(
+		const Sequence& sequence,
+		const boost::filesystem::path& directory,
+		const EVerification method = eVerificationAuto,
+		const std::size_t nbThreads = 0 );
+
 /**
  * @brief Browse the content of a directory on your filesystem, with the notion of Sequences.
  * @param[in] directory: the input directory in which it will search.
@@ -30,14 +109,295 @@ bool browseSequence( Sequence& outSequence, const std::string& pattern, const EP
  * @param[in] filters: set filters to limit the search.
  *                     For example to limit to jpg files, use "*.jpg".
  * @return A vector of files, sequences and directories.
+ * @throw boost::filesystem::filesystem_error if the directory can't be listed.
  */
 std::vector<Item> browse(
 		const boost::filesystem::path& directory,
 		const EDetection detectOptions = eDetectionDefault,
 		const std::vector<std::string>& filters = std::vector<std::string>() );
 
+/**
+ * @brief Same as browse, but fill a compact BrowseResult instead of a vector of Items.
+ * @param[out] outResult: the content of the directory (previous content is removed).
+ * @see browse
+ */
+void browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Same as browse, controlled by options (cancellation, deadline, progress).
+ * @param[out] outItems: the content of the directory (previous content is removed),
+ *                       partial if the browse has been stopped.
+ * @return if the browse is complete, or how it has been stopped
+ * @see browse
+ */
+EBrowseStatus browse(
+		std::vector<Item>& outItems,
+		const boost::filesystem::path& directory,
+		const BrowseOptions& options,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Same as browse with options, but fill a compact BrowseResult.
+ * @see browse
+ */
+EBrowseStatus browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const BrowseOptions& options,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Browse a directory and all its sub-directories (the links are not followed).
+ *
+ * The items of a directory are followed by the items of its sub-directories,
+ * depth first. The filters only select the items: all the sub-directories
+ * are browsed, except the ones which can't be listed.
+ *
+ * @param[out] outItems: the content of the tree (previous content is removed),
+ *                       partial if the browse has been stopped.
+ * @return if the browse is complete, or how it has been stopped
+ * @see browse
+ */
+EBrowseStatus browseRecursive(
+		std::vector<Item>& outItems,
+		const boost::filesystem::path& directory,
+		const BrowseOptions& options = BrowseOptions(),
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Same as browse, on the directories of another source than the filesystem.
+ * @param[in] source: where the directories are listed (a MemoryDirectorySource,
+ *                    a ReplayDirectorySource...)
+ * @see browse
+ */
+std::vector<Item> browse(
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Same as browse with a source, but fill a compact BrowseResult.
+ * @see browse
+ */
+void browse(
+		BrowseResult& outResult,
+		DirectorySource& source,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Same as browse, using several threads inside the directory.
+ *
+ * The filenames are tokenized, grouped and built into sequences on several
+ * threads, for directories with millions of entries.
+ * The items are the same as browse, in an order which doesn't depend on the
+ * number of threads (the files without number first, in the listing order).
+ *
+ * @param[in] nbThreads: number of threads, 0 to use all the cores.
+ * @see browse
+ */
+std::vector<Item> browseParallel(
+		const boost::filesystem::path& directory,
+		const std::size_t nbThreads,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Same as browseParallel, but fill a compact BrowseResult.
+ * @param[out] outResult: the content of the directory (previous content is removed).
+ * @see browseParallel, ParallelBrowser
+ */
+void browseParallel(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const std::size_t nbThreads,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+/**
+ * @brief Same as browse, with a bound on the memory used to group the files,
+ *        for directories with tens of millions of entries.
+ *
+ * Above the budget, the entries with numbers are written in sorted runs in
+ * temporary files, which are merged to build the sequences one group at a time.
+ * The items are the same as browse, but the groups are in the order of
+ * their strings instead of an unspecified order.
+ *
+ * @param[out] outResult: the content of the directory (previous content is removed).
+ * @param[in] memoryBudget: memory used to group the entries, in bytes (at least 256KB).
+ * @param[in] tmpDirectory: directory of the temporary files,
+ *                          the temporary directory of the system if empty.
+ * @return false if the temporary files can't be written.
+ * @see browse, MemoryBudgetBrowser
+ */
+bool browseWithMemoryBudget(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const std::size_t memoryBudget,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>(),
+		const boost::filesystem::path& tmpDirectory = boost::filesystem::path() );
+
 #endif
 
+/**
+ * @brief browseParallel, with the size of the batches of filenames
+ *        tokenized by a thread.
+ */
+class ParallelBrowser
+{
+public:
+	typedef ParallelBrowser This;
+
+public:
+	/// @param[in] nbThreads: number of threads, 0 to use all the cores.
+	explicit ParallelBrowser( const std::size_t nbThreads = 0 );
+
+	/**
+	 * @brief A batch has at least @p minBatchSize filenames (4096 by default),
+	 *        and there are a few batches per thread.
+	 */
+	void setMinBatchSize( const std::size_t minBatchSize );
+
+	/**
+	 * @brief Control the next browses (cancellation, deadline, progress):
+	 *        they stop while the directory is listed, with the entries listed until then.
+	 * @param[in] options: it needs to outlive the browses
+	 */
+	void setBrowseOptions( const BrowseOptions& options );
+
+	/**
+	 * @brief Browse the directories of another source than the filesystem
+	 *        (for the next browses).
+	 * @param[in] source: it needs to outlive the browses
+	 */
+	void setDirectorySource( DirectorySource& source );
+
+#ifndef SWIG
+	/// @see browseParallel
+	std::vector<Item> browse(
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+
+	void browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+#endif
+
+	std::vector<Item> browse(
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+	{
+		return browse( boost::filesystem::path( directory ), detectOptions, filters );
+	}
+
+	/// @return number of batches of filenames tokenized by the last browse
+	std::size_t getNbBatches() const;
+
+	/// @return if the last browse is complete, or has been stopped (partial content)
+	EBrowseStatus getStatus() const;
+
+private:
+	std::size_t _nbThreads;
+	std::size_t _minBatchSize;
+	DirectorySource* _source;
+	const BrowseOptions* _options; ///< NULL without any control
+	std::size_t _nbBatches;
+	EBrowseStatus _status;
+};
+
+/**
+ * @brief browseWithMemoryBudget, with the settings of the temporary runs
+ *        and the number of runs written by the last browse.
+ *
+ * A run stores the numbers of each file, and the strings of its group
+ * only when they change.
+ */
+class MemoryBudgetBrowser
+{
+public:
+	typedef MemoryBudgetBrowser This;
+
+public:
+	/**
+	 * @param[in] memoryBudget: memory used to group the entries, in bytes.
+	 * @param[in] tmpDirectory: directory of the temporary files,
+	 *                          the temporary directory of the system if empty.
+	 */
+	explicit MemoryBudgetBrowser( const std::size_t memoryBudget, const boost::filesystem::path& tmpDirectory = boost::filesystem::path() );
+
+	/// @brief The memory budget is at least @p minMemoryBudget bytes (256KB by default), to avoid a run for a few entries.
+	void setMinMemoryBudget( const std::size_t minMemoryBudget );
+
+	/// @brief Maximal number of runs merged at once, each one is an open file (64 by default, at least 2).
+	void setMaxMergedRuns( const std::size_t maxMergedRuns );
+
+	/**
+	 * @brief Control the next browses (cancellation, deadline, progress):
+	 *        they stop while the directory is listed, the entries listed until then are grouped.
+	 * @param[in] options: it needs to outlive the browses
+	 */
+	void setBrowseOptions( const BrowseOptions& options );
+
+	/**
+	 * @brief Browse the directories of another source than the filesystem
+	 *        (for the next browses).
+	 * @param[in] source: it needs to outlive the browses
+	 */
+	void setDirectorySource( DirectorySource& source );
+
+#ifndef SWIG
+	/// @see browseWithMemoryBudget
+	bool browse(
+		BrowseResult& outResult,
+		const boost::filesystem::path& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() );
+#endif
+
+	bool browse(
+		BrowseResult& outResult,
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+	{
+		return browse( outResult, boost::filesystem::path( directory ), detectOptions, filters );
+	}
+
+	/// @return number of runs written from the memory by the last browse (0 if everything fit in memory)
+	std::size_t getNbRuns() const;
+
+	/// @return number of runs written by merging other runs, when there were more than the maximal number of merged runs
+	std::size_t getNbMergedRuns() const;
+
+	/// @return if the last browse is complete, or has been stopped (partial content)
+	EBrowseStatus getStatus() const;
+
+private:
+	std::size_t _memoryBudget;
+	boost::filesystem::path _tmpDirectory;
+	std::size_t _minMemoryBudget;
+	std::size_t _maxMergedRuns;
+	DirectorySource* _source;
+	const BrowseOptions* _options; ///< NULL without any control
+	std::size_t _nbRuns;
+	std::size_t _nbMergedRuns;
+	EBrowseStatus _status;
+};
+
 
 inline std::vector<Item> browse(
 		const std::string& directory,
@@ -48,6 +408,113 @@ inline std::vector<Item> browse(
 }
 
 
+inline void browse(
+		BrowseResult& outResult,
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	browse( outResult, boost::filesystem::path(directory), detectOptions, filters );
+}
+
+
+inline EBrowseStatus browse(
+		std::vector<Item>& outItems,
+		const std::string& directory,
+		const BrowseOptions& options,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	return browse( outItems, boost::filesystem::path(directory), options, detectOptions, filters );
+}
+
+
+inline EBrowseStatus browse(
+		BrowseResult& outResult,
+		const std::string& directory,
+		const BrowseOptions& options,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	return browse( outResult, boost::filesystem::path(directory), options, detectOptions, filters );
+}
+
+
+inline EBrowseStatus browseRecursive(
+		std::vector<Item>& outItems,
+		const std::string& directory,
+		const BrowseOptions& options = BrowseOptions(),
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	return browseRecursive( outItems, boost::filesystem::path(directory), options, detectOptions, filters );
+}
+
+
+inline std::vector<Item> browse(
+		DirectorySource& source,
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	return browse( source, boost::filesystem::path(directory), detectOptions, filters );
+}
+
+
+inline void browse(
+		BrowseResult& outResult,
+		DirectorySource& source,
+		const std::string& directory,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	browse( outResult, source, boost::filesystem::path(directory), detectOptions, filters );
+}
+
+
+inline std::vector<Item> browseParallel(
+		const std::string& directory,
+		const std::size_t nbThreads,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	return browseParallel( boost::filesystem::path(directory), nbThreads, detectOptions, filters );
+}
+
+
+inline void browseParallel(
+		BrowseResult& outResult,
+		const std::string& directory,
+		const std::size_t nbThreads,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>() )
+{
+	browseParallel( outResult, boost::filesystem::path(directory), nbThreads, detectOptions, filters );
+}
+
+
+inline bool browseWithMemoryBudget(
+		BrowseResult& outResult,
+		const std::string& directory,
+		const std::size_t memoryBudget,
+		const EDetection detectOptions = eDetectionDefault,
+		const std::vector<std::string>& filters = std::vector<std::string>(),
+		const std::string& tmpDirectory = std::string() )
+{
+	return browseWithMemoryBudget( outResult, boost::filesystem::path(directory), memoryBudget, detectOptions, filters, boost::filesystem::path(tmpDirectory) );
+}
+
+
+inline std::vector<FrameRange> verifySequence(
+		const Sequence& sequence,
+		const std::string& directory,
+		const EVerification method = eVerificationAuto,
+		const std::size_t nbThreads = 0 )
+{
+	return verifySequence( sequence, boost::filesystem::path(directory), method, nbThreads );
+}
+
+
 inline std::vector<Item> browse(
 		const Item& directory,
 		const EDetection detectOptions = eDetectionDefault,
@@ -6,6 +6,8 @@
 
 %{
 #include "sequenceParser/Item.hpp"
+#include "sequenceParser/BrowseOptions.hpp"
+#include "sequenceParser/DirectorySource.hpp"
 #include "sequenceParser/filesystem.hpp"
 #include <boost/exception/diagnostic_information.hpp>
 %}
@@ -19,5 +21,61 @@ namespace sequenceParser {
 		const boost::filesystem::path&,
 		const EDetection detectOptions,
 		const std::vector<std::string>& );
+%ignore browse(
+		BrowseResult&,
+		const boost::filesystem::path&,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore browse(
+		std::vector<Item>&,
+		const boost::filesystem::path&,
+		const BrowseOptions&,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore browse(
+		BrowseResult&,
+		const boost::filesystem::path&,
+		const BrowseOptions&,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore browseRecursive(
+		std::vector<Item>&,
+		const boost::filesystem::path&,
+		const BrowseOptions&,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore browse(
+		DirectorySource&,
+		const boost::filesystem::path&,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore browse(
+		BrowseResult&,
+		DirectorySource&,
+		const boost::filesystem::path&,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore verifySequence(
+		const Sequence&,
+		const boost::filesystem::path&,
+		const EVerification,
+		const std::size_t );
+%ignore browseParallel(
+		const boost::filesystem::path&,
+		const std::size_t,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore browseParallel(
+		BrowseResult&,
+		const boost::filesystem::path&,
+		const std::size_t,
+		const EDetection detectOptions,
+		const std::vector<std::string>& );
+%ignore browseWithMemoryBudget(
+		BrowseResult&,
+		const boost::filesystem::path&,
+		const std::size_t,
+		const EDetection,
+		const std::vector<std::string>&,
+		const boost::filesystem::path& );
 }
-
@@ -1,12 +1,23 @@
 
-%module sequenceParser
+%module(directors="1") sequenceParser
 
 %include "common.i"
 
 %include "FrameRange.i"
 %include "Sequence.i"
+%include "SequenceBuilder.i"
 %include "Item.i"
+%include "BrowseOptions.i"
 %include "ItemStat.i"
+%include "BrowseResult.i"
+%include "DirectorySource.i"
+%include "TarDirectorySource.i"
+%include "DirectoryScan.i"
+%include "BrowseCache.i"
+%include "SequenceIndex.i"
+%include "SequenceWatcher.i"
+%include "SequenceFollower.i"
+%include "SequenceDiff.i"
 
 %include "detector.i"
 %include "filesystem.i"
@@ -1,6 +1,9 @@
 import tempfile
 import os
+import time
+import random
 import shutil
+import tarfile
 
 from pySequenceParser import sequenceParser as seq
 
@@ -46,6 +49,20 @@ def tearDown():
     shutil.rmtree(root_path)
 
 
+def createFiles(directory, filenames):
+    for f in filenames:
+        # create an empty file
+        open(os.path.join(directory, f), 'w').close()
+
+
+def getSequences(items):
+    return [(item.getFilename(),
+             item.getSequence().getFixedPadding(),
+             item.getSequence().getMaxPadding(),
+             list(item.getSequence().getFramesIterable()))
+            for item in items if item.getType() == seq.eTypeSequence]
+
+
 def testBrowse():
     global root_path
     items = seq.browse(root_path)
@@ -61,3 +78,711 @@ def testBrowse():
             for f in sequence.getFramesIterable():
                 print("file:", sequence.getFilenameAt(f))
 
+
+
+def testBrowseMixedPadding():
+    directory = tempfile.mkdtemp()
+    try:
+        createFiles(directory, ["a.1.jpg", "a.01.jpg", "a.001.jpg",
+                                "a.2.jpg", "a.02.jpg", "a.002.jpg",
+                                "a.003.jpg", "a.10.jpg", "a.100.jpg"])
+        # one sequence per padding, by increasing padding
+        assert_equals(getSequences(seq.browse(directory)),
+                      [("a.@.jpg", 0, 1, [1, 2, 10, 100]),
+                       ("a.##.jpg", 2, 2, [1, 2]),
+                       ("a.###.jpg", 3, 3, [1, 2, 3])])
+    finally:
+        shutil.rmtree(directory)
+
+
+def testBrowseVaryingNumbers():
+    directory = tempfile.mkdtemp()
+    try:
+        createFiles(directory, ["sh010_v003.1001.exr", "sh010_v003.1002.exr", "sh010_v003.1003.exr",
+                                "sh010_v004.1001.exr", "sh010_v004.1002.exr",
+                                "sh020_v001.1001.exr", "sh020_v001.1002.exr",
+                                "sh030_v001.1001.exr"])
+        # the frames vary inside each shot and version
+        items = seq.browse(directory)
+        assert_equals(sorted(getSequences(items)),
+                      [("sh010_v003.@.exr", 0, 4, [1001, 1002, 1003]),
+                       ("sh010_v004.@.exr", 0, 4, [1001, 1002]),
+                       ("sh020_v001.@.exr", 0, 4, [1001, 1002])])
+        assert_equals([i.getFilename() for i in items if i.getType() == seq.eTypeFile],
+                      ["sh030_v001.1001.exr"])
+    finally:
+        shutil.rmtree(directory)
+
+    directory = tempfile.mkdtemp()
+    try:
+        createFiles(directory, ["sh010_v001.1001.exr", "sh020_v001.1001.exr", "sh030_v001.1001.exr"])
+        # only the shot varies
+        assert_equals(getSequences(seq.browse(directory)),
+                      [("sh###_v001.1001.exr", 3, 3, [10, 20, 30])])
+    finally:
+        shutil.rmtree(directory)
+
+
+def testBrowseSingleNumberedFiles():
+    directory = tempfile.mkdtemp()
+    try:
+        createFiles(directory, ["img.0042.exr", "log_2024_05.txt", "c.+5.jpg"])
+        # a number alone is not a sequence
+        for options in (seq.eDetectionDefault, seq.eDetectionDefault | seq.eDetectionNegative):
+            items = seq.browse(directory, options)
+            # the names are kept as they are (not rebuilt from a sequence)
+            assert_equals(sorted((i.getFilename(), i.getType()) for i in items),
+                          [("c.+5.jpg", seq.eTypeFile),
+                           ("img.0042.exr", seq.eTypeFile),
+                           ("log_2024_05.txt", seq.eTypeFile)])
+        # without eDetectionSequenceNeedAtLeastTwoFiles, each number is a sequence of one file
+        items = seq.browse(directory, seq.eDetectionSequenceFromFilename)
+        assert_equals(sorted(getSequences(items)),
+                      [("c.+@.jpg", 0, 1, [5]),
+                       ("img.####.exr", 4, 4, [42]),
+                       ("log_2024_##.txt", 2, 2, [5])])
+    finally:
+        shutil.rmtree(directory)
+
+
+def testBrowseManyFiles():
+    directory = tempfile.mkdtemp()
+    try:
+        expected = []
+        for shot in range(0, 200, 10):
+            prefix = "sh%03d_comp." % shot
+            createFiles(directory, [prefix + "%04d.exr" % frame for frame in range(1, 151)])
+            expected.append((prefix + "####.exr", 4, 4, list(range(1, 151))))
+        # the names and numbers of the detection don't fit in one block of memory
+        assert_equals(sorted(getSequences(seq.browse(directory))), expected)
+    finally:
+        shutil.rmtree(directory)
+
+
+def testSequenceCopies():
+    global root_path
+    items = seq.browse(root_path)
+    item = [i for i in items if i.getFilename() == "foo.###.png"][0]
+    sequence = item.getSequence()
+    itemCopy = seq.Item(sequence, root_path)
+    assert_equals(itemCopy.getAbsoluteFilepath(), item.getAbsoluteFilepath())
+    for copy in (seq.Sequence(sequence), itemCopy.getSequence()):
+        assert_equals(copy.getPrefix(), "foo.")
+        assert_equals(copy.getSuffix(), ".png")
+        assert_equals(copy.getFixedPadding(), 3)
+        assert_equals(copy.getMaxPadding(), 3)
+        assert_equals([(r.first, r.last, r.step) for r in copy.getFrameRanges()], [(1, 3, 1), (6, 6, 1)])
+
+
+def testBrowseResult():
+    global root_path
+    items = seq.browse(root_path)
+    result = seq.BrowseResult()
+    seq.browse(result, root_path)
+    assert_equals(result.size(), len(items))
+    for i, item in enumerate(items):
+        assert_equals(result.getType(i), item.getType())
+        assert_equals(result.getFilename(i), item.getFilename())
+        assert_equals(result.getItem(i).getAbsoluteFilepath(), item.getAbsoluteFilepath())
+
+
+def testBrowseParallel():
+    global root_path
+    items = seq.browse(root_path)
+    expected = sorted((item.getType(), item.getFilename()) for item in items)
+    parallelItems = seq.browseParallel(root_path, 4)
+    assert_equals(sorted((item.getType(), item.getFilename()) for item in parallelItems), expected)
+    # the order doesn't depend on the number of threads
+    assert_equals([item.getFilename() for item in seq.browseParallel(root_path, 1)], [item.getFilename() for item in parallelItems])
+
+
+def testBrowseParallelBatches():
+    global root_path
+    expected = sorted((item.getType(), item.getFilename()) for item in seq.browse(root_path))
+    filenames = None
+    for nbThreads in (1, 4):
+        # small batches: the filenames are tokenized by several tasks
+        browser = seq.ParallelBrowser(nbThreads)
+        browser.setMinBatchSize(1)
+        parallelItems = browser.browse(root_path)
+        assert_true(browser.getNbBatches() > 1)
+        assert_equals(sorted((item.getType(), item.getFilename()) for item in parallelItems), expected)
+        if filenames is None:
+            filenames = [item.getFilename() for item in parallelItems]
+        assert_equals([item.getFilename() for item in parallelItems], filenames)
+
+
+def testBrowseWithMemoryBudget():
+    global root_path
+    items = seq.browse(root_path)
+    result = seq.BrowseResult()
+    # the budget is raised to its minimum: everything fits in memory
+    assert_true(seq.browseWithMemoryBudget(result, root_path, 0))
+    expected = sorted((item.getType(), item.getFilename()) for item in items)
+    assert_equals(sorted((result.getType(i), result.getFilename(i)) for i in range(result.size())), expected)
+
+
+def testBrowseWithMemoryBudgetRuns():
+    directory = tempfile.mkdtemp()
+    try:
+        generator = random.Random(5)
+        for _ in range(300):
+            name = generator.choice(["a.%d.png" % generator.randint(0, 500),
+                                     "b_%04d.exr" % generator.randint(0, 300),
+                                     "c%d_%d.tif" % (generator.randint(0, 5), generator.randint(0, 40)),
+                                     "%d" % generator.randint(0, 50)])
+            open(os.path.join(directory, name), 'w').close()
+        os.mkdir(os.path.join(directory, "dir1"))
+        open(os.path.join(directory, "plain.txt"), 'w').close()
+
+        for detectOptions in (seq.eDetectionDefault, seq.eDetectionDefault | seq.eDetectionSequenceWithoutHoles):
+            expected = sorted((item.getType(), item.getFilename()) for item in seq.browse(directory, detectOptions))
+            for maxMergedRuns in (2, 4, 1000):
+                # a run for each entry, merged in several passes
+                browser = seq.MemoryBudgetBrowser(0)
+                browser.setMinMemoryBudget(0)
+                browser.setMaxMergedRuns(maxMergedRuns)
+                result = seq.BrowseResult()
+                assert_true(browser.browse(result, directory, detectOptions))
+                assert_true(browser.getNbRuns() > 1)
+                assert_equals(browser.getNbMergedRuns() > 0, browser.getNbRuns() > maxMergedRuns)
+                assert_equals(sorted((result.getType(i), result.getFilename(i)) for i in range(result.size())), expected)
+    finally:
+        shutil.rmtree(directory)
+
+
+def testDirectoryScan():
+    global root_path
+    scan = seq.DirectoryScan(root_path)
+    for options in (seq.eDetectionDefault,
+                    seq.eDetectionDefault | seq.eDetectionSequenceWithoutHoles,
+                    seq.eDetectionNone):
+        items = seq.browse(root_path, options)
+        scanItems = scan.materialize(options)
+        assert_equals(sorted(i.getAbsoluteFilepath() for i in scanItems),
+                      sorted(i.getAbsoluteFilepath() for i in items))
+    assert_false(scan.needsRescan(seq.eDetectionDefault | seq.eDetectionSequenceWithoutHoles))
+    assert_true(scan.needsRescan(seq.eDetectionDefault | seq.eDetectionNegative))
+
+
+def testBrowseCache():
+    global root_path
+    cache = seq.BrowseCache()
+    # the directory has just been created
+    cache.setRecentModificationDelay(0)
+    items = seq.browse(root_path)
+    for i in range(2):
+        cachedItems = cache.browse(root_path)
+        assert_equals([c.getAbsoluteFilepath() for c in cachedItems],
+                      [c.getAbsoluteFilepath() for c in items])
+    assert_equals(cache.getNbMisses(), 1)
+    assert_equals(cache.getNbHits(), 1)
+    assert_equals(cache.size(), 1)
+
+    # a modification of the directory changes its stamp
+    new_file = os.path.join(root_path, "new.txt")
+    open(new_file, 'w').close()
+    stat = os.stat(root_path)
+    # a different modification time, even with a coarse timestamp resolution
+    os.utime(root_path, (stat.st_atime, stat.st_mtime - 10))
+    try:
+        cachedItems = cache.browse(root_path)
+    finally:
+        os.remove(new_file)
+    assert_equals(cache.getNbMisses(), 2)
+    assert_equals(cache.getNbHits(), 1)
+    assert_true(new_file in [c.getAbsoluteFilepath() for c in cachedItems])
+    cache.clear()
+    assert_equals(cache.size(), 0)
+    assert_equals(cache.getMemorySize(), 0)
+
+
+def testSequenceIndex():
+    global root_path
+    index_path = os.path.join(tempfile.mkdtemp(), "index.bin")
+    assert_true(seq.buildSequenceIndex(index_path, root_path))
+    index = seq.SequenceIndex(index_path)
+    assert_true(index.isOpen())
+    assert_equals(index.getRootDirectory(), root_path)
+    d = index.findDirectory(root_path)
+    assert_not_equals(d, -1)
+    items = seq.browse(root_path)
+    indexItems = index.getItems(d)
+    assert_equals([i.getAbsoluteFilepath() for i in indexItems],
+                  [i.getAbsoluteFilepath() for i in items])
+    index.close()
+    assert_true(seq.updateSequenceIndex(index_path))
+    shutil.rmtree(os.path.dirname(index_path))
+
+
+def testSequenceDiff():
+    global root_path
+    before = seq.BrowseResult()
+    seq.browse(before, root_path)
+    new_file = os.path.join(root_path, "foo.004.png")
+    open(new_file, 'w').close()
+    after = seq.BrowseResult()
+    seq.browse(after, root_path)
+    os.remove(new_file)
+    diff = seq.diffBrowseResults(before, after)
+    assert_equals(len(diff.addedItems), 0)
+    assert_equals(len(diff.removedItems), 0)
+    assert_equals(len(diff.modifiedSequences), 1)
+    framesDiff = diff.modifiedSequences[0]
+    assert_equals(framesDiff.item.getFilename(), "foo.###.png")
+    assert_equals([(r.first, r.last) for r in framesDiff.addedFrames], [(4, 4)])
+    assert_equals(len(framesDiff.removedFrames), 0)
+    assert_true(seq.diffBrowseResults(after, after).empty())
+
+
+def testSequenceWatcher():
+    directory = tempfile.mkdtemp()
+    try:
+        createFiles(directory, ["w.%04d.exr" % i for i in range(1, 6)] + ["plain.txt"])
+        watcher = seq.SequenceWatcher()
+        assert_true(watcher.watch(directory))
+        assert_equals(list(watcher.getDirectories()), [directory])
+        assert_equals(getSequences(watcher.getItems(directory)),
+                      [("w.####.exr", 4, 4, [1, 2, 3, 4, 5])])
+
+        def update():
+            if seq.SequenceWatcher.isSupported():
+                # the directory modified by the events
+                assert_equals(watcher.processEvents(1000), 1)
+            else:
+                assert_true(watcher.reload(directory))
+
+        # frames of the sequence
+        createFiles(directory, ["w.0007.exr", "w.0009.exr"])
+        os.remove(os.path.join(directory, "w.0002.exr"))
+        update()
+        assert_equals(getSequences(watcher.getItems(directory)),
+                      [("w.####.exr", 4, 4, [1, 3, 4, 5, 7, 9])])
+        os.remove(os.path.join(directory, "w.0009.exr"))
+        os.remove(os.path.join(directory, "w.0001.exr"))
+        update()
+        assert_equals(getSequences(watcher.getItems(directory)),
+                      [("w.####.exr", 4, 4, [3, 4, 5, 7])])
+
+        # another padding, another sequence
+        createFiles(directory, ["w.12345.exr", "w.12346.exr"])
+        update()
+        assert_equals(sorted(getSequences(watcher.getItems(directory))),
+                      sorted(getSequences(seq.browse(directory))))
+        assert_equals(len(getSequences(watcher.getItems(directory))), 2)
+
+        # files without number
+        os.remove(os.path.join(directory, "plain.txt"))
+        update()
+        assert_equals([i.getFilename() for i in watcher.getItems(directory)
+                       if i.getType() != seq.eTypeSequence], [])
+
+        # a pattern only watches its sequence
+        pattern = os.path.join(directory, "w.####.exr")
+        patternWatcher = seq.SequenceWatcher()
+        assert_true(patternWatcher.watch(pattern))
+        assert_equals(getSequences(patternWatcher.getItems(pattern)),
+                      [("w.####.exr", 4, 4, [3, 4, 5, 7])])
+
+        assert_false(watcher.watch(os.path.join(directory, "missing", "dir")))
+        watcher.unwatch(directory)
+        assert_false(watcher.isWatched(directory))
+    finally:
+        shutil.rmtree(directory)
+
+
+def testSequenceWatcherSameDirectory():
+    directory = tempfile.mkdtemp()
+    try:
+        createFiles(directory, ["w.%04d.exr" % i for i in range(1, 4)])
+        # the keys resolve to the same directory
+        pattern = os.path.join(directory, "w.####.exr")
+        watcher = seq.SequenceWatcher()
+        assert_true(watcher.watch(directory))
+        assert_true(watcher.watch(pattern))
+        if not seq.SequenceWatcher.isSupported():
+            return
+
+        createFiles(directory, ["w.0004.exr"])
+        assert_equals(watcher.processEvents(1000), 2)
+        for key in [directory, pattern]:
+            assert_equals(getSequences(watcher.getItems(key)),
+                          [("w.####.exr", 4, 4, [1, 2, 3, 4])])
+
+        # the other key is still watched
+        watcher.unwatch(directory)
+        createFiles(directory, ["w.0005.exr"])
+        assert_equals(watcher.processEvents(1000), 1)
+        assert_equals(getSequences(watcher.getItems(pattern)),
+                      [("w.####.exr", 4, 4, [1, 2, 3, 4, 5])])
+    finally:
+        shutil.rmtree(directory)
+
+
+def getFrames(sequence):
+    return list(sequence.getFramesIterable())
+
+
+def testSequenceFollower():
+    directory = tempfile.mkdtemp()
+    try:
+        pattern = os.path.join(directory, "f.####.exr")
+        assert_false(seq.SequenceFollower(os.path.join(directory, "plain.txt")).isValid())
+
+        # the frames already written are not reported
+        createFiles(directory, ["f.0001.exr", "f.0002.exr", "g.0003.exr"])
+        follower = seq.SequenceFollower(pattern)
+        assert_true(follower.isValid())
+        assert_equals(getFrames(follower.getSequence()), [1, 2])
+        assert_equals(follower.waitFrames(0), ())
+
+        # timeout without new frame
+        start = time.time()
+        assert_equals(follower.waitFrames(100), ())
+        assert_true(time.time() - start >= 0.09)
+
+        if follower.usesEvents():
+            # the closed frames, sorted
+            createFiles(directory, ["f.0005.exr", "f.0003.exr", "g.0004.exr"])
+            assert_equals(follower.waitFrames(1000), (3, 5))
+            # a frame is reported when the writer closes it
+            frame = open(os.path.join(directory, "f.0004.exr"), 'w')
+            frame.write("begin")
+            frame.flush()
+            assert_equals(follower.waitFrames(100), ())
+            frame.close()
+            assert_equals(follower.waitFrames(1000), (4,))
+            assert_equals(getFrames(follower.getSequence()), [1, 2, 3, 4, 5])
+    finally:
+        shutil.rmtree(directory)
+
+
+def testSequenceFollowerPolling():
+    directory = tempfile.mkdtemp()
+    try:
+        # without the directory, the follower lists it at each check
+        shot = os.path.join(directory, "shot")
+        follower = seq.SequenceFollower(os.path.join(shot, "f.####.exr"), seq.ePatternDefault, True)
+        assert_true(follower.isValid())
+        assert_false(follower.usesEvents())
+        follower.setPollingInterval(10, 20)
+        assert_equals(follower.waitFrames(0), ())
+
+        os.mkdir(shot)
+        createFiles(shot, ["f.0012.exr", "f.0010.exr", "f.0011.exr"])
+        assert_equals(follower.waitFrames(1000), (10, 11, 12))
+
+        # a frame is reported when its size is the same on two checks
+        frame = open(os.path.join(shot, "f.0013.exr"), 'w')
+        frame.write("begin")
+        frame.flush()
+        assert_equals(follower.waitFrames(0), ())
+        frame.write("end")
+        frame.flush()
+        assert_equals(follower.waitFrames(0), ())
+        assert_equals(follower.waitFrames(0), (13,))
+        frame.close()
+        assert_equals(follower.waitFrames(0), ())
+        assert_equals(getFrames(follower.getSequence()), [10, 11, 12, 13])
+    finally:
+        shutil.rmtree(directory)
+
+
+def testBrowseDirectorySource():
+    source = seq.MemoryDirectorySource()
+    for i in range(1, 11):
+        source.addEntry("/show/shot/img.%04d.exr" % i)
+    source.addEntry("/show/shot/readme.txt")
+    source.addEntry("/show/shot/sub", seq.eTypeFolder)
+    items = seq.browse(source, "/show/shot")
+    assert_equals(sorted([(i.getFilename(), i.getType()) for i in items]),
+                  sorted([("img.####.exr", seq.eTypeSequence),
+                          ("readme.txt", seq.eTypeFile),
+                          ("sub", seq.eTypeFolder)]))
+    sequence = seq.Sequence()
+    assert_true(seq.browseSequence(sequence, source, "/show/shot/img.####.exr"))
+    assert_equals(sequence.getNbFiles(), 10)
+    assert_raises(IOError, seq.browse, source, "/show/other")
+
+
+def testBrowsersDirectorySource():
+    source = seq.MemoryDirectorySource()
+    for i in range(1, 11):
+        source.addEntry("/show/shot/img.%04d.exr" % i)
+    source.addEntry("/show/shot/readme.txt")
+    source.addEntry("/show/shot/sub", seq.eTypeFolder)
+    expected = sorted((item.getType(), item.getFilename()) for item in seq.browse(source, "/show/shot"))
+    assert_equals(len(expected), 3)
+
+    browser = seq.ParallelBrowser(4)
+    browser.setDirectorySource(source)
+    assert_equals(sorted((item.getType(), item.getFilename()) for item in browser.browse("/show/shot")), expected)
+    assert_raises(IOError, browser.browse, "/show/other")
+
+    budgetBrowser = seq.MemoryBudgetBrowser(0)
+    budgetBrowser.setDirectorySource(source)
+    result = seq.BrowseResult()
+    assert_true(budgetBrowser.browse(result, "/show/shot"))
+    assert_equals(sorted((result.getType(i), result.getFilename(i)) for i in range(result.size())), expected)
+
+    # the directory is unknown by the filesystem, it's only updated by reload
+    watcher = seq.SequenceWatcher()
+    watcher.setDirectorySource(source)
+    assert_true(watcher.watch("/show/shot"))
+    assert_equals(sorted((item.getType(), item.getFilename()) for item in watcher.getItems("/show/shot")), expected)
+    source.addEntry("/show/shot/notes.txt")
+    assert_true(watcher.reload("/show/shot"))
+    assert_equals(len(watcher.getItems("/show/shot")), 4)
+    assert_false(watcher.watch("/other/shot"))
+
+    follower = seq.SequenceFollower(source, "/show/shot/img.####.exr")
+    assert_true(follower.isValid())
+    assert_equals(getFrames(follower.getSequence()), list(range(1, 11)))
+
+
+def testBrowseRecordedDirectory():
+    directory = tempfile.mkdtemp()
+    recordDirectory = tempfile.mkdtemp()
+    try:
+        for name in ["img.%04d.exr" % i for i in range(1, 11)] + ["readme.txt"]:
+            open(os.path.join(directory, name), "w").close()
+        os.mkdir(os.path.join(directory, "sub"))
+        recorder = seq.RecordingDirectorySource(seq.getFilesystemDirectorySource())
+        recordedItems = seq.browse(recorder, directory)
+        recordFile = os.path.join(recordDirectory, "record")
+        assert_true(recorder.save(recordFile))
+        shutil.rmtree(directory)
+
+        replay = seq.ReplayDirectorySource(recordFile, False)
+        items = seq.browse(replay, directory)
+        assert_equals([(i.getAbsoluteFilepath(), i.getType(), i.getFilename()) for i in items],
+                      [(i.getAbsoluteFilepath(), i.getType(), i.getFilename()) for i in recordedItems])
+        assert_equals(len(items), 3)
+
+        # a truncated record is not loaded
+        with open(recordFile, "rb") as record:
+            content = record.read()
+        with open(recordFile, "wb") as record:
+            record.write(content[:-1])
+        assert_false(replay.load(recordFile, False))
+    finally:
+        shutil.rmtree(directory, True)
+        shutil.rmtree(recordDirectory)
+
+
+def testBrowseTarArchive():
+    global root_path
+    archive_path = os.path.join(tempfile.mkdtemp(), "shot.tar")
+    try:
+        archive = tarfile.open(archive_path, "w")
+        archive.add(root_path, arcname="shot")
+        for name, entryType in [("fifo", tarfile.FIFOTYPE), ("tty", tarfile.CHRTYPE), ("disk", tarfile.BLKTYPE)]:
+            info = tarfile.TarInfo("special/" + name)
+            info.type = entryType
+            archive.addfile(info)
+        # a chain of links to a directory, and a cycle
+        for name, target in [("links/a", "../shot"), ("links/b", "a"), ("links/c", "b"),
+                             ("links/loop1", "loop2"), ("links/loop2", "loop1")]:
+            info = tarfile.TarInfo(name)
+            info.type = tarfile.SYMTYPE
+            info.linkname = target
+            archive.addfile(info)
+        archive.close()
+        source = seq.TarDirectorySource(archive_path)
+        assert_equals(source.getArchive(), archive_path)
+        items = seq.browse(source, os.path.join(archive_path, "shot"))
+        fsItems = seq.browse(root_path)
+        assert_equals(sorted([(i.getFilename(), i.getType()) for i in items]),
+                      sorted([(i.getFilename(), i.getType()) for i in fsItems]))
+        # the special files have no type, like on the filesystem
+        for name in ["fifo", "tty", "disk"]:
+            assert_equals(source.getType(os.path.join(archive_path, "special", name)), seq.eTypeUndefined)
+        assert_equals(source.getType(os.path.join(archive_path, "special")), seq.eTypeFolder)
+        for name in ["a", "b", "c"]:
+            link = os.path.join(archive_path, "links", name)
+            assert_equals(source.getType(link), seq.eTypeLink)
+            assert_equals(source.getType(link, True), seq.eTypeFolder)
+        assert_equals(sorted([i.getFilename() for i in seq.browse(source, os.path.join(archive_path, "links", "c"))]),
+                      sorted([i.getFilename() for i in items]))
+        assert_equals(source.getType(os.path.join(archive_path, "links", "loop1"), True), seq.eTypeUndefined)
+    finally:
+        shutil.rmtree(os.path.dirname(archive_path))
+
+
+def testBrowseSequences():
+    global root_path
+    patterns = [os.path.join(root_path, "foo.###.png"),
+                os.path.join(root_path, "a.@"),
+                os.path.join(root_path, "nothing.####.exr"),
+                os.path.join(root_path, "plop.txt")]
+    sequences = seq.browseSequences(patterns, seq.ePatternDefault, 2)
+    assert_equals(len(sequences), 4)
+    for pattern, sequence in zip(patterns, sequences):
+        expected = seq.Sequence()
+        seq.browseSequence(expected, pattern)
+        assert_equals(sequence.getNbFiles(), expected.getNbFiles())
+    assert_equals(sequences[0].getNbFiles(), 4)
+    assert_equals(sequences[1].getNbFiles(), 2)
+    assert_equals(sequences[2].getNbFiles(), 0)
+
+
+def testBrowseGlob():
+    source = seq.MemoryDirectorySource()
+    for shot in ["sh010", "sh020", "other"]:
+        for version in ["v001", "v002", "w001"]:
+            for i in range(1, 4):
+                source.addEntry("/shows/x/%s/comp/%s/comp.%04d.exr" % (shot, version, i))
+    items = seq.browseGlob(source, "/shows/x/sh0*/comp/v###/comp.####.exr", seq.eDetectionDefault, 2)
+    assert_equals([i.getAbsoluteFilepath() for i in items],
+                  ["/shows/x/sh010/comp/v001/comp.####.exr",
+                   "/shows/x/sh010/comp/v002/comp.####.exr",
+                   "/shows/x/sh020/comp/v001/comp.####.exr",
+                   "/shows/x/sh020/comp/v002/comp.####.exr"])
+    assert_equals(len(seq.browseGlob(source, "/shows/y/*/comp.####.exr")), 0)
+
+
+def testVerifySequence():
+    global root_path
+    sequence = seq.Sequence("foo.", 3, 3, ".png", 1, 6)
+    for method in [seq.eVerificationAuto, seq.eVerificationProbe, seq.eVerificationListing]:
+        missing = seq.verifySequence(sequence, root_path, method)
+        assert_equals([(r.first, r.last, r.step) for r in missing], [(4, 5, 1)])
+
+
+def testBrowseOptions():
+    global root_path
+
+    class Progress(seq.BrowseProgressHandler):
+        def __init__(self):
+            seq.BrowseProgressHandler.__init__(self)
+            self.nbDirectories = 0
+
+        def onProgress(self, progress):
+            self.nbDirectories = progress.nbDirectories
+
+    progress = Progress()
+    options = seq.BrowseOptions()
+    options.setProgressHandler(progress)
+    items = seq.ItemVector()
+    assert_equals(seq.browseRecursive(items, root_path, options), seq.eBrowseStatusComplete)
+    assert_equals(progress.nbDirectories, options.getProgress().nbDirectories)
+    assert_true(len(items) > len(seq.browse(root_path)))
+
+    token = seq.CancellationToken()
+    token.cancel()
+    options.setCancellationToken(token)
+    assert_equals(seq.browse(items, root_path, options), seq.eBrowseStatusCancelled)
+    assert_equals(len(items), 0)
+
+
+def testBrowseRecursiveLinks():
+    directory = tempfile.mkdtemp()
+    try:
+        # numbered links to directories, one of them to the parent: they are not followed
+        os.mkdir(os.path.join(directory, "v001"))
+        createFiles(os.path.join(directory, "v001"), ["img.0001.exr", "img.0002.exr"])
+        os.symlink("v001", os.path.join(directory, "v002"))
+        os.symlink(".", os.path.join(directory, "v003"))
+        subDirectory = os.path.join(directory, "v001")
+        for filters, expected in (([], [directory, subDirectory]), (["*.exr"], [subDirectory])):
+            options = seq.BrowseOptions()
+            items = seq.ItemVector()
+            assert_equals(seq.browseRecursive(items, directory, options, seq.eDetectionDefault, filters), seq.eBrowseStatusComplete)
+            assert_equals(options.getProgress().nbDirectories, 2)
+            assert_equals(sorted(set(os.path.dirname(item.getAbsoluteFilepath()) for item in items)), expected)
+    finally:
+        shutil.rmtree(directory)
+
+
+class Canceller(seq.BrowseProgressHandler):
+    """
+    Cancel the operations at the first progress.
+    """
+    def __init__(self, token):
+        seq.BrowseProgressHandler.__init__(self)
+        self.token = token
+
+    def onProgress(self, progress):
+        self.token.cancel()
+
+
+def getCancellingOptions(token, canceller, nbEntries):
+    options = seq.BrowseOptions()
+    options.setCancellationToken(token)
+    options.setProgressHandler(canceller)
+    options.setProgressInterval(nbEntries)
+    return options
+
+
+def testBrowseOptionsDuringListing():
+    directory = tempfile.mkdtemp()
+    try:
+        for i in range(1000):
+            open(os.path.join(directory, "img.%04d.exr" % i), "w").close()
+        token = seq.CancellationToken()
+        canceller = Canceller(token)
+
+        # the token is checked at each entry, while the directory is listed
+        options = getCancellingOptions(token, canceller, 10)
+        items = seq.ItemVector()
+        assert_equals(seq.browse(items, directory, options), seq.eBrowseStatusCancelled)
+        assert_equals(options.getProgress().nbEntries, 10)
+        assert_equals(options.getProgress().nbDirectories, 0)
+        assert_equals(sum(item.getSequence().getNbFiles() for item in items), 10)
+
+        token.reset()
+        options = getCancellingOptions(token, canceller, 10)
+        browser = seq.ParallelBrowser(4)
+        browser.setMinBatchSize(1)
+        browser.setBrowseOptions(options)
+        items = browser.browse(directory)
+        assert_equals(browser.getStatus(), seq.eBrowseStatusCancelled)
+        assert_equals(options.getProgress().nbEntries, 10)
+        assert_equals(sum(item.getSequence().getNbFiles() for item in items), 10)
+
+        token.reset()
+        options = getCancellingOptions(token, canceller, 10)
+        browser = seq.MemoryBudgetBrowser(0)
+        browser.setBrowseOptions(options)
+        result = seq.BrowseResult()
+        assert_true(browser.browse(result, directory))
+        assert_equals(browser.getStatus(), seq.eBrowseStatusCancelled)
+        assert_equals(options.getProgress().nbEntries, 10)
+        assert_true(result.size() <= 1)
+
+        # without any stop, the browsers give the same items
+        token.reset()
+        options = seq.BrowseOptions()
+        browser = seq.ParallelBrowser(4)
+        browser.setBrowseOptions(options)
+        assert_equals(len(browser.browse(directory)), 1)
+        assert_equals(browser.getStatus(), seq.eBrowseStatusComplete)
+        assert_equals(options.getProgress().nbEntries, 1000)
+        assert_equals(options.getProgress().nbDirectories, 1)
+    finally:
+        shutil.rmtree(directory)
+
+
+def testSequenceIndexOptions():
+    global root_path
+    index_path = os.path.join(tempfile.mkdtemp(), "index.seqidx")
+    try:
+        token = seq.CancellationToken()
+        token.cancel()
+        options = seq.BrowseOptions()
+        options.setCancellationToken(token)
+        assert_false(seq.buildSequenceIndex(index_path, root_path, options))
+        assert_false(os.path.exists(index_path))
+
+        token.reset()
+        assert_true(seq.buildSequenceIndex(index_path, root_path, options, seq.eDetectionDefault, True))
+        assert_equals(options.getProgress().nbDirectories, seq.SequenceIndex(index_path).getNbDirectories())
+
+        # a stopped update keeps the previous index
+        token.cancel()
+        assert_false(seq.updateSequenceIndex(index_path, options))
+        assert_true(seq.SequenceIndex(index_path).isOpen())
+        token.reset()
+        assert_true(seq.updateSequenceIndex(index_path, options))
+    finally:
+        shutil.rmtree(os.path.dirname(index_path))
@@ -116,3 +116,28 @@ def testSequenceStat():
     assert_equals(itemStat.size, itemStat.maxSize * nbFilesInSequence)
     assert_equals(itemStat.realSize, itemStat.size / itemStat.nbHardLinks)
     assert_greater_equal(itemStat.sizeOnDisk, itemStat.size)
+
+
+def testStoppedSequenceStat():
+    """
+    A stat stopped by the options only covers the first files of the sequence.
+    """
+    class Canceller(seq.BrowseProgressHandler):
+        def __init__(self, token):
+            seq.BrowseProgressHandler.__init__(self)
+            self.token = token
+
+        def onProgress(self, progress):
+            self.token.cancel()
+
+    itemSequence = getSequencesFromPath(root_path, seq.eDetectionDefault)[0]
+    token = seq.CancellationToken()
+    canceller = Canceller(token)
+    options = seq.BrowseOptions()
+    options.setCancellationToken(token)
+    options.setProgressHandler(canceller)
+    options.setProgressInterval(2)
+    itemStat = seq.ItemStat(itemSequence, options)
+    assert_equals(itemStat.status, seq.eBrowseStatusCancelled)
+    assert_equals(itemStat.fullNbHardLinks, 2)
+    assert_equals(itemStat.nbHardLinks, 1)
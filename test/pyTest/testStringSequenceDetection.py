@@ -1,5 +1,8 @@
 import tempfile
+import os
 import shutil
+import random
+import re
 
 from pySequenceParser import sequenceParser as seq
 from . import createFile, getSequencesFromPath
@@ -110,3 +113,275 @@ def testSingleSequenceMultiRanges():
     subtimes = [14, 15, 16]
     for frame, time in zip(sequence.getFramesIterable(6, 17), subtimes):
         assert_equals(frame, time)
+
+
+def testDetectSequencesFromNames():
+    """
+    Check sequence detection from names, without any file.
+    """
+    nonSequences = seq.StringVector()
+    names = ["a.001.jpg", "a.002.jpg", "a.004.jpg", "b.1.exr", "c.txt", ".hidden.1", ".hidden.2"]
+    sequences = seq.detectSequences(nonSequences, names, seq.eDetectionDefault)
+    assert_equals(len(sequences), 1)
+    assert_equals(sequences[0].getFilenameWithStandardPattern(), "a.###.jpg")
+    assert_equals(sequences[0].getNbFiles(), 3)
+    assert_equals(sorted(nonSequences), ["b.1.exr", "c.txt"])
+
+
+def detectNames(names, detectOptions):
+    detector = seq.SequenceDetector(detectOptions)
+    for name in names:
+        detector.add(name)
+    nonSequences = seq.StringVector()
+    sequences = detector.detect(nonSequences)
+    result = [(s.getPrefix(), s.getFixedPadding(), s.getMaxPadding(), s.getSuffix(),
+               tuple((r.first, r.last, r.step) for r in s.getFrameRanges())) for s in sequences]
+    return detector.isSortedInput(), sorted(result), sorted(nonSequences)
+
+
+def testDetectSequencesSortedInput():
+    """
+    Check that sorted names (frames added as they arrive) and unsorted names give the same result.
+    """
+    generator = random.Random(11)
+    prefixes = ["a.", "a_", "b.", "a.1.", "a.2.", "c", ""]
+    suffixes = [".png", ".exr", "", ".1.tif"]
+    options = [seq.eDetectionDefault, seq.eDetectionNone, seq.eDetectionNegative,
+               seq.eDetectionDefault | seq.eDetectionSequenceWithoutHoles,
+               seq.eDetectionSingleFileSeqUseFirstNumber]
+    for _ in range(200):
+        names = set()
+        padding = generator.choice([0, 4, None])
+        for _ in range(generator.randint(1, 80)):
+            if padding is None:
+                number = generator.choice([str(generator.randint(0, 30)),
+                                           "%03d" % generator.randint(0, 200),
+                                           "-%d" % generator.randint(1, 5)])
+            else:
+                number = "%0*d" % (padding, generator.randint(0, 300))
+            names.add(generator.choice(prefixes) + number + generator.choice(suffixes))
+        names = sorted(names)
+        shuffled = list(names)
+        generator.shuffle(shuffled)
+        detectOptions = generator.choice(options)
+
+        isSorted, sequences, nonSequences = detectNames(names, detectOptions)
+        assert_true(isSorted)
+        isSorted, unsortedSequences, unsortedNonSequences = detectNames(reversed(names), detectOptions)
+        assert_equals(isSorted, len(names) == 1)
+        assert_equals(unsortedSequences, sequences)
+        assert_equals(unsortedNonSequences, nonSequences)
+        assert_equals(detectNames(shuffled, detectOptions)[1:], (sequences, nonSequences))
+
+
+def splitFilenameWithRegex(filename, negative):
+    """
+    Reference of the split of a filename, with the regex of the detection.
+    """
+    pattern = re.compile(r"[+-]?\d{1,19}" if negative else r"\d{1,19}", re.ASCII)
+    strings = []
+    numbers = []
+    times = []
+    last = 0
+    for match in pattern.finditer(filename):
+        strings.append(filename[last:match.start()])
+        time = int(match.group())
+        # the numbers out of range are skipped
+        if -2 ** 63 <= time < 2 ** 63:
+            numbers.append(match.group())
+            times.append(time)
+        last = match.end()
+    if last != len(filename):
+        strings.append(filename[last:])
+    if len(strings) == len(numbers):
+        strings.append("")
+    return strings, numbers, times
+
+
+def testSplitFilename():
+    """
+    Compare the split of the filenames with the regex, for each digit scanner.
+    """
+    alphabet = "._-+a/:@\u00e9"
+    defaultScanner = seq.getDigitScanner()
+    try:
+        for scanner in ("scalar", "sse2", "avx2"):
+            if not seq.setDigitScanner(scanner):
+                # not supported by the processor or the build
+                continue
+            assert_equals(seq.getDigitScanner(), scanner)
+            generator = random.Random(3)
+            for _ in range(2000):
+                # long names for the blocks of 16 and 32 characters,
+                # long numbers for the conversion by 8 digits and the limit of 19 digits
+                filename = ""
+                length = generator.randint(1, 100)
+                while len(filename) < length:
+                    if generator.randint(0, 3) == 0:
+                        filename += "".join(generator.choice("0123456789") for _ in range(generator.randint(1, 25)))
+                    else:
+                        filename += generator.choice(alphabet)
+                for negative in (False, True):
+                    strings = seq.StringVector()
+                    numbers = seq.StringVector()
+                    detectOptions = seq.eDetectionNegative if negative else seq.eDetectionNone
+                    times = seq.splitFilename(strings, numbers, filename, detectOptions)
+                    assert_equals((list(strings), list(numbers), list(times)),
+                                  splitFilenameWithRegex(filename, negative))
+    finally:
+        seq.setDigitScanner(defaultScanner)
+
+
+def testSplitFilenameLimits():
+    strings = seq.StringVector()
+    numbers = seq.StringVector()
+    # 19 digits at most, the largest and smallest times
+    times = seq.splitFilename(strings, numbers, "a_12345678901234567890.9223372036854775807", seq.eDetectionNone)
+    assert_equals(list(numbers), ["1234567890123456789", "0", "9223372036854775807"])
+    assert_equals(list(times), [1234567890123456789, 0, 9223372036854775807])
+    assert_equals(list(strings), ["a_", "", ".", ""])
+    times = seq.splitFilename(strings, numbers, "a.-9223372036854775808_+12.9223372036854775808", seq.eDetectionNegative)
+    assert_equals(list(numbers), ["-9223372036854775808", "+12"])
+    assert_equals(list(times), [-9223372036854775808, 12])
+    assert_equals(list(strings), ["a.", "_", "."])
+
+
+def testDetectSequencesInManifest():
+    """
+    Check sequence detection from a manifest of paths, without any file.
+    """
+    manifest = tempfile.NamedTemporaryFile('w', delete=False)
+    manifest.write("/a/s.1.exr\n/a/s.2.exr\n/a/b/c.txt\n/a/s.3.exr\n/d/e.txt\n")
+    manifest.close()
+    items = seq.ItemVector()
+    assert_true(seq.detectSequencesInManifest(items, manifest.name))
+    os.remove(manifest.name)
+    paths = sorted(item.getAbsoluteFilepath() for item in items)
+    assert_equals(paths, ["/a/b/c.txt", "/a/s.@.exr", "/d/e.txt"])
+
+
+def testDetectSequencesInUnsortedManifest():
+    """
+    Check that each directory is detected once with all its names, even if the manifest is not sorted.
+    """
+    manifest = tempfile.NamedTemporaryFile('w', delete=False)
+    manifest.write("/a/s.1.exr\n/a/b/c.txt\n/d/e.1.txt\n/a/s.2.exr\n/a/b/c.2.txt\n/d/e.2.txt\n/a/s.3.exr\n")
+    manifest.close()
+    expected = ["/a/b/c.2.txt", "/a/b/c.txt", "/a/s.@.exr", "/d/e.@.txt"]
+    try:
+        for isSorted in (True, False):
+            items = seq.ItemVector()
+            assert_true(seq.detectSequencesInManifest(items, manifest.name, seq.eDetectionDefault, '\n', isSorted))
+            paths = sorted(item.getAbsoluteFilepath() for item in items)
+            assert_equals(paths, expected)
+    finally:
+        os.remove(manifest.name)
+
+
+def extractFrameRanges(frames):
+    """
+    Reference of the frame ranges detection, on the sorted frames.
+    """
+    ranges = []
+    for frame in sorted(set(frames)):
+        if not ranges:
+            ranges.append([frame, frame, 1])
+            continue
+        last = ranges[-1]
+        step = frame - last[1]
+        if last[2] == step:
+            last[1] = frame
+        elif last[0] == last[1]:
+            last[1] = frame
+            last[2] = step
+        elif last[1] - last[0] == last[2]:
+            # a range of 2 frames gives its last frame to the new range
+            ranges.append([last[1], frame, step])
+            last[1] = last[0]
+            last[2] = 1
+        else:
+            ranges.append([frame, frame, 1])
+    if len(ranges) > 1 and ranges[-1][1] - ranges[-1][0] == ranges[-1][2]:
+        last = ranges[-1]
+        ranges.append([last[1], last[1], 1])
+        last[1] = last[0]
+        last[2] = 1
+    return [tuple(r) for r in ranges]
+
+
+def getBuilderRanges(builder):
+    return [(r.first, r.last, r.step) for r in builder.finalize()]
+
+
+def testSequenceBuilder():
+    """
+    Check the frame ranges built frame by frame.
+    """
+    builder = seq.SequenceBuilder()
+    assert_true(builder.empty())
+
+    # steps
+    for frame in [1, 3, 5, 7]:
+        builder.add(frame)
+    assert_equals(getBuilderRanges(builder), [(1, 7, 2)])
+
+    # holes and duplicates
+    builder.clear()
+    for frame in [1, 2, 2, 3, 6, 3]:
+        builder.add(frame)
+    assert_equals(getBuilderRanges(builder), [(1, 3, 1), (6, 6, 1)])
+    assert_equals(builder.getNbFrames(), 4)
+
+    # a last range of 2 frames is split, except if there are only 2 frames
+    builder.clear()
+    for frame in [1, 2, 3, 10, 12]:
+        builder.add(frame)
+    assert_equals(getBuilderRanges(builder), [(1, 3, 1), (10, 10, 1), (12, 12, 1)])
+    builder.clear()
+    builder.add(1)
+    builder.add(5)
+    assert_equals(getBuilderRanges(builder), [(1, 5, 4)])
+
+    # out of order, before the ranges are merged
+    builder.clear()
+    for frame in [5, 1, 3, 2, 4]:
+        builder.add(frame)
+    assert_true(builder.contains(2))
+    assert_false(builder.contains(6))
+    assert_equals(builder.getNbFrames(), 5)
+    assert_equals(getBuilderRanges(builder), [(1, 5, 1)])
+
+    # removed frames
+    builder.remove(3)
+    builder.remove(42)
+    assert_false(builder.contains(3))
+    assert_equals(getBuilderRanges(builder), extractFrameRanges([1, 2, 4, 5]))
+
+    # more frames out of order than kept aside before a merge
+    builder.clear()
+    for frame in range(3000, 0, -1):
+        builder.add(frame)
+    assert_equals(getBuilderRanges(builder), [(1, 3000, 1)])
+
+
+def testSequenceBuilderRandom():
+    """
+    Compare the frame ranges built frame by frame with the detection on the sorted frames.
+    """
+    generator = random.Random(7)
+    for _ in range(300):
+        builder = seq.SequenceBuilder()
+        frames = set()
+        step = generator.randint(1, 3)
+        for _ in range(generator.randint(1, 60)):
+            frame = generator.randint(-10, 60) * step
+            if frames and generator.randint(0, 5) == 0:
+                frame = generator.choice(sorted(frames))
+                builder.remove(frame)
+                frames.discard(frame)
+            else:
+                builder.add(frame)
+                frames.add(frame)
+            assert_equals(builder.contains(frame), frame in frames)
+        assert_equals(builder.getNbFrames(), len(frames))
+        assert_equals(getBuilderRanges(builder), extractFrameRanges(frames))